@@ -6,6 +6,7 @@
 #include "wl.h"
 #include "table.h"
 #include "message.h"
+#include "helper.h"
 
 
 void DAQuery::init(uint64_t thd_id, Workload * h_wl){
@@ -116,7 +117,11 @@ BaseQuery * DAQueryGenerator::create_query(Workload * h_wl, uint64_t home_partit
         if(act_seq.actions()[i].type()==Action::Type::WRITE)
           t_version[DAQ_t->item_id]++;
         DAQ_t->write_version=t_version[DAQ_t->item_id];
+#if DA_LOCKFREE_QUEUE
+        while (!da_query_queue.push(DAQ_t)) PAUSE_SILO
+#else
         da_gen_qry_queue.push_data(DAQ_t);
+#endif
 
     }
     free(t_version);
@@ -11,6 +11,7 @@
 #include "thread.h"
 #include "txn.h"
 #include "wl.h"
+#include "checkpoint.h"
 #include <string>
 
 RC DAWorkload::init() {
@@ -33,7 +34,13 @@ RC DAWorkload::init() {
   printf("Done\n");
   printf("Initializing table... ");
   fflush(stdout);
-  init_table();
+#if CKPT_LOAD
+  if (checkpointer.load(this) != RCOK)
+#endif
+  if (load_snapshot() != RCOK) {
+    init_table();
+    dump_snapshot();
+  }
   printf("Done\n");
   fflush(stdout);
   nextstate=0;
@@ -76,6 +76,7 @@ public:
 	RC init_table();
 	RC init_schema(const char * schema_file);
 	RC get_txn_man(TxnManager *& txn_manager);
+	string snapshot_key();
 	table_t * 		t_suppliers;
 	table_t * 		t_products;
 	table_t * 		t_parts;
@@ -89,17 +90,13 @@ public:
 	INDEX * 	i_uses;
 
 private:
-	void init_tab_suppliers();
-	void init_tab_products();
-	void init_tab_parts();
-	void init_tab_supplies();
-	void init_tab_uses();
-
-	static void * threadInitSuppliers(void * This);
-	static void * threadInitProducts(void * This);
-	static void * threadInitParts(void * This);
-	static void * threadInitSupplies(void * This);
-	static void * threadInitUses(void * This);
+	void init_tab_suppliers(UInt32 tid, UInt32 tot);
+	void init_tab_products(UInt32 tid, UInt32 tot);
+	void init_tab_parts(UInt32 tid, UInt32 tot);
+	void init_tab_supplies(UInt32 tid, UInt32 tot);
+	void init_tab_uses(UInt32 tid, UInt32 tot);
+
+	static void * threadLoad(void * This);
 };
 
 struct pps_thr_args{
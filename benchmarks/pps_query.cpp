@@ -23,8 +23,47 @@
 #include "table.h"
 #include "message.h"
 
+PPSKeyDist PPSQueryGenerator::part_dist;
+PPSKeyDist PPSQueryGenerator::supplier_dist;
+PPSKeyDist PPSQueryGenerator::product_dist;
+pthread_mutex_t PPSQueryGenerator::dist_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void PPSQueryGenerator::init(uint64_t gen_id) {
+	mrand = (myrand *) mem_allocator.alloc(sizeof(myrand));
+	mrand->init(g_seed * 1000003 + gen_id);
+	pthread_mutex_lock(&dist_lock);
+	if (part_dist.n == 0) {
+		init_dist(part_dist, g_max_part_key);
+		init_dist(supplier_dist, g_max_supplier_key);
+		init_dist(product_dist, g_max_product_key);
+	}
+	pthread_mutex_unlock(&dist_lock);
+}
+
+void PPSQueryGenerator::init_dist(PPSKeyDist &dist, uint64_t n) {
+	dist.theta = g_pps_zipf_theta;
+	dist.zetan = 0;
+	dist.zeta_2_theta = 1 + pow(0.5, dist.theta);
+	if (dist.theta > 0) {
+		for (uint64_t i = 1; i <= n; i++) dist.zetan += pow(1.0 / i, dist.theta);
+	}
+	dist.n = n;
+}
+
+// the zipf generator of YCSBQueryGenerator::zipf; key 1 is the hottest
+uint64_t PPSQueryGenerator::gen_key(const PPSKeyDist &dist) {
+	if (dist.theta == 0) return 1 + mrand->next() % dist.n;
+	double alpha = 1 / (1 - dist.theta);
+	double eta = (1 - pow(2.0 / dist.n, 1 - dist.theta)) / (1 - dist.zeta_2_theta / dist.zetan);
+	double u = (double)(mrand->next() % 10000000) / 10000000;
+	double uz = u * dist.zetan;
+	if (uz < 1) return 1;
+	if (uz < 1 + pow(0.5, dist.theta)) return 2;
+	return std::min(dist.n, 1 + (uint64_t)(dist.n * pow(eta * u - eta + 1, alpha)));
+}
+
 BaseQuery * PPSQueryGenerator::create_query(Workload * h_wl,uint64_t home_partition_id) {
-  double x = (double)(rand() % 100) / 100.0;
+  double x = (double)(mrand->next() % 100) / 100.0;
   if (x < g_perc_getparts) {
 		return gen_requests_parts(home_partition_id);
   }
@@ -222,10 +261,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_parts(uint64_t home_partition) {
   uint64_t part_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (parts_to_partition(part_key = URand(1, g_max_part_key)) != home_partition) {
+    while (parts_to_partition(part_key = gen_key(part_dist)) != home_partition) {
   }
   } else
-		part_key = URand(1, g_max_part_key);
+		part_key = gen_key(part_dist);
 
   query->part_key = part_key;
   partitions_accessed.insert(parts_to_partition(part_key));
@@ -245,10 +284,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_suppliers(uint64_t home_partition) {
   uint64_t supplier_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (suppliers_to_partition(supplier_key = URand(1, g_max_supplier_key)) != home_partition) {
+    while (suppliers_to_partition(supplier_key = gen_key(supplier_dist)) != home_partition) {
   }
   } else
-		supplier_key = URand(1, g_max_supplier_key);
+		supplier_key = gen_key(supplier_dist);
 
   query->supplier_key = supplier_key;
   partitions_accessed.insert(suppliers_to_partition(supplier_key));
@@ -269,10 +308,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_products(uint64_t home_partition) {
   uint64_t product_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (products_to_partition(product_key = URand(1, g_max_product_key)) != home_partition) {
+    while (products_to_partition(product_key = gen_key(product_dist)) != home_partition) {
   }
   } else
-		product_key = URand(1, g_max_product_key);
+		product_key = gen_key(product_dist);
 
   query->product_key = product_key;
   partitions_accessed.insert(products_to_partition(product_key));
@@ -292,10 +331,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_partsbysupplier(uint64_t home_partit
   uint64_t supplier_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (suppliers_to_partition(supplier_key = URand(1, g_max_supplier_key)) != home_partition) {
+    while (suppliers_to_partition(supplier_key = gen_key(supplier_dist)) != home_partition) {
   }
   } else
-		supplier_key = URand(1, g_max_supplier_key);
+		supplier_key = gen_key(supplier_dist);
 
   query->supplier_key = supplier_key;
   partitions_accessed.insert(suppliers_to_partition(supplier_key));
@@ -315,10 +354,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_partsbyproduct(uint64_t home_partiti
   uint64_t product_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (products_to_partition(product_key = URand(1, g_max_product_key)) != home_partition) {
+    while (products_to_partition(product_key = gen_key(product_dist)) != home_partition) {
   }
   } else
-		product_key = URand(1, g_max_product_key);
+		product_key = gen_key(product_dist);
 
   query->product_key = product_key;
   partitions_accessed.insert(products_to_partition(product_key));
@@ -338,10 +377,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_orderproduct(uint64_t home_partition
   uint64_t product_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (products_to_partition(product_key = URand(1, g_max_product_key)) != home_partition) {
+    while (products_to_partition(product_key = gen_key(product_dist)) != home_partition) {
   }
   } else
-		product_key = URand(1, g_max_product_key);
+		product_key = gen_key(product_dist);
 
   query->product_key = product_key;
   partitions_accessed.insert(products_to_partition(product_key));
@@ -361,14 +400,19 @@ BaseQuery * PPSQueryGenerator::gen_requests_updateproductpart(uint64_t home_part
   uint64_t product_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (products_to_partition(product_key = URand(1, g_max_product_key)) != home_partition) {
+    while (products_to_partition(product_key = gen_key(product_dist)) != home_partition) {
   }
   } else
-		product_key = URand(1, g_max_product_key);
+		product_key = gen_key(product_dist);
 
   query->product_key = product_key;
   partitions_accessed.insert(products_to_partition(product_key));
-  query->part_key = URand(1, g_max_part_key);
+  uint64_t part_key = gen_key(part_dist);
+  if ((double)(mrand->next() % 10000) / 10000 < g_pps_part_affinity) {
+    while (parts_to_partition(part_key) != products_to_partition(product_key))
+      part_key = gen_key(part_dist);
+  }
+  query->part_key = part_key;
 
   query->partitions.init(partitions_accessed.size());
   for(auto it = partitions_accessed.begin(); it != partitions_accessed.end(); ++it) {
@@ -386,10 +430,10 @@ BaseQuery * PPSQueryGenerator::gen_requests_updatepart(uint64_t home_partition)
   uint64_t part_key;
     // select a part
 	if (FIRST_PART_LOCAL) {
-    while (parts_to_partition(part_key = URand(1, g_max_part_key)) != home_partition) {
+    while (parts_to_partition(part_key = gen_key(part_dist)) != home_partition) {
   }
   } else
-		part_key = URand(1, g_max_part_key);
+		part_key = gen_key(part_dist);
 
   query->part_key = part_key;
   partitions_accessed.insert(parts_to_partition(part_key));
@@ -26,8 +26,18 @@ class Message;
 class PPSQueryMessage;
 class PPSClientQueryMessage;
 
+// zipf over the keys 1..n of a PPS table, computed once; theta 0 is uniform
+struct PPSKeyDist {
+	uint64_t n;
+	double theta;
+	double zetan;
+	double zeta_2_theta;
+};
+
 class PPSQueryGenerator : public QueryGenerator {
 public:
+  // with SEED set, generator gen_id of a node always draws the same queries
+  void init(uint64_t gen_id = 0);
   BaseQuery * create_query(Workload * h_wl, uint64_t home_partition_id);
 
 private:
@@ -39,7 +49,13 @@ private:
 	BaseQuery * gen_requests_orderproduct(uint64_t home_partition_id);
 	BaseQuery * gen_requests_updateproductpart(uint64_t home_partition_id);
 	BaseQuery * gen_requests_updatepart(uint64_t home_partition_id);
+	uint64_t gen_key(const PPSKeyDist &dist);
+	static void init_dist(PPSKeyDist &dist, uint64_t n);
 	myrand * mrand;
+	static PPSKeyDist part_dist;
+	static PPSKeyDist supplier_dist;
+	static PPSKeyDist product_dist;
+	static pthread_mutex_t dist_lock;
 };
 
 class PPSQuery : public BaseQuery {
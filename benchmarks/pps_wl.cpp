@@ -18,6 +18,7 @@
 #include "helper.h"
 #include "pps.h"
 #include "wl.h"
+#include "checkpoint.h"
 #include "thread.h"
 #include "table.h"
 #include "index_hash.h"
@@ -46,12 +47,24 @@ RC PPSWorkload::init() {
   printf("Done\n");
   printf("Initializing table... ");
   fflush(stdout);
-	init_table();
+#if CKPT_LOAD
+	if (checkpointer.load(this) != RCOK)
+#endif
+	if (load_snapshot() != RCOK) {
+		init_table();
+		dump_snapshot();
+	}
   printf("Done\n");
   fflush(stdout);
 	return RCOK;
 }
 
+string PPSWorkload::snapshot_key() {
+	return Workload::snapshot_key() + "_" + to_string(g_max_part_key) + "_" +
+				 to_string(g_max_product_key) + "_" + to_string(g_max_supplier_key) + "_" +
+				 to_string(g_max_parts_per) + "_a" + to_string(g_pps_part_affinity);
+}
+
 RC PPSWorkload::init_schema(const char * schema_file) {
 	Workload::init_schema(schema_file);
 	t_suppliers = tables["SUPPLIERS"];
@@ -79,23 +92,31 @@ RC PPSWorkload::init_table() {
 // --products
 /**********************************/
 
-  pps_thr_args * tt = new pps_thr_args[g_init_parallelism];
-	for (UInt32 i = 0; i < g_init_parallelism ; i++) {
+  // every table is split by partition: loader thread i loads the rows of the
+  // partitions p with p % thd_cnt == i
+  uint64_t starttime = get_server_clock();
+  UInt32 thd_cnt = get_load_thread_cnt();
+  pthread_t * p_thds = new pthread_t[thd_cnt - 1];
+  pps_thr_args * tt = new pps_thr_args[thd_cnt];
+	for (UInt32 i = 0; i < thd_cnt ; i++) {
     tt[i].wl = this;
     tt[i].id = i;
+    tt[i].tot = thd_cnt;
   }
-
-  threadInitParts(&tt[0]);
-  printf("PARTS Done\n");
-  threadInitProducts(&tt[0]);
-  printf("PRODUCTS Done\n");
-  threadInitSuppliers(&tt[0]);
-  printf("SUPPLIERS Done\n");
-  threadInitUses(&tt[0]);
-  printf("USES Done\n");
-  threadInitSupplies(&tt[0]);
-  printf("SUPPLIES Done\n");
-  fflush(stdout);
+  for (UInt32 i = 0; i < thd_cnt - 1; i++) {
+    pthread_create(&p_thds[i], NULL, threadLoad, &tt[i]);
+  }
+  threadLoad(&tt[thd_cnt - 1]);
+  for (UInt32 i = 0; i < thd_cnt - 1; i++) {
+    int rc = pthread_join(p_thds[i], NULL);
+    if (rc) {
+      printf("ERROR; return code from pthread_join() is %d\n", rc);
+      exit(-1);
+    }
+  }
+  delete[] p_thds;
+  delete[] tt;
+  print_load_stats(starttime);
 	printf("\nData Initialization Complete!\n\n");
 	return RCOK;
 }
@@ -108,13 +129,13 @@ RC PPSWorkload::get_txn_man(TxnManager *& txn_manager) {
 	return RCOK;
 }
 
-void PPSWorkload::init_tab_parts() {
+void PPSWorkload::init_tab_parts(UInt32 tid, UInt32 tot) {
   char * padding = new char[100];
   for (int i = 0; i < 100; i++) {
     padding[i] = 'z';
   }
   for (UInt32 id = 1; id <= g_max_part_key; id++) {
-    if (GET_NODE_ID(parts_to_partition(id)) != g_node_id) continue;
+    if (GET_NODE_ID(parts_to_partition(id)) != g_node_id || parts_to_partition(id) % tot != tid) continue;
 		row_t * row;
 		uint64_t row_id;
     t_parts->get_new_row(row, 0, row_id);
@@ -132,19 +153,19 @@ void PPSWorkload::init_tab_parts() {
     row->set_value(FIELD9,padding);
     row->set_value(FIELD10,padding);
 
-		index_insert(i_parts, id, row, parts_to_partition(id));
+		index_load(i_parts, id, row, parts_to_partition(id));
     DEBUG("PARTS added (%d, ...)\n",id);
 
   }
 }
 
-void PPSWorkload::init_tab_suppliers() {
+void PPSWorkload::init_tab_suppliers(UInt32 tid, UInt32 tot) {
   char * padding = new char[100];
   for (int i = 0; i < 100; i++) {
     padding[i] = 'z';
   }
   for (UInt32 id = 1; id <= g_max_supplier_key; id++) {
-    if (GET_NODE_ID(suppliers_to_partition(id)) != g_node_id) continue;
+    if (GET_NODE_ID(suppliers_to_partition(id)) != g_node_id || suppliers_to_partition(id) % tot != tid) continue;
 		row_t * row;
 		uint64_t row_id;
     t_suppliers->get_new_row(row, 0, row_id);
@@ -161,18 +182,18 @@ void PPSWorkload::init_tab_suppliers() {
     row->set_value(FIELD9,padding);
     row->set_value(FIELD10,padding);
 
-		index_insert(i_suppliers, id, row, suppliers_to_partition(id));
+		index_load(i_suppliers, id, row, suppliers_to_partition(id));
 
   }
 }
 
-void PPSWorkload::init_tab_products() {
+void PPSWorkload::init_tab_products(UInt32 tid, UInt32 tot) {
   char * padding = new char[100];
   for (int i = 0; i < 100; i++) {
     padding[i] = 'z';
   }
   for (UInt32 id = 1; id <= g_max_product_key; id++) {
-    if (GET_NODE_ID(products_to_partition(id)) != g_node_id) continue;
+    if (GET_NODE_ID(products_to_partition(id)) != g_node_id || products_to_partition(id) % tot != tid) continue;
 		row_t * row;
 		uint64_t row_id;
     t_products->get_new_row(row, 0, row_id);
@@ -189,17 +210,27 @@ void PPSWorkload::init_tab_products() {
     row->set_value(FIELD9,padding);
     row->set_value(FIELD10,padding);
 
-		index_insert(i_products, id, row, products_to_partition(id));
+		index_load(i_products, id, row, products_to_partition(id));
     DEBUG("PRODUCTS added (%d, ...)\n",id);
 
   }
 }
 
-void PPSWorkload::init_tab_supplies() {
+// a part for a supplier or product of partition part_id, see PPS_PART_AFFINITY
+static uint64_t gen_part_key(uint64_t part_id) {
+  uint64_t part_key = URand(1, g_max_part_key);
+  if ((double)RAND(10000) / 10000 < g_pps_part_affinity) {
+    while (parts_to_partition(part_key) != part_id) part_key = URand(1, g_max_part_key);
+  }
+  return part_key;
+}
+
+void PPSWorkload::init_tab_supplies(UInt32 tid, UInt32 tot) {
   for (UInt32 id = 1; id <= g_max_supplier_key; id++) {
+    if (suppliers_to_partition(id) % tot != tid) continue;
     std::set<uint64_t> parts_set;
     for (UInt32 i = 0; i < g_max_parts_per; i++) {
-      parts_set.insert(URand(1,g_max_part_key));
+      parts_set.insert(gen_part_key(suppliers_to_partition(id)));
     }
     for(auto it = parts_set.begin(); it != parts_set.end();it++) {
       row_t * row;
@@ -211,17 +242,18 @@ void PPSWorkload::init_tab_supplies() {
       //row->set_value(PART_KEY,part_id);
       row->set_value(0,id);
       row->set_value(1,part_id);
-      index_insert_nonunique(i_supplies, id, row, suppliers_to_partition(id));
+      index_load(i_supplies, id, row, suppliers_to_partition(id), true);
     }
   }
 
 }
 
-void PPSWorkload::init_tab_uses() {
+void PPSWorkload::init_tab_uses(UInt32 tid, UInt32 tot) {
   for (UInt32 id = 1; id <= g_max_product_key; id++) {
+    if (products_to_partition(id) % tot != tid) continue;
     std::set<uint64_t> parts_set;
     for (UInt32 i = 0; i < g_max_parts_per; i++) {
-      parts_set.insert(URand(1,g_max_part_key));
+      parts_set.insert(gen_part_key(products_to_partition(id)));
     }
     for(auto it = parts_set.begin(); it != parts_set.end();it++) {
       row_t * row;
@@ -233,7 +265,7 @@ void PPSWorkload::init_tab_uses() {
       //row->set_value(PART_KEY,part_id);
       row->set_value(0,id);
       row->set_value(1,part_id);
-      index_insert_nonunique(i_uses, id, row, products_to_partition(id));
+      index_load(i_uses, id, row, products_to_partition(id), true);
       DEBUG("USES added (%d, %ld) -- %lx\n",id,part_id,(uint64_t)row);
     }
   }
@@ -241,43 +273,15 @@ void PPSWorkload::init_tab_uses() {
 }
 
 
-/*==================================================================+
-| ROUTINE NAME
-| InitPermutation
-+==================================================================*/
-
-void * PPSWorkload::threadInitSuppliers(void * This) {
+void * PPSWorkload::threadLoad(void * This) {
   PPSWorkload * wl = ((pps_thr_args*) This)->wl;
-  //int id = ((pps_thr_args*) This)->id;
-	wl->init_tab_suppliers();
+  UInt32 id = ((pps_thr_args*) This)->id;
+  UInt32 tot = ((pps_thr_args*) This)->tot;
+	wl->init_tab_parts(id, tot);
+	wl->init_tab_products(id, tot);
+	wl->init_tab_suppliers(id, tot);
+	wl->init_tab_uses(id, tot);
+	wl->init_tab_supplies(id, tot);
+	wl->flush_index_load();
 	return NULL;
 }
-
-void * PPSWorkload::threadInitProducts(void * This) {
-  PPSWorkload * wl = ((pps_thr_args*) This)->wl;
-  //int id = ((pps_thr_args*) This)->id;
-	wl->init_tab_products();
-	return NULL;
-}
-
-void * PPSWorkload::threadInitParts(void * This) {
-  PPSWorkload * wl = ((pps_thr_args*) This)->wl;
-  //int id = ((pps_thr_args*) This)->id;
-	wl->init_tab_parts();
-	return NULL;
-}
-
-void * PPSWorkload::threadInitSupplies(void * This) {
-  PPSWorkload * wl = ((pps_thr_args*) This)->wl;
-  //int id = ((pps_thr_args*) This)->id;
-	wl->init_tab_supplies();
-	return NULL;
-}
-
-void * PPSWorkload::threadInitUses(void * This) {
-  PPSWorkload * wl = ((pps_thr_args*) This)->wl;
-  //int id = ((pps_thr_args*) This)->id;
-	wl->init_tab_uses();
-	return NULL;
-}
-
@@ -48,6 +48,29 @@ enum TPCCRemTxnType {
   TPCC_NEWORDER7,
   TPCC_NEWORDER8,
   TPCC_NEWORDER9,
+  TPCC_ORDERSTATUS0,
+  TPCC_ORDERSTATUS1,
+  TPCC_ORDERSTATUS2,
+  TPCC_ORDERSTATUS3,
+  TPCC_ORDERSTATUS4,
+  TPCC_ORDERSTATUS5,
+  TPCC_DELIVERY0,
+  TPCC_DELIVERY1,
+  TPCC_DELIVERY2,
+  TPCC_DELIVERY3,
+  TPCC_DELIVERY4,
+  TPCC_DELIVERY5,
+  TPCC_DELIVERY6,
+  TPCC_DELIVERY7,
+  TPCC_DELIVERY8,
+  TPCC_DELIVERY9,
+  TPCC_DELIVERY10,
+  TPCC_STOCKLEVEL0,
+  TPCC_STOCKLEVEL1,
+  TPCC_STOCKLEVEL2,
+  TPCC_STOCKLEVEL3,
+  TPCC_STOCKLEVEL4,
+  TPCC_STOCKLEVEL5,
   TPCC_FIN,
   TPCC_RDONE
 };
@@ -59,6 +82,12 @@ public:
 	RC init_table();
 	RC init_schema(const char * schema_file);
 	RC get_txn_man(TxnManager *& txn_manager);
+	row_t * get_recovery_row(table_t * table, uint64_t key, uint64_t part_id, const char * image);
+	RC recovery_insert(table_t * table, uint64_t key, uint64_t part_id, const char * image);
+	RC recovery_delete(table_t * table, uint64_t key, uint64_t part_id, const char * image);
+	// add an ORDER, NEW-ORDER or ORDER-LINE row inserted at run time to its indexes
+	void index_new_row(row_t * row);
+	string snapshot_key();
 	table_t * 		t_warehouse;
 	table_t * 		t_district;
 	table_t * 		t_customer;
@@ -77,9 +106,13 @@ public:
 	INDEX * 	i_stock;
 	INDEX * 	i_order; // key = (w_id, d_id, o_id)
 //	INDEX * 	i_order_wdo; // key = (w_id, d_id, o_id)
-//	INDEX * 	i_order_wdc; // key = (w_id, d_id, c_id)
+	INDEX * 	i_order_wdc; // key = (w_id, d_id, c_id)
 	INDEX * 	i_orderline; // key = (w_id, d_id, o_id)
 	INDEX * 	i_orderline_wd; // key = (w_id, d_id).
+	INDEX * 	i_neworder; // key = (w_id, d_id, o_id)
+
+	// per district (distKey): no NEW-ORDER row below this o_id is left to deliver
+	uint64_t volatile * delivery_cursor;
 
 	// XXX HACK
 	// For delivary. Only one txn can be delivering a warehouse at a time.
@@ -89,27 +122,20 @@ public:
 
 public:
 	uint64_t num_wh;
-	void init_tab_item(int id);
-	void init_tab_wh();
-	void init_tab_dist(uint64_t w_id);
-	void init_tab_stock(int id,uint64_t w_id);
-	// init_tab_cust initializes both tab_cust and tab_hist.
-	void init_tab_cust(int id, uint64_t d_id, uint64_t w_id);
+	void init_tab_item(int id, int tot);
+	void init_tab_wh(uint64_t w_id);
+	void init_tab_dist(uint64_t d_id, uint64_t w_id);
+	void init_tab_stock(uint64_t d_id, uint64_t w_id);
+	void init_tab_cust(uint64_t d_id, uint64_t w_id);
 	void init_tab_hist(uint64_t c_id, uint64_t d_id, uint64_t w_id);
-	void init_tab_order(int id,uint64_t d_id, uint64_t w_id);
-
-	UInt32 perm_count;
-	uint64_t * perm_c_id;
-	void init_permutation();
-	uint64_t get_permutation();
-
-	static void * threadInitItem(void * This);
-	static void * threadInitWh(void * This);
-	static void * threadInitDist(void * This);
-	static void * threadInitStock(void * This);
-	static void * threadInitCust(void * This);
-	static void * threadInitHist(void * This);
-	static void * threadInitOrder(void * This);
+	void init_tab_order(uint64_t d_id, uint64_t w_id);
+	void load_slice(uint64_t d_id, uint64_t w_id);
+
+	uint64_t * init_permutation(uint64_t d_id, uint64_t w_id);
+
+	// next (warehouse, district) slice to load, see threadLoad
+	uint64_t volatile load_next_slice;
+	static void * threadLoad(void * This);
 };
 
   struct thr_args{
@@ -130,6 +156,7 @@ public:
   RC run_tpcc_phase5();
 	TPCCRemTxnType state;
   void copy_remote_items(TPCCQueryMessage * msg);
+  void commit_indexes();
 private:
 	TPCCWorkload * _wl;
 	volatile RC _rc;
@@ -139,6 +166,14 @@ private:
 
 void next_tpcc_state();
 RC run_txn_state();
+  // resumable bodies (TXN_COROUTINE); a participant enters at the state of its RQRY
+  RC run_txn_co();
+  RC run_payment_co();
+  RC run_new_order_co();
+  RC run_order_status_co();
+  RC run_delivery_co();
+  RC run_stock_level_co();
+  bool is_local_wh(uint64_t w_id);
   bool is_done();
   bool is_local_item(uint64_t idx);
   RC send_remote_request();
@@ -175,9 +210,47 @@ RC run_txn_state();
   RC new_order_9(uint64_t w_id, uint64_t d_id, bool remote, uint64_t ol_i_id,
                  uint64_t ol_supply_w_id, uint64_t ol_quantity, uint64_t ol_number,
                  uint64_t ol_amount, uint64_t o_id, row_t* r_stock_local);
-	RC run_order_status(TPCCQuery * query);
-	RC run_delivery(TPCCQuery * query);
-	RC run_stock_level(TPCCQuery * query);
+  RC order_status_0(uint64_t w_id, uint64_t d_id, uint64_t c_id, char* c_last,
+                    bool by_last_name, row_t*& r_cust_local);
+  RC order_status_1(uint64_t w_id, uint64_t d_id, row_t* r_cust_local);
+  RC order_status_2(row_t*& r_order_local);
+  RC order_status_3(uint64_t w_id, uint64_t d_id, row_t* r_order_local);
+  RC order_status_4(row_t*& r_ol_local);
+  RC order_status_5(row_t* r_ol_local);
+  RC delivery_0(uint64_t w_id, uint64_t d_id, row_t*& r_dist_local);
+  RC delivery_1(uint64_t w_id, uint64_t d_id, row_t* r_dist_local);
+  RC delivery_2(row_t*& r_no_local);
+  RC delivery_3(uint64_t w_id, uint64_t d_id, row_t* r_no_local);
+  RC delivery_4(row_t*& r_order_local);
+  RC delivery_5(uint64_t w_id, uint64_t d_id, uint64_t o_carrier_id, row_t* r_order_local);
+  RC delivery_6(row_t*& r_ol_local);
+  RC delivery_7(uint64_t ol_delivery_d, row_t* r_ol_local);
+  RC delivery_8(uint64_t w_id, uint64_t d_id, row_t*& r_cust_local);
+  RC delivery_9(row_t* r_cust_local);
+  RC stock_level_0(uint64_t w_id, uint64_t d_id, row_t*& r_dist_local);
+  RC stock_level_1(uint64_t w_id, uint64_t d_id, row_t* r_dist_local);
+  RC stock_level_2(row_t*& r_ol_local);
+  RC stock_level_3(uint64_t w_id, uint64_t d_id, row_t* r_ol_local);
+  RC stock_level_4(uint64_t w_id, row_t*& r_stock_local);
+  RC stock_level_5(uint64_t threshold, row_t* r_stock_local);
+  row_t * get_cust_by_last_name(char * c_last, uint64_t c_d_id, uint64_t c_w_id);
+  void next_scan_order(uint64_t w_id, uint64_t d_id);
+
+  // cursor of Order-Status, Delivery and Stock-Level over an index chain
+  itemid_t * scan_item;
+  uint64_t scan_o_id;
+  uint64_t scan_end;
+  // Delivery: the order being delivered and the NEW-ORDER keys it deletes at commit
+  uint64_t deliver_c_id;
+  double deliver_amount;
+  uint64_t deliver_cnt;
+  uint64_t deliver_d_id[DIST_PER_WH];
+  uint64_t deliver_o_id[DIST_PER_WH];
+  row_t * deliver_row[DIST_PER_WH];
+  // Stock-Level
+  uint64_t sl_i_id;
+  uint64_t sl_low_stock;
+  std::set<uint64_t> sl_items;
 };
 
 #endif
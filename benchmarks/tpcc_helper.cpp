@@ -52,10 +52,10 @@ uint64_t w_from_orderPrimaryKey(uint64_t s_key) { return w_from_orderlineKey(s_k
 uint64_t w_from_custNPKey(uint64_t cnp_key) { return (cnp_key / g_dist_per_wh) & 0x3ff; }
 
 uint64_t w_from_stockKey(uint64_t s_key) { return s_key / g_max_items; }
-/*
 uint64_t orderKey(uint64_t o_id, uint64_t o_d_id, uint64_t o_w_id) {
-	return ((o_w_id * g_dist_per_wh + o_d_id) * ORD_PER_DIST + o_id);
+	return (distKey(o_d_id, o_w_id) << 32) + o_id;
 }
+/*
 // the max of ol_number is 15. That's why there is a 15 here
 uint64_t olKey(uint64_t ol_o_id, uint64_t ol_d_id,
 	uint64_t ol_w_id, uint64_t ol_number) {
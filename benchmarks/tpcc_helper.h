@@ -34,7 +34,9 @@ uint64_t w_from_orderlineKey(uint64_t s_key);
 uint64_t w_from_orderPrimaryKey(uint64_t s_key);
 uint64_t w_from_custNPKey(uint64_t cnp_key);
 uint64_t w_from_stockKey(uint64_t s_key);
-//uint64_t orderKey(uint64_t o_id, uint64_t o_d_id, uint64_t o_w_id);
+// orders of a district are not bounded by the customer count, so o_id gets the low 32 bits.
+// ORDER, NEW-ORDER and the lines of an order (ORDER-LINE) share this key.
+uint64_t orderKey(uint64_t o_id, uint64_t o_d_id, uint64_t o_w_id);
 // the max of ol_number is 15. That's why there is a 15 here
 //uint64_t olKey(uint64_t ol_o_id, uint64_t ol_d_id,
 //	uint64_t ol_w_id, uint64_t ol_number);
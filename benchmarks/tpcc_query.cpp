@@ -23,17 +23,28 @@
 #include "table.h"
 #include "message.h"
 
-void TPCCQueryGenerator::init(){
+void TPCCQueryGenerator::init(uint64_t gen_id){
 	mrand = (myrand *) mem_allocator.alloc(sizeof(myrand));
-	mrand->init(get_sys_clock());  
+	mrand->init(g_seed * 1000003 + gen_id);
 }
 
 BaseQuery * TPCCQueryGenerator::create_query(Workload * h_wl,uint64_t home_partition_id) {
   double x = (double)(rand() % 100) / 100.0;
 	if (x < g_perc_payment)
 		return gen_payment(home_partition_id);
-	else
-		return gen_new_order(home_partition_id);
+#if CC_ALG != CALVIN
+	// the Calvin lock schedule only covers the read/write sets of payment and new-order
+	x -= g_perc_payment;
+	if (x < g_perc_order_status)
+		return gen_order_status(home_partition_id);
+	x -= g_perc_order_status;
+	if (x < g_perc_delivery)
+		return gen_delivery(home_partition_id);
+	x -= g_perc_delivery;
+	if (x < g_perc_stock_level)
+		return gen_stock_level(home_partition_id);
+#endif
+	return gen_new_order(home_partition_id);
 
 }
 
@@ -81,6 +92,13 @@ std::set<uint64_t> TPCCQuery::participants(Message * msg, Workload * wl) {
         participant_set.insert(req_nid);
       }
       break;
+    case TPCC_ORDER_STATUS:
+    case TPCC_DELIVERY:
+    case TPCC_STOCK_LEVEL:
+      // every row they touch is in the home warehouse
+      id = GET_NODE_ID(wh_to_part(tpcc_msg->w_id));
+      participant_set.insert(id);
+      break;
     default:
       assert(false);
   }
@@ -132,6 +150,15 @@ uint64_t TPCCQuery::participants(bool *& pps,Workload * wl) {
         }
       }
       break;
+    case TPCC_ORDER_STATUS:
+    case TPCC_DELIVERY:
+    case TPCC_STOCK_LEVEL:
+      id = GET_NODE_ID(wh_to_part(w_id));
+      if(!pps[id]) {
+        pps[id] = true;
+        n++;
+      }
+      break;
     default:
       assert(false);
   }
@@ -139,7 +166,9 @@ uint64_t TPCCQuery::participants(bool *& pps,Workload * wl) {
   return n;
 }
 
-bool TPCCQuery::readonly() { return false; }
+bool TPCCQuery::readonly() {
+  return txn_type == TPCC_ORDER_STATUS || txn_type == TPCC_STOCK_LEVEL;
+}
 
 BaseQuery * TPCCQueryGenerator::gen_payment(uint64_t home_partition) {
   TPCCQuery * query = new TPCCQuery;
@@ -221,7 +250,7 @@ BaseQuery * TPCCQueryGenerator::gen_payment(uint64_t home_partition) {
 		} else
       query->c_w_id = query->w_id;
 	}
-	if(y < 0) {
+	if(y <= PERC_BY_LAST_NAME) {
 		// by last name
 		query->by_last_name = true;
 		Lastname(NURand(255,0,999),query->c_last);
@@ -342,6 +371,72 @@ BaseQuery * TPCCQueryGenerator::gen_new_order(uint64_t home_partition) {
 
 }
 
+// home warehouse of order-status, delivery and stock-level, which only touch that warehouse
+uint64_t TPCCQueryGenerator::gen_home_wh(uint64_t home_partition) {
+  uint64_t w_id;
+	if (FIRST_PART_LOCAL) {
+    while (wh_to_part(w_id = URand(1, g_num_wh)) != home_partition) {}
+  } else if (SINGLE_PART) {
+#if SINGLE_PART_0
+    w_id = 1;
+#else
+    while (GET_NODE_ID(wh_to_part(w_id = URand(1, g_num_wh))) != home_partition) {}
+#endif
+  } else
+		w_id = URand(1, g_num_wh);
+  return w_id;
+}
+
+BaseQuery * TPCCQueryGenerator::gen_order_status(uint64_t home_partition) {
+  TPCCQuery * query = new TPCCQuery;
+	query->txn_type = TPCC_ORDER_STATUS;
+  query->w_id = gen_home_wh(home_partition);
+	query->d_id = URand(1, g_dist_per_wh);
+	query->c_w_id = query->w_id;
+	query->c_d_id = query->d_id;
+  query->rbk = false;
+	if (URand(1, 100) <= PERC_BY_LAST_NAME) {
+		// by last name
+		query->by_last_name = true;
+		Lastname(NURand(255,0,999),query->c_last);
+	} else {
+		// by cust id
+		query->by_last_name = false;
+		query->c_id = NURand(1023, 1, g_cust_per_dist);
+	}
+
+  query->partitions.init(1);
+  query->partitions.add(wh_to_part(query->w_id));
+  return query;
+}
+
+BaseQuery * TPCCQueryGenerator::gen_delivery(uint64_t home_partition) {
+  TPCCQuery * query = new TPCCQuery;
+	query->txn_type = TPCC_DELIVERY;
+  query->w_id = gen_home_wh(home_partition);
+	query->d_id = 0; // all districts
+  query->rbk = false;
+	query->o_carrier_id = URand(1, 10);
+	query->ol_delivery_d = 2013;
+
+  query->partitions.init(1);
+  query->partitions.add(wh_to_part(query->w_id));
+  return query;
+}
+
+BaseQuery * TPCCQueryGenerator::gen_stock_level(uint64_t home_partition) {
+  TPCCQuery * query = new TPCCQuery;
+	query->txn_type = TPCC_STOCK_LEVEL;
+  query->w_id = gen_home_wh(home_partition);
+	query->d_id = URand(1, g_dist_per_wh);
+  query->rbk = false;
+	query->threshold = URand(10, 20);
+
+  query->partitions.init(1);
+  query->partitions.add(wh_to_part(query->w_id));
+  return query;
+}
+
 uint64_t TPCCQuery::get_participants(Workload * wl) {
    uint64_t participant_cnt = 0;
    uint64_t active_cnt = 0;
@@ -41,13 +41,17 @@ struct Item_no {
 
 class TPCCQueryGenerator : public QueryGenerator {
 public:
-	void init();
+	void init(uint64_t gen_id = 0);
   BaseQuery * create_query(Workload * h_wl, uint64_t home_partition_id);
 
 private:
 	BaseQuery * gen_requests(uint64_t home_partition_id, Workload * h_wl);
   BaseQuery * gen_payment(uint64_t home_partition);
   BaseQuery * gen_new_order(uint64_t home_partition);
+  BaseQuery * gen_order_status(uint64_t home_partition);
+  BaseQuery * gen_delivery(uint64_t home_partition);
+  BaseQuery * gen_stock_level(uint64_t home_partition);
+  uint64_t gen_home_wh(uint64_t home_partition);
 	myrand * mrand;
 };
 
@@ -86,7 +90,9 @@ public:
 	// Input for delivery
 	uint64_t o_carrier_id;
 	uint64_t ol_delivery_d;
-	// for order-status
+	// for order-status: w_id, d_id and the customer inputs of payment
+	// for stock-level
+	uint64_t threshold;
 
 	// Other
 	uint64_t ol_i_id;
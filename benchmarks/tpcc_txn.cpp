@@ -28,6 +28,7 @@
 #include "transport.h"
 #include "msg_queue.h"
 #include "message.h"
+#include <algorithm>
 
 void TPCCTxnManager::init(uint64_t thd_id, Workload * h_wl) {
 	TxnManager::init(thd_id, h_wl);
@@ -43,8 +44,20 @@ void TPCCTxnManager::reset() {
 		state = TPCC_PAYMENT0;
 	} else if (tpcc_query->txn_type == TPCC_NEW_ORDER) {
 		state = TPCC_NEWORDER0;
+	} else if (tpcc_query->txn_type == TPCC_ORDER_STATUS) {
+		state = TPCC_ORDERSTATUS0;
+	} else if (tpcc_query->txn_type == TPCC_DELIVERY) {
+		state = TPCC_DELIVERY0;
+	} else if (tpcc_query->txn_type == TPCC_STOCK_LEVEL) {
+		state = TPCC_STOCKLEVEL0;
 	}
 	next_item_id = 0;
+	scan_item = NULL;
+	scan_o_id = 0;
+	scan_end = 0;
+	deliver_cnt = 0;
+	sl_low_stock = 0;
+	sl_items.clear();
 	TxnManager::reset();
 }
 
@@ -55,7 +68,9 @@ RC TPCCTxnManager::run_txn_post_wait() {
 	txn_stats.process_time += curr_time - starttime;
 	txn_stats.process_time_short += curr_time - starttime;
 
+#if !TXN_COROUTINE
 	next_tpcc_state();
+#endif
 	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - curr_time);
 	return RCOK;
 }
@@ -73,7 +88,9 @@ RC TPCCTxnManager::run_txn() {
 	return rc;
 #endif
 
-	if(IS_LOCAL(txn->txn_id) && (state == TPCC_PAYMENT0 || state == TPCC_NEWORDER0)) {
+	if (IS_LOCAL(txn->txn_id) && co_point == 0 &&
+			(state == TPCC_PAYMENT0 || state == TPCC_NEWORDER0 || state == TPCC_ORDERSTATUS0 ||
+			 state == TPCC_DELIVERY0 || state == TPCC_STOCKLEVEL0)) {
 		DEBUG("Running txn %ld\n",txn->txn_id);
 #if DISTR_DEBUG
 		query->print();
@@ -81,10 +98,13 @@ RC TPCCTxnManager::run_txn() {
 		query->partitions_touched.add_unique(GET_PART_ID(0,g_node_id));
 	}
 
-
+#if TXN_COROUTINE
+	rc = run_txn_co();
+#else
 	while(rc == RCOK && !is_done()) {
 		rc = run_txn_state();
 	}
+#endif
 
 	uint64_t curr_time = get_sys_clock();
 	txn_stats.process_time += curr_time - starttime;
@@ -113,6 +133,11 @@ bool TPCCTxnManager::is_done() {
 			//done = next_item_id == tpcc_query->ol_cnt || state == TPCC_FIN;
 			done = next_item_id >= tpcc_query->items.size() || state == TPCC_FIN;
 			break;
+		case TPCC_ORDER_STATUS:
+		case TPCC_DELIVERY:
+		case TPCC_STOCK_LEVEL:
+			done = state == TPCC_FIN;
+			break;
 		default:
 			assert(false);
 	}
@@ -163,18 +188,7 @@ RC TPCCTxnManager::acquire_locks() {
 			// Cust
 				if (tpcc_query->by_last_name) {
 
-					key = custNPKey(c_last, c_d_id, c_w_id);
-					index = _wl->i_customer_last;
-					item = index_read(index, key, part_id_c_w);
-					int cnt = 0;
-					itemid_t * it = item;
-					itemid_t * mid = item;
-					while (it != NULL) {
-						cnt ++;
-						it = it->next;
-						if (cnt % 2 == 0) mid = mid->next;
-					}
-					row = ((row_t *)mid->location);
+					row = get_cust_by_last_name(c_last, c_d_id, c_w_id);
 
 				} else {
 					key = custKey(c_id, c_d_id, c_w_id);
@@ -306,6 +320,70 @@ void TPCCTxnManager::next_tpcc_state() {
 				state = TPCC_FIN;
 			}
 			break;
+		case TPCC_ORDERSTATUS0:
+			state = TPCC_ORDERSTATUS1;
+			break;
+		case TPCC_ORDERSTATUS1:
+			state = scan_item != NULL ? TPCC_ORDERSTATUS2 : TPCC_FIN;
+			break;
+		case TPCC_ORDERSTATUS2:
+			state = TPCC_ORDERSTATUS3;
+			break;
+		case TPCC_ORDERSTATUS3:
+		case TPCC_ORDERSTATUS5: // loop over the order lines
+			state = scan_item != NULL ? TPCC_ORDERSTATUS4 : TPCC_FIN;
+			break;
+		case TPCC_ORDERSTATUS4:
+			state = TPCC_ORDERSTATUS5;
+			break;
+		case TPCC_DELIVERY0: // loop over the districts
+			state = TPCC_DELIVERY1;
+			break;
+		case TPCC_DELIVERY1:
+			state = scan_item != NULL ? TPCC_DELIVERY2 : TPCC_DELIVERY10;
+			break;
+		case TPCC_DELIVERY2:
+			state = TPCC_DELIVERY3;
+			break;
+		case TPCC_DELIVERY3:
+			state = scan_item != NULL ? TPCC_DELIVERY4 : TPCC_DELIVERY10;
+			break;
+		case TPCC_DELIVERY4:
+			state = TPCC_DELIVERY5;
+			break;
+		case TPCC_DELIVERY5:
+		case TPCC_DELIVERY7: // loop over the order lines
+			state = scan_item != NULL ? TPCC_DELIVERY6 : TPCC_DELIVERY8;
+			break;
+		case TPCC_DELIVERY6:
+			state = TPCC_DELIVERY7;
+			break;
+		case TPCC_DELIVERY8:
+			state = TPCC_DELIVERY9;
+			break;
+		case TPCC_DELIVERY9:
+			state = TPCC_DELIVERY10;
+			break;
+		case TPCC_DELIVERY10:
+			++next_item_id;
+			state = next_item_id < g_dist_per_wh ? TPCC_DELIVERY0 : TPCC_FIN;
+			break;
+		case TPCC_STOCKLEVEL0:
+			state = TPCC_STOCKLEVEL1;
+			break;
+		case TPCC_STOCKLEVEL1:
+		case TPCC_STOCKLEVEL5: // loop over the order lines of the last 20 orders
+			state = scan_item != NULL ? TPCC_STOCKLEVEL2 : TPCC_FIN;
+			break;
+		case TPCC_STOCKLEVEL2:
+			state = TPCC_STOCKLEVEL3;
+			break;
+		case TPCC_STOCKLEVEL3:
+			state = TPCC_STOCKLEVEL4;
+			break;
+		case TPCC_STOCKLEVEL4:
+			state = TPCC_STOCKLEVEL5;
+			break;
 		case TPCC_FIN:
 			break;
 		default:
@@ -490,6 +568,75 @@ RC TPCCTxnManager::run_txn_state() {
 			rc = new_order_9(w_id, d_id, remote, ol_i_id, ol_supply_w_id, ol_quantity, ol_number,
 											 ol_amount, o_id, row);
 						break;
+		// Order-Status, Delivery and Stock-Level only touch the home warehouse
+		case TPCC_ORDERSTATUS0 :
+			rc = order_status_0(w_id, d_id, c_id, c_last, by_last_name, row);
+			break;
+		case TPCC_ORDERSTATUS1 :
+			rc = order_status_1(w_id, d_id, row);
+			break;
+		case TPCC_ORDERSTATUS2 :
+			rc = order_status_2(row);
+			break;
+		case TPCC_ORDERSTATUS3 :
+			rc = order_status_3(w_id, d_id, row);
+			break;
+		case TPCC_ORDERSTATUS4 :
+			rc = order_status_4(row);
+			break;
+		case TPCC_ORDERSTATUS5 :
+			rc = order_status_5(row);
+			break;
+		case TPCC_DELIVERY0 :
+			rc = delivery_0(w_id, next_item_id + 1, row);
+			break;
+		case TPCC_DELIVERY1 :
+			rc = delivery_1(w_id, next_item_id + 1, row);
+			break;
+		case TPCC_DELIVERY2 :
+			rc = delivery_2(row);
+			break;
+		case TPCC_DELIVERY3 :
+			rc = delivery_3(w_id, next_item_id + 1, row);
+			break;
+		case TPCC_DELIVERY4 :
+			rc = delivery_4(row);
+			break;
+		case TPCC_DELIVERY5 :
+			rc = delivery_5(w_id, next_item_id + 1, tpcc_query->o_carrier_id, row);
+			break;
+		case TPCC_DELIVERY6 :
+			rc = delivery_6(row);
+			break;
+		case TPCC_DELIVERY7 :
+			rc = delivery_7(tpcc_query->ol_delivery_d, row);
+			break;
+		case TPCC_DELIVERY8 :
+			rc = delivery_8(w_id, next_item_id + 1, row);
+			break;
+		case TPCC_DELIVERY9 :
+			rc = delivery_9(row);
+			break;
+		case TPCC_DELIVERY10 :
+			break;
+		case TPCC_STOCKLEVEL0 :
+			rc = stock_level_0(w_id, d_id, row);
+			break;
+		case TPCC_STOCKLEVEL1 :
+			rc = stock_level_1(w_id, d_id, row);
+			break;
+		case TPCC_STOCKLEVEL2 :
+			rc = stock_level_2(row);
+			break;
+		case TPCC_STOCKLEVEL3 :
+			rc = stock_level_3(w_id, d_id, row);
+			break;
+		case TPCC_STOCKLEVEL4 :
+			rc = stock_level_4(w_id, row);
+			break;
+		case TPCC_STOCKLEVEL5 :
+			rc = stock_level_5(tpcc_query->threshold, row);
+			break;
 		case TPCC_FIN :
 				state = TPCC_FIN;
 			if (tpcc_query->rbk) return Abort;
@@ -504,6 +651,234 @@ RC TPCCTxnManager::run_txn_state() {
 	return rc;
 }
 
+bool TPCCTxnManager::is_local_wh(uint64_t w_id) {
+#if MIGRATION
+	if (g_node_id == MIGRATION_DES_NODE) return true;
+#endif
+	return GET_NODE_ID(wh_to_part(w_id)) == g_node_id;
+}
+
+RC TPCCTxnManager::run_txn_co() {
+	switch (((TPCCQuery*) query)->txn_type) {
+		case TPCC_PAYMENT:
+			return run_payment_co();
+		case TPCC_NEW_ORDER:
+			return run_new_order_co();
+		case TPCC_ORDER_STATUS:
+			return run_order_status_co();
+		case TPCC_DELIVERY:
+			return run_delivery_co();
+		case TPCC_STOCK_LEVEL:
+			return run_stock_level_co();
+		default:
+			assert(false);
+	}
+	return RCOK;
+}
+
+// The bodies below take the same steps as run_txn_state(). send_remote_request() still
+// reads state to pick the destination, so state is set before every remote step.
+
+RC TPCCTxnManager::run_payment_co() {
+	TPCCQuery* tpcc_query = (TPCCQuery*) query;
+	uint64_t w_id = tpcc_query->w_id;
+	uint64_t d_id = tpcc_query->d_id;
+	uint64_t c_id = tpcc_query->c_id;
+	uint64_t d_w_id = tpcc_query->d_w_id;
+	uint64_t c_w_id = tpcc_query->c_w_id;
+	uint64_t c_d_id = tpcc_query->c_d_id;
+	char * c_last = tpcc_query->c_last;
+	double h_amount = tpcc_query->h_amount;
+	bool by_last_name = tpcc_query->by_last_name;
+	RC rc = RCOK;
+	TXN_CO_BEGIN
+	// a participant that only owns the customer enters at TPCC_PAYMENT4
+	if (state == TPCC_PAYMENT0) {
+		if (is_local_wh(w_id)) {
+			rc = run_payment_0(w_id, d_id, d_w_id, h_amount, row);
+			TXN_CO_AWAIT(rc);
+			rc = run_payment_1(w_id, d_id, d_w_id, h_amount, row);
+			TXN_CO_AWAIT(rc);
+		} else {
+			rc = send_remote_request();
+			TXN_CO_AWAIT(rc);
+		}
+		rc = run_payment_2(w_id, d_id, d_w_id, h_amount, row);
+		TXN_CO_AWAIT(rc);
+		rc = run_payment_3(w_id, d_id, d_w_id, h_amount, row);
+		TXN_CO_AWAIT(rc);
+	}
+	if (is_local_wh(c_w_id)) {
+		rc = run_payment_4(w_id, d_id, c_id, c_w_id, c_d_id, c_last, h_amount, by_last_name, row);
+		TXN_CO_AWAIT(rc);
+		rc = run_payment_5(w_id, d_id, c_id, c_w_id, c_d_id, c_last, h_amount, by_last_name, row);
+		TXN_CO_AWAIT(rc);
+	} else {
+		state = TPCC_PAYMENT4;
+		rc = send_remote_request();
+		TXN_CO_AWAIT(rc);
+	}
+	state = TPCC_FIN;
+	TXN_CO_END
+	return rc;
+}
+
+RC TPCCTxnManager::run_new_order_co() {
+	TPCCQuery* tpcc_query = (TPCCQuery*) query;
+	uint64_t w_id = tpcc_query->w_id;
+	uint64_t d_id = tpcc_query->d_id;
+	uint64_t c_id = tpcc_query->c_id;
+	bool remote = tpcc_query->remote;
+	uint64_t ol_cnt = tpcc_query->ol_cnt;
+	uint64_t o_entry_d = tpcc_query->o_entry_d;
+	Item_no * ol = NULL;
+	RC rc = RCOK;
+	TXN_CO_BEGIN
+	// a participant that only supplies order lines enters at TPCC_NEWORDER8
+	if (state == TPCC_NEWORDER0) {
+		if (is_local_wh(w_id)) {
+			rc = new_order_0(w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			rc = new_order_1(w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			rc = new_order_2(w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			rc = new_order_3(w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			rc = new_order_4(w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			rc = new_order_5(w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+		} else {
+			rc = send_remote_request();
+			TXN_CO_AWAIT(rc);
+		}
+	}
+	while (next_item_id < tpcc_query->items.size()) {
+		if (state != TPCC_NEWORDER8) {
+			rc = new_order_6(tpcc_query->items[next_item_id]->ol_i_id, row);
+			TXN_CO_AWAIT(rc);
+			rc = new_order_7(tpcc_query->items[next_item_id]->ol_i_id, row);
+			TXN_CO_AWAIT(rc);
+		}
+		state = TPCC_NEWORDER6;
+		if (is_local_wh(tpcc_query->items[next_item_id]->ol_supply_w_id)) {
+			ol = tpcc_query->items[next_item_id];
+			rc = new_order_8(w_id, d_id, remote, ol->ol_i_id, ol->ol_supply_w_id, ol->ol_quantity,
+											 next_item_id, tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			ol = tpcc_query->items[next_item_id];
+			rc = new_order_9(w_id, d_id, remote, ol->ol_i_id, ol->ol_supply_w_id, ol->ol_quantity,
+											 next_item_id, tpcc_query->ol_amount, tpcc_query->o_id, row);
+			TXN_CO_AWAIT(rc);
+			++next_item_id;
+		} else {
+			// ships this and the following order lines of the same node
+			state = TPCC_NEWORDER8;
+			rc = send_remote_request();
+			TXN_CO_AWAIT(rc);
+		}
+	}
+	state = TPCC_FIN;
+	TXN_CO_END
+	return rc;
+}
+
+RC TPCCTxnManager::run_order_status_co() {
+	TPCCQuery* tpcc_query = (TPCCQuery*) query;
+	uint64_t w_id = tpcc_query->w_id;
+	uint64_t d_id = tpcc_query->d_id;
+	RC rc = RCOK;
+	TXN_CO_BEGIN
+	rc = order_status_0(w_id, d_id, tpcc_query->c_id, tpcc_query->c_last, tpcc_query->by_last_name,
+											row);
+	TXN_CO_AWAIT(rc);
+	rc = order_status_1(w_id, d_id, row);
+	TXN_CO_AWAIT(rc);
+	if (scan_item != NULL) {
+		rc = order_status_2(row);
+		TXN_CO_AWAIT(rc);
+		rc = order_status_3(w_id, d_id, row);
+		TXN_CO_AWAIT(rc);
+		// the order lines of the customer's last order
+		while (scan_item != NULL) {
+			rc = order_status_4(row);
+			TXN_CO_AWAIT(rc);
+			rc = order_status_5(row);
+			TXN_CO_AWAIT(rc);
+		}
+	}
+	state = TPCC_FIN;
+	TXN_CO_END
+	return rc;
+}
+
+RC TPCCTxnManager::run_delivery_co() {
+	TPCCQuery* tpcc_query = (TPCCQuery*) query;
+	uint64_t w_id = tpcc_query->w_id;
+	RC rc = RCOK;
+	TXN_CO_BEGIN
+	// next_item_id is the district
+	while (next_item_id < g_dist_per_wh) {
+		rc = delivery_0(w_id, next_item_id + 1, row);
+		TXN_CO_AWAIT(rc);
+		rc = delivery_1(w_id, next_item_id + 1, row);
+		TXN_CO_AWAIT(rc);
+		if (scan_item != NULL) {
+			rc = delivery_2(row);
+			TXN_CO_AWAIT(rc);
+			rc = delivery_3(w_id, next_item_id + 1, row);
+			TXN_CO_AWAIT(rc);
+		}
+		if (scan_item != NULL) {
+			rc = delivery_4(row);
+			TXN_CO_AWAIT(rc);
+			rc = delivery_5(w_id, next_item_id + 1, tpcc_query->o_carrier_id, row);
+			TXN_CO_AWAIT(rc);
+			while (scan_item != NULL) {
+				rc = delivery_6(row);
+				TXN_CO_AWAIT(rc);
+				rc = delivery_7(tpcc_query->ol_delivery_d, row);
+				TXN_CO_AWAIT(rc);
+			}
+			rc = delivery_8(w_id, next_item_id + 1, row);
+			TXN_CO_AWAIT(rc);
+			rc = delivery_9(row);
+			TXN_CO_AWAIT(rc);
+		}
+		++next_item_id;
+	}
+	state = TPCC_FIN;
+	TXN_CO_END
+	return rc;
+}
+
+RC TPCCTxnManager::run_stock_level_co() {
+	TPCCQuery* tpcc_query = (TPCCQuery*) query;
+	uint64_t w_id = tpcc_query->w_id;
+	uint64_t d_id = tpcc_query->d_id;
+	RC rc = RCOK;
+	TXN_CO_BEGIN
+	rc = stock_level_0(w_id, d_id, row);
+	TXN_CO_AWAIT(rc);
+	rc = stock_level_1(w_id, d_id, row);
+	TXN_CO_AWAIT(rc);
+	// the order lines of the last 20 orders
+	while (scan_item != NULL) {
+		rc = stock_level_2(row);
+		TXN_CO_AWAIT(rc);
+		rc = stock_level_3(w_id, d_id, row);
+		TXN_CO_AWAIT(rc);
+		rc = stock_level_4(w_id, row);
+		TXN_CO_AWAIT(rc);
+		rc = stock_level_5(tpcc_query->threshold, row);
+		TXN_CO_AWAIT(rc);
+	}
+	state = TPCC_FIN;
+	TXN_CO_END
+	return rc;
+}
+
 inline RC TPCCTxnManager::run_payment_0(uint64_t w_id, uint64_t d_id, uint64_t d_w_id,
 																				double h_amount, row_t *&r_wh_local) {
 
@@ -629,24 +1004,9 @@ inline RC TPCCTxnManager::run_payment_4(uint64_t w_id, uint64_t d_id, uint64_t c
 			EXEC SQL OPEN c_byname;
 		+===========================================================================*/
 
-		key = custNPKey(c_last, c_d_id, c_w_id);
-		// XXX: the list is not sorted. But let's assume it's sorted...
-		// The performance won't be much different.
-		INDEX * index = _wl->i_customer_last;
 		INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
-		item = index_read(index, key, wh_to_part(c_w_id));
+		r_cust = get_cust_by_last_name(c_last, c_d_id, c_w_id);
 		starttime = get_sys_clock();
-		assert(item != NULL);
-
-		int cnt = 0;
-		itemid_t * it = item;
-		itemid_t * mid = item;
-		while (it != NULL) {
-			cnt ++;
-			it = it->next;
-			if (cnt % 2 == 0) mid = mid->next;
-		}
-		r_cust = ((row_t *)mid->location);
 
 		/*============================================================================+
 			for (n=0; n<namecnt/2; n++) {
@@ -830,9 +1190,10 @@ inline RC TPCCTxnManager::new_order_5(uint64_t w_id, uint64_t d_id, uint64_t c_i
 	//double d_tax;
 	//int64_t o_id;
 	//d_tax = *(double *) r_dist_local->get_value(D_TAX);
+	// the new order takes d_next_o_id, as the loaded orders 1..3000 leave it at 3001
 	*o_id = *(int64_t *) r_dist_local->get_value(D_NEXT_O_ID);
-	(*o_id) ++;
-	r_dist_local->set_value(D_NEXT_O_ID, *o_id);
+	int64_t d_next_o_id = *o_id + 1;
+	r_dist_local->set_value(D_NEXT_O_ID, d_next_o_id);
 
 	// return o_id
 	/*========================================================================================+
@@ -842,6 +1203,8 @@ inline RC TPCCTxnManager::new_order_5(uint64_t w_id, uint64_t d_id, uint64_t c_i
 	row_t * r_order;
 	uint64_t row_id;
 	_wl->t_order->get_new_row(r_order, wh_to_part(w_id), row_id);
+	// keyed like the loaded rows, so log records of the row can be replayed
+	r_order->set_primary_key(*o_id);
 	r_order->set_value(O_ID, *o_id);
 	r_order->set_value(O_C_ID, c_id);
 	r_order->set_value(O_D_ID, d_id);
@@ -857,6 +1220,7 @@ inline RC TPCCTxnManager::new_order_5(uint64_t w_id, uint64_t d_id, uint64_t c_i
 		+=======================================================*/
 	row_t * r_no;
 	_wl->t_neworder->get_new_row(r_no, wh_to_part(w_id), row_id);
+	r_no->set_primary_key(*o_id);
 	r_no->set_value(NO_O_ID, *o_id);
 	r_no->set_value(NO_D_ID, d_id);
 	r_no->set_value(NO_W_ID, w_id);
@@ -985,6 +1349,7 @@ inline RC TPCCTxnManager::new_order_9(uint64_t w_id, uint64_t d_id, bool remote,
 	row_t * r_ol;
 	uint64_t row_id;
 	_wl->t_orderline->get_new_row(r_ol, wh_to_part(ol_supply_w_id), row_id);
+	r_ol->set_primary_key(o_id);
 	r_ol->set_value(OL_O_ID, &o_id);
 	r_ol->set_value(OL_D_ID, &d_id);
 	r_ol->set_value(OL_W_ID, &w_id);
@@ -993,7 +1358,8 @@ inline RC TPCCTxnManager::new_order_9(uint64_t w_id, uint64_t d_id, bool remote,
 #if !TPCC_SMALL
 	r_ol->set_value(OL_SUPPLY_W_ID, &ol_supply_w_id);
 	r_ol->set_value(OL_QUANTITY, &ol_quantity);
-	r_ol->set_value(OL_AMOUNT, &ol_amount);
+	double amount = ol_amount; // OL_AMOUNT is a double
+	r_ol->set_value(OL_AMOUNT, amount);
 #endif
 	insert_row(r_ol, _wl->t_orderline);
 	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
@@ -1001,6 +1367,376 @@ inline RC TPCCTxnManager::new_order_9(uint64_t w_id, uint64_t d_id, bool remote,
 }
 
 
+// Customers of a district with the given last name, in the order of c_first as the spec asks;
+// the loader leaves C_FIRST empty, so c_id orders them instead. Returns the one at position
+// ceil(n/2). custNPKey is a hash of the name, so the index chain is filtered on C_LAST.
+row_t * TPCCTxnManager::get_cust_by_last_name(char * c_last, uint64_t c_d_id, uint64_t c_w_id) {
+	uint64_t key = custNPKey(c_last, c_d_id, c_w_id);
+	itemid_t * item = index_read(_wl->i_customer_last, key, wh_to_part(c_w_id));
+	assert(item != NULL);
+	std::vector<std::pair<int64_t, row_t *> > custs;
+	for (itemid_t * it = item; it != NULL; it = it->next) {
+		row_t * r_cust = (row_t *) it->location;
+		if (strncmp(r_cust->get_value(C_LAST), c_last, LASTNAME_LEN) != 0) continue;
+		int64_t c_id;
+		r_cust->get_value(C_ID, c_id);
+		custs.push_back(std::make_pair(c_id, r_cust));
+	}
+	assert(!custs.empty());
+	std::sort(custs.begin(), custs.end());
+	return custs[(custs.size() - 1) / 2].second;
+}
+
+// Moves scan_item to the first order line of the next order in [scan_o_id, scan_end) once the
+// lines of the current order are exhausted.
+void TPCCTxnManager::next_scan_order(uint64_t w_id, uint64_t d_id) {
+	while (scan_item == NULL && scan_o_id < scan_end)
+		scan_item = index_probe(_wl->i_orderline, orderKey(scan_o_id++, d_id, w_id), wh_to_part(w_id));
+}
+
+inline RC TPCCTxnManager::order_status_0(uint64_t w_id, uint64_t d_id, uint64_t c_id,
+																				 char *c_last, bool by_last_name,
+																				 row_t *&r_cust_local) {
+	/*=====================================================+
+		EXEC SQL SELECT c_balance, c_first, c_middle, c_last
+		INTO :c_balance, :c_first, :c_middle, :c_last
+		FROM customer
+		WHERE c_id=:c_id AND c_d_id=:d_id AND c_w_id=:w_id;
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	row_t * r_cust;
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	if (by_last_name) {
+		r_cust = get_cust_by_last_name(c_last, d_id, w_id);
+	} else {
+		itemid_t * item = index_read(_wl->i_customer_id, custKey(c_id, d_id, w_id), wh_to_part(w_id));
+		assert(item != NULL);
+		r_cust = (row_t *) item->location;
+	}
+	RC rc = get_row(r_cust, RD, r_cust_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::order_status_1(uint64_t w_id, uint64_t d_id, row_t *r_cust_local) {
+	/*=====================================================+
+		EXEC SQL SELECT o_id, o_carrier_id, o_entry_d
+		INTO :o_id, :o_carrier_id, :o_entry_d
+		FROM orders
+		WHERE o_w_id=:w_id AND o_d_id=:d_id AND o_c_id=:c_id
+		ORDER BY o_id DESC;
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	assert(r_cust_local != NULL);
+	double c_balance;
+	int64_t c_id;
+	r_cust_local->get_value(C_BALANCE, c_balance);
+	r_cust_local->get_value(C_ID, c_id);
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	itemid_t * item = index_probe(_wl->i_order_wdc, custKey(c_id, d_id, w_id), wh_to_part(w_id));
+	starttime = get_sys_clock();
+	// the most recent order of the customer; O_ID is never updated, so it is read in place
+	scan_item = NULL;
+	int64_t max_o_id = -1;
+	for (; item != NULL; item = item->next) {
+		int64_t o_id;
+		((row_t *)item->location)->get_value(O_ID, o_id);
+		if (o_id > max_o_id) {
+			max_o_id = o_id;
+			scan_item = item;
+		}
+	}
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::order_status_2(row_t *&r_order_local) {
+	assert(scan_item != NULL);
+	RC rc = get_row((row_t *)scan_item->location, RD, r_order_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::order_status_3(uint64_t w_id, uint64_t d_id, row_t *r_order_local) {
+	/*=====================================================+
+		EXEC SQL DECLARE c_line CURSOR FOR
+		SELECT ol_i_id, ol_supply_w_id, ol_quantity, ol_amount, ol_delivery_d
+		FROM order_line
+		WHERE ol_o_id=:o_id AND ol_d_id=:d_id AND ol_w_id=:w_id;
+		EXEC SQL OPEN c_line;
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	assert(r_order_local != NULL);
+	int64_t o_id;
+	int64_t o_carrier_id;
+	int64_t o_entry_d;
+	r_order_local->get_value(O_ID, o_id);
+	r_order_local->get_value(O_CARRIER_ID, o_carrier_id);
+	r_order_local->get_value(O_ENTRY_D, o_entry_d);
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	scan_item = index_probe(_wl->i_orderline, orderKey(o_id, d_id, w_id), wh_to_part(w_id));
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::order_status_4(row_t *&r_ol_local) {
+	assert(scan_item != NULL);
+	RC rc = get_row((row_t *)scan_item->location, RD, r_ol_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::order_status_5(row_t *r_ol_local) {
+	/*=====================================================+
+		EXEC SQL FETCH c_line
+		INTO :ol_i_id[i], :ol_supply_w_id[i], :ol_quantity[i],
+			:ol_amount[i], :ol_delivery_d[i];
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	assert(r_ol_local != NULL);
+	int64_t ol_i_id;
+	r_ol_local->get_value(OL_I_ID, ol_i_id);
+#if !TPCC_SMALL
+	int64_t ol_supply_w_id;
+	int64_t ol_quantity;
+	double ol_amount;
+	int64_t ol_delivery_d;
+	r_ol_local->get_value(OL_SUPPLY_W_ID, ol_supply_w_id);
+	r_ol_local->get_value(OL_QUANTITY, ol_quantity);
+	r_ol_local->get_value(OL_AMOUNT, ol_amount);
+	r_ol_local->get_value(OL_DELIVERY_D, ol_delivery_d);
+#endif
+	scan_item = scan_item->next;
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	return RCOK;
+}
+
+// Delivery visits the districts in turn (next_item_id) and delivers the oldest order of each.
+inline RC TPCCTxnManager::delivery_0(uint64_t w_id, uint64_t d_id, row_t *&r_dist_local) {
+	// D_NEXT_O_ID bounds the scan of NEW-ORDER below
+	itemid_t * item = index_read(_wl->i_district, distKey(d_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	RC rc = get_row((row_t *)item->location, RD, r_dist_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::delivery_1(uint64_t w_id, uint64_t d_id, row_t *r_dist_local) {
+	/*=====================================================+
+		EXEC SQL DECLARE c_no CURSOR FOR
+		SELECT no_o_id
+		FROM new_order
+		WHERE no_d_id = :d_id AND no_w_id = :w_id
+		ORDER BY no_o_id ASC;
+		EXEC SQL OPEN c_no;
+		EXEC SQL FETCH c_no INTO :no_o_id;
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	assert(r_dist_local != NULL);
+	int64_t d_next_o_id;
+	r_dist_local->get_value(D_NEXT_O_ID, d_next_o_id);
+	// the cursor only moves past orders whose delivery committed (commit_indexes)
+	scan_item = NULL;
+	for (int64_t o_id = _wl->delivery_cursor[distKey(d_id, w_id)];
+			 scan_item == NULL && o_id < d_next_o_id; o_id++)
+		scan_item = index_probe(_wl->i_neworder, orderKey(o_id, d_id, w_id), wh_to_part(w_id));
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::delivery_2(row_t *&r_no_local) {
+	assert(scan_item != NULL);
+	RC rc = get_row((row_t *)scan_item->location, WR, r_no_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::delivery_3(uint64_t w_id, uint64_t d_id, row_t *r_no_local) {
+	/*=====================================================+
+		EXEC SQL DELETE FROM new_order WHERE CURRENT OF c_no;
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	assert(r_no_local != NULL);
+	int64_t no_o_id;
+	r_no_local->get_value(NO_O_ID, no_o_id);
+	if (no_o_id == 0) {
+		// delivered by a transaction that committed after this one found the row
+		scan_item = NULL;
+		INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+		return RCOK;
+	}
+	// the row leaves i_neworder at commit (commit_indexes); until then NO_O_ID = 0 marks it
+	int64_t delivered = 0;
+	r_no_local->set_value(NO_O_ID, delivered);
+	deliver_d_id[deliver_cnt] = d_id;
+	deliver_o_id[deliver_cnt] = no_o_id;
+	deliver_row[deliver_cnt] = (row_t *) scan_item->location;
+	delete_row(deliver_row[deliver_cnt]);
+	deliver_cnt++;
+	/*=====================================================+
+		EXEC SQL SELECT o_c_id INTO :c_id FROM orders
+		WHERE o_id = :no_o_id AND o_d_id = :d_id AND o_w_id = :w_id;
+		EXEC SQL UPDATE orders SET o_carrier_id = :o_carrier_id
+		WHERE o_id = :no_o_id AND o_d_id = :d_id AND o_w_id = :w_id;
+	+=====================================================*/
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	scan_item = index_probe(_wl->i_order, orderKey(no_o_id, d_id, w_id), wh_to_part(w_id));
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::delivery_4(row_t *&r_order_local) {
+	assert(scan_item != NULL);
+	RC rc = get_row((row_t *)scan_item->location, WR, r_order_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::delivery_5(uint64_t w_id, uint64_t d_id, uint64_t o_carrier_id,
+																		 row_t *r_order_local) {
+	uint64_t starttime = get_sys_clock();
+	assert(r_order_local != NULL);
+	int64_t o_id;
+	int64_t o_c_id;
+	r_order_local->get_value(O_ID, o_id);
+	r_order_local->get_value(O_C_ID, o_c_id);
+	r_order_local->set_value(O_CARRIER_ID, o_carrier_id);
+	deliver_c_id = o_c_id;
+	deliver_amount = 0;
+	/*=====================================================+
+		EXEC SQL UPDATE order_line SET ol_delivery_d = :datetime
+		WHERE ol_o_id = :no_o_id AND ol_d_id = :d_id AND ol_w_id = :w_id;
+		EXEC SQL SELECT SUM(ol_amount) INTO :ol_total FROM order_line
+		WHERE ol_o_id = :no_o_id AND ol_d_id = :d_id AND ol_w_id = :w_id;
+	+=====================================================*/
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	scan_item = index_probe(_wl->i_orderline, orderKey(o_id, d_id, w_id), wh_to_part(w_id));
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::delivery_6(row_t *&r_ol_local) {
+	assert(scan_item != NULL);
+	RC rc = get_row((row_t *)scan_item->location, WR, r_ol_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::delivery_7(uint64_t ol_delivery_d, row_t *r_ol_local) {
+	uint64_t starttime = get_sys_clock();
+	assert(r_ol_local != NULL);
+#if !TPCC_SMALL
+	double ol_amount;
+	r_ol_local->get_value(OL_AMOUNT, ol_amount);
+	deliver_amount += ol_amount;
+	r_ol_local->set_value(OL_DELIVERY_D, ol_delivery_d);
+#endif
+	scan_item = scan_item->next;
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::delivery_8(uint64_t w_id, uint64_t d_id, row_t *&r_cust_local) {
+	/*=====================================================+
+		EXEC SQL UPDATE customer SET c_balance = c_balance + :ol_total,
+			c_delivery_cnt = c_delivery_cnt + 1
+		WHERE c_id = :c_id AND c_d_id = :d_id AND c_w_id = :w_id;
+	+=====================================================*/
+	itemid_t * item =
+			index_read(_wl->i_customer_id, custKey(deliver_c_id, d_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	RC rc = get_row((row_t *)item->location, WR, r_cust_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::delivery_9(row_t *r_cust_local) {
+	uint64_t starttime = get_sys_clock();
+	assert(r_cust_local != NULL);
+	double c_balance;
+	r_cust_local->get_value(C_BALANCE, c_balance);
+	r_cust_local->set_value(C_BALANCE, c_balance + deliver_amount);
+#if !TPCC_SMALL
+	uint64_t c_delivery_cnt;
+	r_cust_local->get_value(C_DELIVERY_CNT, c_delivery_cnt);
+	r_cust_local->set_value(C_DELIVERY_CNT, c_delivery_cnt + 1);
+#endif
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::stock_level_0(uint64_t w_id, uint64_t d_id, row_t *&r_dist_local) {
+	/*=====================================================+
+		EXEC SQL SELECT d_next_o_id INTO :o_id
+		FROM district
+		WHERE d_w_id=:w_id AND d_id=:d_id;
+	+=====================================================*/
+	itemid_t * item = index_read(_wl->i_district, distKey(d_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	RC rc = get_row((row_t *)item->location, RD, r_dist_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::stock_level_1(uint64_t w_id, uint64_t d_id, row_t *r_dist_local) {
+	/*=====================================================+
+		EXEC SQL SELECT COUNT(DISTINCT (s_i_id)) INTO :stock_count
+		FROM order_line, stock
+		WHERE ol_w_id=:w_id AND ol_d_id=:d_id AND ol_o_id<:o_id AND ol_o_id>=:o_id-20
+			AND s_w_id=:w_id AND s_i_id=ol_i_id AND s_quantity < :threshold;
+	+=====================================================*/
+	uint64_t starttime = get_sys_clock();
+	assert(r_dist_local != NULL);
+	int64_t d_next_o_id;
+	r_dist_local->get_value(D_NEXT_O_ID, d_next_o_id);
+	scan_end = d_next_o_id;
+	scan_o_id = d_next_o_id > 21 ? d_next_o_id - 20 : 1;
+	scan_item = NULL;
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	next_scan_order(w_id, d_id);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::stock_level_2(row_t *&r_ol_local) {
+	assert(scan_item != NULL);
+	RC rc = get_row((row_t *)scan_item->location, RD, r_ol_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::stock_level_3(uint64_t w_id, uint64_t d_id, row_t *r_ol_local) {
+	uint64_t starttime = get_sys_clock();
+	assert(r_ol_local != NULL);
+	int64_t ol_i_id;
+	r_ol_local->get_value(OL_I_ID, ol_i_id);
+	sl_i_id = ol_i_id;
+	scan_item = scan_item->next;
+	INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - starttime);
+	next_scan_order(w_id, d_id);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::stock_level_4(uint64_t w_id, row_t *&r_stock_local) {
+	// items are counted once (DISTINCT)
+	if (!sl_items.insert(sl_i_id).second) {
+		r_stock_local = NULL;
+		return RCOK;
+	}
+	itemid_t * item = index_read(_wl->i_stock, stockKey(sl_i_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	RC rc = get_row((row_t *)item->location, RD, r_stock_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::stock_level_5(uint64_t threshold, row_t *r_stock_local) {
+	if (r_stock_local == NULL) return RCOK;
+	int64_t s_quantity;
+	r_stock_local->get_value(S_QUANTITY, s_quantity);
+	if (s_quantity < (int64_t)threshold) sl_low_stock++;
+	return RCOK;
+}
+
+// NewOrder's rows reach the order indexes at commit, so no transaction finds the rows of one
+// that may still abort; Delivery's NEW-ORDER deletes are applied the same way.
+void TPCCTxnManager::commit_indexes() {
+	for (uint64_t i = 0; i < txn->insert_rows.size(); i++) _wl->index_new_row(txn->insert_rows[i]);
+	uint64_t w_id = ((TPCCQuery *) query)->w_id;
+	for (uint64_t i = 0; i < deliver_cnt; i++) {
+		_wl->i_neworder->index_remove(orderKey(deliver_o_id[i], deliver_d_id[i], w_id),
+																	deliver_row[i], wh_to_part(w_id));
+		uint64_t volatile * cursor = &_wl->delivery_cursor[distKey(deliver_d_id[i], w_id)];
+		uint64_t cur = *cursor;
+		while (cur <= deliver_o_id[i] && !ATOM_CAS(*cursor, cur, deliver_o_id[i] + 1)) cur = *cursor;
+	}
+}
+
 RC TPCCTxnManager::run_calvin_txn() {
 	RC rc = RCOK;
 	uint64_t starttime = get_sys_clock();
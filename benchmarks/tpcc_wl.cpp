@@ -18,8 +18,10 @@
 #include "helper.h"
 #include "tpcc.h"
 #include "wl.h"
+#include "checkpoint.h"
 #include "thread.h"
 #include "table.h"
+#include "catalog.h"
 #include "index_hash.h"
 #include "index_btree.h"
 #include "tpcc_helper.h"
@@ -50,6 +52,10 @@ RC TPCCWorkload::init() {
 	delivering = new bool * [g_num_wh + 1];
 	for (UInt32 wid = 1; wid <= g_num_wh; wid ++)
 		delivering[wid] = (bool *) mem_allocator.alloc(CL_SIZE);
+	// the loader leaves orders 2101..3000 of each district undelivered
+	uint64_t dist_cnt = (g_num_wh + 1) * g_dist_per_wh + 1;
+	delivery_cursor = new uint64_t[dist_cnt];
+	for (uint64_t i = 0; i < dist_cnt; i++) delivery_cursor[i] = 2101;
 
   printf("Initializing schema... ");
   fflush(stdout);
@@ -57,7 +63,13 @@ RC TPCCWorkload::init() {
   printf("Done\n");
   printf("Initializing table... ");
   fflush(stdout);
-	init_table();
+#if CKPT_LOAD
+	if (checkpointer.load(this) != RCOK)
+#endif
+	if (load_snapshot() != RCOK) {
+		init_table();
+		dump_snapshot();
+	}
   printf("Done\n");
   fflush(stdout);
 	return RCOK;
@@ -81,8 +93,10 @@ RC TPCCWorkload::init_schema(const char * schema_file) {
 	i_customer_id = indexes["CUSTOMER_ID_IDX"];
 	i_customer_last = indexes["CUSTOMER_LAST_IDX"];
 	i_stock = indexes["STOCK_IDX"];
-//	i_order = indexes["ORDER_IDX"];
-//	i_orderline = indexes["ORDER-LINE_IDX"];
+	i_order = indexes["ORDER_IDX"];
+	i_order_wdc = indexes["ORDER_CUST_IDX"];
+	i_orderline = indexes["ORDER-LINE_IDX"];
+	i_neworder = indexes["NEW-ORDER_IDX"];
 	return RCOK;
 }
 
@@ -101,108 +115,32 @@ RC TPCCWorkload::init_table() {
 //		- new order
 //		- order line
 /**********************************/
-
-	pthread_t * p_thds = new pthread_t[g_init_parallelism - 1];
-  thr_args * tt = new thr_args[g_init_parallelism];
-	for (UInt32 i = 0; i < g_init_parallelism ; i++) {
-	tt[i].wl = this;
-	tt[i].id = i;
-  }
-  // Stock table
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-	pthread_create(&p_thds[i], NULL, threadInitStock, &tt[i]);
+	// Every loader thread takes a slice of the replicated item table, then
+	// (warehouse, district) slices in turn until all are loaded.
+	uint64_t starttime = get_server_clock();
+	load_next_slice = 0;
+	UInt32 thd_cnt = get_load_thread_cnt();
+	pthread_t * p_thds = new pthread_t[thd_cnt - 1];
+	thr_args * tt = new thr_args[thd_cnt];
+	for (UInt32 i = 0; i < thd_cnt; i++) {
+		tt[i].wl = this;
+		tt[i].id = i;
+		tt[i].tot = thd_cnt;
 	}
-  threadInitStock(&tt[g_init_parallelism-1]);
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-		int rc = pthread_join(p_thds[i], NULL);
-		if (rc) {
-			printf("ERROR; return code from pthread_join() is %d\n", rc);
-			exit(-1);
-		}
-  }
-  printf("STOCK Done\n");
-  fflush(stdout);
-  // Item Table
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-	pthread_create(&p_thds[i], NULL, threadInitItem, &tt[i]);
-	}
-  threadInitItem(&tt[g_init_parallelism-1]);
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-		int rc = pthread_join(p_thds[i], NULL);
-		if (rc) {
-			printf("ERROR; return code from pthread_join() is %d\n", rc);
-			exit(-1);
-		}
-  }
-  printf("ITEM Done\n");
-  fflush(stdout);
-  // Customer Table
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-	pthread_create(&p_thds[i], NULL, threadInitCust, &tt[i]);
+	for (UInt32 i = 0; i < thd_cnt - 1; i++) {
+		pthread_create(&p_thds[i], NULL, threadLoad, &tt[i]);
 	}
-  threadInitCust(&tt[g_init_parallelism-1]);
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
+	threadLoad(&tt[thd_cnt - 1]);
+	for (UInt32 i = 0; i < thd_cnt - 1; i++) {
 		int rc = pthread_join(p_thds[i], NULL);
 		if (rc) {
 			printf("ERROR; return code from pthread_join() is %d\n", rc);
 			exit(-1);
 		}
-  }
-  printf("CUSTOMER Done\n");
-  fflush(stdout);
-
-  // Order Table
-  /*
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-	pthread_create(&p_thds[i], NULL, threadInitOrder, &tt[i]);
 	}
-  threadInitOrder(&tt[g_init_parallelism-1]);
-	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
-		int rc = pthread_join(p_thds[i], NULL);
-		if (rc) {
-			printf("ERROR; return code from pthread_join() is %d\n", rc);
-			exit(-1);
-		}
-  }
-  printf("ORDER Done\n");
-  fflush(stdout);
-  */
-	threadInitWh(this);
-  printf("WAREHOUSE Done\n");
-  fflush(stdout);
-	threadInitDist(this);
-  printf("DISTRICT Done\n");
-  fflush(stdout);
-  threadInitHist(this);
-  printf("HISTORY Done\n");
-  fflush(stdout);
-
-  /*
-  UInt32 cust_thr_cnt = g_dist_per_wh/2;
-  thr_args * tt = new thr_args[cust_thr_cnt];
-	pthread_t * p_thds = new pthread_t[2+cust_thr_cnt];
-	pthread_create(&p_thds[0], NULL, threadInitStock, this);
-	pthread_create(&p_thds[1], NULL, threadInitHist, this);
-  for(UInt32 i=0;i<cust_thr_cnt;i++) {
-	tt[i].wl = this;
-	tt[i].id = i;
-	tt[i].tot = cust_thr_cnt;
-	  pthread_create(&p_thds[2+i], NULL, threadInitCust, &tt[i]);
-  }
-	threadInitOrder(this);
-	threadInitItem(this);
-	threadInitWh(this);
-	threadInitDist(this);
-
-	for (uint32_t i = 0; i < 2 + cust_thr_cnt; i++) {
-		int rc = pthread_join(p_thds[i], NULL);
-		printf("thread %d complete\n", i);
-		if (rc) {
-			printf("ERROR; return code from pthread_join() is %d\n", rc);
-			exit(-1);
-		}
-	}
-  */
+	delete[] p_thds;
+	delete[] tt;
+	print_load_stats(starttime);
 	printf("\nData Initialization Complete!\n\n");
 	return RCOK;
 }
@@ -215,9 +153,125 @@ RC TPCCWorkload::get_txn_man(TxnManager *& txn_manager) {
 	return RCOK;
 }
 
-void TPCCWorkload::init_tab_item(int id) {
+string TPCCWorkload::snapshot_key() {
+	return Workload::snapshot_key() + "_wh" + to_string(g_num_wh) + "_" + to_string(g_dist_per_wh) +
+				 "_" + to_string(g_cust_per_dist) + "_" + to_string(g_max_items) + "_s" +
+				 to_string(TPCC_SMALL);
+}
+
+// TPCC indexes are keyed by composite keys; rebuild them from the redo image.
+row_t * TPCCWorkload::get_recovery_row(table_t * table, uint64_t key, uint64_t part_id,
+																			 const char * image) {
+	Catalog * schema = table->get_schema();
+	INDEX * index;
+	uint64_t wid;
+	if (table == t_warehouse) {
+		index = i_warehouse;
+		wid = key;
+	} else if (table == t_district) {
+		index = i_district;
+		wid = *(uint64_t *)&image[schema->get_field_index(D_W_ID)];
+		key = distKey(key, wid);
+	} else if (table == t_customer) {
+		index = i_customer_id;
+		wid = *(uint64_t *)&image[schema->get_field_index(C_W_ID)];
+		uint64_t did = *(uint64_t *)&image[schema->get_field_index(C_D_ID)];
+		key = custKey(key, did, wid);
+	} else if (table == t_stock) {
+		index = i_stock;
+		wid = *(uint64_t *)&image[schema->get_field_index(S_W_ID)];
+		key = stockKey(key, wid);
+	} else if (table == t_order || table == t_neworder) {
+		// the primary key is o_id; replayed deliveries leave NO_O_ID = 0
+		uint64_t did;
+		if (table == t_order) {
+			index = i_order;
+			wid = *(uint64_t *)&image[schema->get_field_index(O_W_ID)];
+			did = *(uint64_t *)&image[schema->get_field_index(O_D_ID)];
+		} else {
+			index = i_neworder;
+			wid = *(uint64_t *)&image[schema->get_field_index(NO_W_ID)];
+			did = *(uint64_t *)&image[schema->get_field_index(NO_D_ID)];
+		}
+		key = orderKey(key, did, wid);
+	} else if (table == t_orderline) {
+		// the lines of an order share its key
+		wid = *(uint64_t *)&image[schema->get_field_index(OL_W_ID)];
+		uint64_t did = *(uint64_t *)&image[schema->get_field_index(OL_D_ID)];
+		uint64_t ol_number = *(uint64_t *)&image[schema->get_field_index(OL_NUMBER)];
+		itemid_t * item = NULL;
+		i_orderline->index_probe(orderKey(key, did, wid), item, wh_to_part(wid));
+		for (; item != NULL; item = item->next) {
+			int64_t number;
+			((row_t *)item->location)->get_value(OL_NUMBER, number);
+			if ((uint64_t)number == ol_number) return (row_t *)item->location;
+		}
+		return NULL;
+	} else {
+		// item is read-only and history has no index
+		return NULL;
+	}
+	itemid_t * item = NULL;
+	RC rc = index->index_read(key, item, wh_to_part(wid), 0);
+	if (rc != RCOK || item == NULL) return NULL;
+	return (row_t *)item->location;
+}
+
+void TPCCWorkload::index_new_row(row_t * r) {
+	int64_t o_id, d_id, w_id;
+	if (r->get_table() == t_order) {
+		int64_t c_id;
+		r->get_value(O_ID, o_id);
+		r->get_value(O_C_ID, c_id);
+		r->get_value(O_D_ID, d_id);
+		r->get_value(O_W_ID, w_id);
+		index_insert(i_order, orderKey(o_id, d_id, w_id), r, wh_to_part(w_id));
+		index_insert(i_order_wdc, custKey(c_id, d_id, w_id), r, wh_to_part(w_id));
+	} else if (r->get_table() == t_neworder) {
+		r->get_value(NO_O_ID, o_id);
+		r->get_value(NO_D_ID, d_id);
+		r->get_value(NO_W_ID, w_id);
+		index_insert(i_neworder, orderKey(o_id, d_id, w_id), r, wh_to_part(w_id));
+	} else if (r->get_table() == t_orderline) {
+		r->get_value(OL_O_ID, o_id);
+		r->get_value(OL_D_ID, d_id);
+		r->get_value(OL_W_ID, w_id);
+		index_insert(i_orderline, orderKey(o_id, d_id, w_id), r, wh_to_part(w_id));
+	}
+}
+
+RC TPCCWorkload::recovery_insert(table_t * table, uint64_t key, uint64_t part_id,
+																 const char * image) {
+	// the fuzzy checkpoint replayed over may already hold the row
+	row_t * row = get_recovery_row(table, key, part_id, image);
+	if (row != NULL) {
+		memcpy(row->get_data(), image, row->get_tuple_size());
+		return RCOK;
+	}
+	uint64_t row_id;
+	table->get_new_row(row, part_id, row_id);
+	memcpy(row->get_data(), image, row->get_tuple_size());
+	row->set_primary_key(key);
+	index_new_row(row);
+	return RCOK;
+}
+
+// only Delivery deletes, the NEW-ORDER rows it delivers
+RC TPCCWorkload::recovery_delete(table_t * table, uint64_t key, uint64_t part_id,
+																 const char * image) {
+	if (table != t_neworder) return ERROR;
+	row_t * row = get_recovery_row(table, key, part_id, image);
+	if (row == NULL) return ERROR;
+	Catalog * schema = table->get_schema();
+	uint64_t wid = *(uint64_t *)&image[schema->get_field_index(NO_W_ID)];
+	uint64_t did = *(uint64_t *)&image[schema->get_field_index(NO_D_ID)];
+	i_neworder->index_remove(orderKey(key, did, wid), row, wh_to_part(wid));
+	return RCOK;
+}
+
+void TPCCWorkload::init_tab_item(int id, int tot) {
   if (WL_VERB) printf("[init] loading item table\n");
-	for (UInt32 i = id+1; i <= g_max_items; i+=g_init_parallelism) {
+	for (UInt32 i = id+1; i <= g_max_items; i+=tot) {
 		row_t * row;
 		uint64_t row_id;
 		t_item->get_new_row(row, 0, row_id);
@@ -233,88 +287,82 @@ void TPCCWorkload::init_tab_item(int id) {
 	if (RAND(10) == 0) strcpy(data, "original");
 		row->set_value(I_DATA, data);
 
-		index_insert(i_item, i, row, 0);
+		index_load(i_item, i, row, 0);
 	}
 }
 
-void TPCCWorkload::init_tab_wh() {
+void TPCCWorkload::init_tab_wh(uint64_t wid) {
   if (WL_VERB) printf("[init] workload table.\n");
-	for (UInt32 wid = 1; wid <= g_num_wh; wid ++) {
-	//if(GET_NODE_ID(wh_to_part(wid)) != g_node_id) continue;
-		row_t * row;
-		uint64_t row_id;
-		t_warehouse->get_new_row(row, 0, row_id);
-		row->set_primary_key(wid);
-
-		row->set_value(W_ID, wid);
-		char name[10];
-		MakeAlphaString(6, 10, name);
-		row->set_value(W_NAME, name);
-		char street[20];
-		MakeAlphaString(10, 20, street);
-		row->set_value(W_STREET_1, street);
-		MakeAlphaString(10, 20, street);
-		row->set_value(W_STREET_2, street);
-		MakeAlphaString(10, 20, street);
-		row->set_value(W_CITY, street);
-		char state[2];
-		MakeAlphaString(2, 2, state); /* State */
-		row->set_value(W_STATE, state);
-		char zip[9];
-		MakeNumberString(9, 9, zip); /* Zip */
-		row->set_value(W_ZIP, zip);
-		double tax = (double)URand(0L,200L)/1000.0;
-		double w_ytd=300000.00;
-		row->set_value(W_TAX, tax);
-		row->set_value(W_YTD, w_ytd);
-
-		index_insert(i_warehouse, wid, row, wh_to_part(wid));
-	}
-
-	return;
+	row_t * row;
+	uint64_t row_id;
+	t_warehouse->get_new_row(row, wh_to_part(wid), row_id);
+	row->set_primary_key(wid);
+
+	row->set_value(W_ID, wid);
+	char name[10];
+	MakeAlphaString(6, 10, name);
+	row->set_value(W_NAME, name);
+	char street[20];
+	MakeAlphaString(10, 20, street);
+	row->set_value(W_STREET_1, street);
+	MakeAlphaString(10, 20, street);
+	row->set_value(W_STREET_2, street);
+	MakeAlphaString(10, 20, street);
+	row->set_value(W_CITY, street);
+	char state[2];
+	MakeAlphaString(2, 2, state); /* State */
+	row->set_value(W_STATE, state);
+	char zip[9];
+	MakeNumberString(9, 9, zip); /* Zip */
+	row->set_value(W_ZIP, zip);
+	double tax = (double)URand(0L,200L)/1000.0;
+	double w_ytd=300000.00;
+	row->set_value(W_TAX, tax);
+	row->set_value(W_YTD, w_ytd);
+
+	index_load(i_warehouse, wid, row, wh_to_part(wid));
 }
 
-void TPCCWorkload::init_tab_dist(uint64_t wid) {
-	for (uint64_t did = 1; did <= g_dist_per_wh; did++) {
-		row_t * row;
-		uint64_t row_id;
-		t_district->get_new_row(row, 0, row_id);
-		row->set_primary_key(did);
-
-		row->set_value(D_ID, did);
-		row->set_value(D_W_ID, wid);
-		char name[10];
-		MakeAlphaString(6, 10, name);
-		row->set_value(D_NAME, name);
-		char street[20];
-		MakeAlphaString(10, 20, street);
-		row->set_value(D_STREET_1, street);
-		MakeAlphaString(10, 20, street);
-		row->set_value(D_STREET_2, street);
-		MakeAlphaString(10, 20, street);
-		row->set_value(D_CITY, street);
-		char state[2];
-		MakeAlphaString(2, 2, state); /* State */
-		row->set_value(D_STATE, state);
-		char zip[9];
-		MakeNumberString(9, 9, zip); /* Zip */
-		row->set_value(D_ZIP, zip);
-		double tax = (double)URand(0L,200L)/1000.0;
-		double w_ytd=30000.00;
-		row->set_value(D_TAX, tax);
-		row->set_value(D_YTD, w_ytd);
-		row->set_value(D_NEXT_O_ID, 3001);
-
-		index_insert(i_district, distKey(did, wid), row, wh_to_part(wid));
-	}
+void TPCCWorkload::init_tab_dist(uint64_t did, uint64_t wid) {
+	row_t * row;
+	uint64_t row_id;
+	t_district->get_new_row(row, wh_to_part(wid), row_id);
+	row->set_primary_key(did);
+
+	row->set_value(D_ID, did);
+	row->set_value(D_W_ID, wid);
+	char name[10];
+	MakeAlphaString(6, 10, name);
+	row->set_value(D_NAME, name);
+	char street[20];
+	MakeAlphaString(10, 20, street);
+	row->set_value(D_STREET_1, street);
+	MakeAlphaString(10, 20, street);
+	row->set_value(D_STREET_2, street);
+	MakeAlphaString(10, 20, street);
+	row->set_value(D_CITY, street);
+	char state[2];
+	MakeAlphaString(2, 2, state); /* State */
+	row->set_value(D_STATE, state);
+	char zip[9];
+	MakeNumberString(9, 9, zip); /* Zip */
+	row->set_value(D_ZIP, zip);
+	double tax = (double)URand(0L,200L)/1000.0;
+	double w_ytd=30000.00;
+	row->set_value(D_TAX, tax);
+	row->set_value(D_YTD, w_ytd);
+	row->set_value(D_NEXT_O_ID, 3001);
+
+	index_load(i_district, distKey(did, wid), row, wh_to_part(wid));
 }
 
-void TPCCWorkload::init_tab_stock(int id, uint64_t wid) {
+// the stock rows of a warehouse are split across its districts' slices
+void TPCCWorkload::init_tab_stock(uint64_t did, uint64_t wid) {
 
-	for (UInt32 sid = id + 1; sid <= g_max_items; sid+=g_init_parallelism) {
+	for (UInt32 sid = did; sid <= g_max_items; sid+=g_dist_per_wh) {
 		row_t * row;
 		uint64_t row_id;
-		t_stock->get_new_row(row, 0, row_id);
+		t_stock->get_new_row(row, wh_to_part(wid), row_id);
 		row->set_primary_key(sid);
 		row->set_value(S_I_ID, sid);
 		row->set_value(S_W_ID, wid);
@@ -347,16 +395,16 @@ void TPCCWorkload::init_tab_stock(int id, uint64_t wid) {
 	*/
 		row->set_value(S_DATA, s_data);
 #endif
-		index_insert(i_stock, stockKey(sid, wid), row, wh_to_part(wid));
+		index_load(i_stock, stockKey(sid, wid), row, wh_to_part(wid));
 	}
 }
 
-void TPCCWorkload::init_tab_cust(int id, uint64_t did, uint64_t wid) {
+void TPCCWorkload::init_tab_cust(uint64_t did, uint64_t wid) {
 	//assert(g_cust_per_dist >= 1000);
-	for (UInt32 cid = id+1; cid <= g_cust_per_dist; cid += g_init_parallelism) {
+	for (UInt32 cid = 1; cid <= g_cust_per_dist; cid++) {
 		row_t * row;
 		uint64_t row_id;
-		t_customer->get_new_row(row, 0, row_id);
+		t_customer->get_new_row(row, wh_to_part(wid), row_id);
 		row->set_primary_key(cid);
 
 		row->set_value(C_ID, cid);
@@ -415,16 +463,16 @@ void TPCCWorkload::init_tab_cust(int id, uint64_t did, uint64_t wid) {
 		row->set_value(C_PAYMENT_CNT, 1);
 		uint64_t key;
 		key = custNPKey(c_last, did, wid);
-		index_insert(i_customer_last, key, row, wh_to_part(wid));
+		index_load(i_customer_last, key, row, wh_to_part(wid));
 		key = custKey(cid, did, wid);
-		index_insert(i_customer_id, key, row, wh_to_part(wid));
+		index_load(i_customer_id, key, row, wh_to_part(wid));
 	}
 }
 
 void TPCCWorkload::init_tab_hist(uint64_t c_id, uint64_t d_id, uint64_t w_id) {
 	row_t * row;
 	uint64_t row_id;
-	t_history->get_new_row(row, 0, row_id);
+	t_history->get_new_row(row, wh_to_part(w_id), row_id);
 	row->set_primary_key(0);
 	row->set_value(H_C_ID, c_id);
 	row->set_value(H_C_D_ID, d_id);
@@ -441,73 +489,71 @@ void TPCCWorkload::init_tab_hist(uint64_t c_id, uint64_t d_id, uint64_t w_id) {
 
 }
 
-void TPCCWorkload::init_tab_order(int id, uint64_t did, uint64_t wid) {
-	init_permutation(); /* initialize permutation of customer numbers */
-	for (UInt32 oid = id+1; oid <= g_cust_per_dist; oid+=g_init_parallelism) {
+void TPCCWorkload::init_tab_order(uint64_t did, uint64_t wid) {
+	uint64_t * perm_c_id = init_permutation(did, wid); /* customer numbers of the orders */
+	// orders 1..3000: D_NEXT_O_ID starts at 3001
+	for (UInt32 oid = 1; oid <= 3000; oid++) {
 		row_t * row;
 		uint64_t row_id;
-		t_order->get_new_row(row, 0, row_id);
+		t_order->get_new_row(row, wh_to_part(wid), row_id);
 		row->set_primary_key(oid);
 		uint64_t o_ol_cnt = 1;
-		uint64_t cid = get_permutation();
+		uint64_t cid = perm_c_id[(oid - 1) % g_cust_per_dist];
 		row->set_value(O_ID, oid);
 		row->set_value(O_C_ID, cid);
 		row->set_value(O_D_ID, did);
 		row->set_value(O_W_ID, wid);
 		uint64_t o_entry = 2013;
 		row->set_value(O_ENTRY_D, o_entry);
-		if (oid < 2101)
-			row->set_value(O_CARRIER_ID, URand(1, 10));
-		else
-			row->set_value(O_CARRIER_ID, 0);
+		uint64_t o_carrier_id = oid < 2101 ? URand(1, 10) : 0;
+		row->set_value(O_CARRIER_ID, o_carrier_id);
 		o_ol_cnt = URand(5, 15);
 		row->set_value(O_OL_CNT, o_ol_cnt);
-		row->set_value(O_ALL_LOCAL, 1);
+		uint64_t all_local = 1;
+		row->set_value(O_ALL_LOCAL, all_local);
 
 		// Insert to indexes
-//		uint64_t key = custKey(cid, did, wid);
-//		index_insert(i_order_wdc, key, row, wh_to_part(wid));
-
-//		key = orderPrimaryKey(wid, did, oid);
-//		index_insert(i_order_wdo, key, row, wh_to_part(wid));
+		index_load(i_order, orderKey(oid, did, wid), row, wh_to_part(wid));
+		index_load(i_order_wdc, custKey(cid, did, wid), row, wh_to_part(wid));
 
 		// ORDER-LINE
-#if !TPCC_SMALL
 		for (uint64_t ol = 1; ol <= o_ol_cnt; ol++) {
-			t_orderline->get_new_row(row, 0, row_id);
+			t_orderline->get_new_row(row, wh_to_part(wid), row_id);
+			row->set_primary_key(oid);
 			row->set_value(OL_O_ID, oid);
 			row->set_value(OL_D_ID, did);
 			row->set_value(OL_W_ID, wid);
 			row->set_value(OL_NUMBER, ol);
-			row->set_value(OL_I_ID, URand(1, 100000));
+			row->set_value(OL_I_ID, URand(1, g_max_items));
+#if !TPCC_SMALL
 			row->set_value(OL_SUPPLY_W_ID, wid);
 			if (oid < 2101) {
 				row->set_value(OL_DELIVERY_D, o_entry);
-				row->set_value(OL_AMOUNT, 0);
+				row->set_value(OL_AMOUNT, 0.0);
 			} else {
-				row->set_value(OL_DELIVERY_D, 0);
+				uint64_t ol_delivery_d = 0;
+				row->set_value(OL_DELIVERY_D, ol_delivery_d);
 				row->set_value(OL_AMOUNT, (double)URand(1, 999999)/100);
 			}
-			row->set_value(OL_QUANTITY, 5);
+			uint64_t ol_quantity = 5;
+			row->set_value(OL_QUANTITY, ol_quantity);
 			char ol_dist_info[24];
 			MakeAlphaString(24, 24, ol_dist_info);
 			row->set_value(OL_DIST_INFO, ol_dist_info);
-
-//			uint64_t key = orderlineKey(wid, did, oid);
-//			index_insert(i_orderline, key, row, wh_to_part(wid));
-
-//			key = distKey(did, wid);
-//			index_insert(i_orderline_wd, key, row, wh_to_part(wid));
-		}
 #endif
+			index_load(i_orderline, orderKey(oid, did, wid), row, wh_to_part(wid));
+		}
 		// NEW ORDER
 		if (oid > 2100) {
-			t_neworder->get_new_row(row, 0, row_id);
+			t_neworder->get_new_row(row, wh_to_part(wid), row_id);
+			row->set_primary_key(oid);
 			row->set_value(NO_O_ID, oid);
 			row->set_value(NO_D_ID, did);
 			row->set_value(NO_W_ID, wid);
+			index_load(i_neworder, orderKey(oid, did, wid), row, wh_to_part(wid));
 		}
 	}
+	delete[] perm_c_id;
 }
 
 /*==================================================================+
@@ -515,10 +561,11 @@ void TPCCWorkload::init_tab_order(int id, uint64_t did, uint64_t wid) {
 | InitPermutation
 +==================================================================*/
 
-void TPCCWorkload::init_permutation() {
+// Seeded by the district, so every load draws the same permutation.
+uint64_t * TPCCWorkload::init_permutation(uint64_t did, uint64_t wid) {
 	UInt32 i;
-	perm_count = 0;
-	perm_c_id = new uint64_t[g_cust_per_dist];
+	unsigned int seed = distKey(did, wid);
+	uint64_t * perm_c_id = new uint64_t[g_cust_per_dist];
 	// Init with consecutive values
 	for(i = 0; i < g_cust_per_dist; i++) {
 		perm_c_id[i] = i+1;
@@ -526,98 +573,36 @@ void TPCCWorkload::init_permutation() {
 
 	// shuffle
 	for(i=0; i < g_cust_per_dist-1; i++) {
-		uint64_t j = URand(i+1, g_cust_per_dist-1);
+		uint64_t j = i + 1 + rand_r(&seed) % (g_cust_per_dist - 1 - i);
 		uint64_t tmp = perm_c_id[i];
 		perm_c_id[i] = perm_c_id[j];
 		perm_c_id[j] = tmp;
 	}
-	return;
+	return perm_c_id;
 }
 
-
-/*==================================================================+
-| ROUTINE NAME
-| GetPermutation
-+==================================================================*/
-
-uint64_t TPCCWorkload::get_permutation() {
-	if(perm_count >= g_cust_per_dist) {
-		// wrapped around, restart at 0
-		perm_count = 0;
-	}
-	return (uint64_t) perm_c_id[perm_count++];
-}
-
-void * TPCCWorkload::threadInitItem(void * This) {
-  TPCCWorkload * wl = ((thr_args*) This)->wl;
-  int id = ((thr_args*) This)->id;
-	wl->init_tab_item(id);
-	printf("ITEM Done\n");
-	return NULL;
-}
-
-void * TPCCWorkload::threadInitWh(void * This) {
-  TPCCWorkload * wl = (TPCCWorkload*) This;
-	wl->init_tab_wh();
-	printf("WAREHOUSE Done\n");
-	return NULL;
-}
-
-void * TPCCWorkload::threadInitDist(void * This) {
-  TPCCWorkload * wl = (TPCCWorkload*) This;
-	for (uint64_t wid = 1; wid <= g_num_wh; wid ++) {
-	//if (GET_NODE_ID(wh_to_part(wid)) != g_node_id) continue;
-		wl->init_tab_dist(wid);
-  }
-	printf("DISTRICT Done\n");
-	return NULL;
-}
-
-void * TPCCWorkload::threadInitStock(void * This) {
+void * TPCCWorkload::threadLoad(void * This) {
   TPCCWorkload * wl = ((thr_args*) This)->wl;
   int id = ((thr_args*) This)->id;
-	for (uint64_t wid = 1; wid <= g_num_wh; wid ++) {
-	//if (GET_NODE_ID(wh_to_part(wid)) != g_node_id) continue;
-		wl->init_tab_stock(id,wid);
-  }
-	printf("STOCK Done\n");
-	return NULL;
-}
-
-void * TPCCWorkload::threadInitCust(void * This) {
-  TPCCWorkload * wl = ((thr_args*) This)->wl;
-  int id = ((thr_args*) This)->id;
-	for (uint64_t wid = 1; wid <= g_num_wh; wid ++) {
-	//if (GET_NODE_ID(wh_to_part(wid)) != g_node_id) continue;
-		for (uint64_t did = 1; did <= g_dist_per_wh; did++) {
-			wl->init_tab_cust(id,did, wid);
+  int tot = ((thr_args*) This)->tot;
+	wl->init_tab_item(id, tot);
+	uint64_t slice;
+	while ((slice = ATOM_FETCH_ADD(wl->load_next_slice, 1)) < g_num_wh * g_dist_per_wh) {
+		uint64_t wid = slice / g_dist_per_wh + 1;
+		uint64_t did = slice % g_dist_per_wh + 1;
+		wl->load_slice(did, wid);
 	}
-  }
-	printf("CUSTOMER %d Done\n",((thr_args *)This)->id);
-	return NULL;
-}
-
-void * TPCCWorkload::threadInitHist(void * This) {
-  TPCCWorkload * wl = (TPCCWorkload*) This;
-	for (uint64_t wid = 1; wid <= g_num_wh; wid ++) {
-	//if (GET_NODE_ID(wh_to_part(wid)) != g_node_id) continue;
-		for (uint64_t did = 1; did <= g_dist_per_wh; did++)
-	  for (uint64_t cid = 1; cid <= g_cust_per_dist; cid++) wl->init_tab_hist(cid, did, wid);
-  }
-	printf("HISTORY Done\n");
+	wl->flush_index_load();
 	return NULL;
 }
 
-void * TPCCWorkload::threadInitOrder(void * This) {
-  TPCCWorkload * wl = ((thr_args*) This)->wl;
-  int id = ((thr_args*) This)->id;
-	for (uint64_t wid = 1; wid <= g_num_wh; wid ++) {
-	//if (GET_NODE_ID(wh_to_part(wid)) != g_node_id) continue;
-	for (uint64_t did = 1; did <= g_dist_per_wh; did++) wl->init_tab_order(id, did, wid);
-  }
-	printf("ORDER Done\n");
-	return NULL;
+// Loads district did of warehouse wid with its customers, history and orders, a
+// g_dist_per_wh-th of the warehouse's stock, and the warehouse row with district 1.
+void TPCCWorkload::load_slice(uint64_t did, uint64_t wid) {
+	if (did == 1) init_tab_wh(wid);
+	init_tab_dist(did, wid);
+	init_tab_stock(did, wid);
+	init_tab_cust(did, wid);
+	for (uint64_t cid = 1; cid <= g_cust_per_dist; cid++) init_tab_hist(cid, did, wid);
+	init_tab_order(did, wid);
 }
-
-
-
@@ -40,6 +40,7 @@ public :
 	RC init_schema(const char * schema_file);
 	RC get_txn_man(TxnManager *& txn_manager);
 	int key_to_part(uint64_t key);
+	string snapshot_key();
 	INDEX * the_index;
 	table_t * the_table;
 private:
@@ -67,6 +68,7 @@ public:
 private:
   void next_ycsb_state();
   RC run_txn_state();
+  RC run_txn_co();
   RC run_ycsb_0(ycsb_request * req,row_t *& row_local);
   RC run_ycsb_1(access_t acctype, row_t * row_local);
   RC run_ycsb();
@@ -22,19 +22,90 @@
 #include "table.h"
 #include "helper.h"
 #include "message.h"
+#include "sim_manager.h"
+#include <algorithm>
+#include <fstream>
 
 uint64_t YCSBQueryGenerator::the_n = 0;
-double YCSBQueryGenerator::denom = 0;
+std::vector<SkewPhase> YCSBQueryGenerator::phases;
+pthread_mutex_t YCSBQueryGenerator::phase_lock = PTHREAD_MUTEX_INITIALIZER;
 
-void YCSBQueryGenerator::init() {
+void YCSBQueryGenerator::init(uint64_t gen_id) {
 	mrand = (myrand *) mem_allocator.alloc(sizeof(myrand));
-	mrand->init(get_sys_clock());
-	if (SKEW_METHOD == ZIPF) {
-		zeta_2_theta = zeta(2, g_zipf_theta);
-		uint64_t table_size = g_synth_table_size / g_part_cnt;
-		the_n = table_size - 1;
-		denom = zeta(the_n, g_zipf_theta);
+	mrand->init(g_seed * 1000003 + gen_id);
+	pthread_mutex_lock(&phase_lock);
+	if (phases.empty()) init_phases();
+	pthread_mutex_unlock(&phase_lock);
+}
+
+// One phase per theta, each with its zeta computed once; the phases cycle over
+// the run and the hot keys move independently of them.
+void YCSBQueryGenerator::init_phases() {
+	uint64_t table_size = g_synth_table_size / g_part_cnt;
+	the_n = table_size - 1;
+	std::vector<SkewPhase> list;
+	SkewPhase phase;
+	phase.start = 0;
+	phase.offset = 0;
+	phase.theta = g_zipf_theta;
+#if SKEW_SHIFT == SHIFT_TRACE
+	std::ifstream trace(SHIFT_TRACE_FILE);
+	double start_sec;
+	while (trace >> start_sec >> phase.offset >> phase.theta) {
+		phase.start = (uint64_t)(start_sec * BILLION);
+		list.push_back(phase);
+	}
+	std::stable_sort(list.begin(), list.end(),
+									 [](const SkewPhase &a, const SkewPhase &b) { return a.start < b.start; });
+	if (list.empty() || list[0].start > 0) {
+		phase.start = 0;
+		phase.offset = 0;
+		phase.theta = g_zipf_theta;
+		list.insert(list.begin(), phase);
+	}
+#elif SKEW_SHIFT != SHIFT_NONE
+	std::stringstream thetas(SHIFT_THETA);
+	std::string theta;
+	while (std::getline(thetas, theta, ',')) {
+		phase.start = list.size() * g_shift_interval;
+		phase.theta = atof(theta.c_str());
+		list.push_back(phase);
+	}
+	if (list.empty()) list.push_back(phase);
+#else
+	list.push_back(phase);
+#endif
+	std::map<double, double> zetas;
+	for (auto it = list.begin(); it != list.end(); it++) {
+		if (SKEW_METHOD == ZIPF && zetas.find(it->theta) == zetas.end())
+			zetas[it->theta] = zeta(the_n, it->theta);
+		it->zetan = zetas[it->theta];
+		it->zeta_2_theta = zeta(2, it->theta);
+		it->offset %= table_size;
 	}
+	phases = list;
+}
+
+const SkewPhase &YCSBQueryGenerator::get_phase(uint64_t &offset) {
+	uint64_t now = get_sys_clock();
+	now = now > simulation->run_starttime ? now - simulation->run_starttime : 0;
+#if SKEW_SHIFT == SHIFT_TRACE
+	uint64_t i = phases.size() - 1;
+	while (i > 0 && phases[i].start > now) i--;
+	offset = phases[i].offset;
+	return phases[i];
+#else
+	uint64_t k = now / g_shift_interval;
+#if SKEW_SHIFT == SHIFT_DRIFT
+	offset = now / 1000000 * g_shift_drift_rate / 1000;
+#elif SKEW_SHIFT == SHIFT_JUMP
+	offset = k * g_shift_jump_keys;
+#else
+	offset = 0;
+#endif
+	offset %= g_synth_table_size / g_part_cnt;
+	return phases[k % phases.size()];
+#endif
 }
 
 BaseQuery * YCSBQueryGenerator::create_query(Workload * h_wl, uint64_t home_partition_id) {
@@ -190,12 +261,12 @@ double YCSBQueryGenerator::zeta(uint64_t n, double theta) {
 	return sum;
 }
 
-uint64_t YCSBQueryGenerator::zipf(uint64_t n, double theta) {
+uint64_t YCSBQueryGenerator::zipf(uint64_t n, const SkewPhase &phase) {
 	assert(this->the_n == n);
-	assert(theta == g_zipf_theta);
+	double theta = phase.theta;
 	double alpha = 1 / (1 - theta);
-	double zetan = denom;
-	double eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta_2_theta / zetan);
+	double zetan = phase.zetan;
+	double eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - phase.zeta_2_theta / zetan);
 //	double eta = (1 - pow(2.0 / n, 1 - theta)) /
 //		(1 - zeta_2_theta / zetan);
 	double u = (double)(mrand->next() % 10000000) / 10000000;
@@ -221,6 +292,10 @@ BaseQuery * YCSBQueryGenerator::gen_requests_hot(uint64_t home_partition_id, Wor
 		part_limit = 1;
 	uint64_t hot_key_max = (uint64_t)g_data_perc;
 	double r_twr = (double)(mrand->next() % 10000) / 10000;
+	// moving a key by whole rows of partitions keeps its partition
+	uint64_t shift;
+	get_phase(shift);
+	shift *= g_part_cnt;
 
 	int rid = 0;
 	for (UInt32 i = 0; i < g_req_per_query; i ++) {
@@ -274,6 +349,7 @@ BaseQuery * YCSBQueryGenerator::gen_requests_hot(uint64_t home_partition_id, Wor
 			}
 		}
 		
+		row_id = (row_id + shift) % g_synth_table_size;
 		query_to_row[row_id] ++;
 		partitions_accessed.insert(partition_id);
 		assert(row_id < g_synth_table_size);
@@ -326,6 +402,8 @@ BaseQuery * YCSBQueryGenerator::gen_requests_zipf(uint64_t home_partition_id, Wo
 	set<uint64_t> all_keys;
 	set<uint64_t> partitions_accessed;
 	uint64_t table_size = g_synth_table_size / g_part_cnt;
+	uint64_t shift;
+	const SkewPhase &phase = get_phase(shift);
 
 	double r_twr = (double)(mrand->next() % 10000) / 10000;
 
@@ -457,7 +535,7 @@ BaseQuery * YCSBQueryGenerator::gen_requests_zipf(uint64_t home_partition_id, Wo
 			req->acctype = RD;
 		else
 			req->acctype = WR;
-		uint64_t row_id = zipf(table_size - 1, g_zipf_theta);
+		uint64_t row_id = (zipf(table_size - 1, phase) + shift) % table_size;
 		assert(row_id < table_size);
 		uint64_t primary_key = row_id * g_part_cnt + partition_id;
 		assert(primary_key < g_synth_table_size);
@@ -49,22 +49,36 @@ public:
 	//UInt32 scan_len;
 };
 
+// A SKEW_SHIFT phase: the zipf constants of its theta, computed once, and
+// where its hot keys start
+struct SkewPhase {
+	uint64_t start; // ns since the run start
+	uint64_t offset; // keys per partition the hot keys are moved by
+	double theta;
+	double zetan;
+	double zeta_2_theta;
+};
+
 class YCSBQueryGenerator : public QueryGenerator {
 public:
-  void init();
+  // with SEED set, generator gen_id of a node always draws the same keys
+  void init(uint64_t gen_id = 0);
   BaseQuery * create_query(Workload * h_wl, uint64_t home_partition_id);
 
 private:
 	BaseQuery * gen_requests_hot(uint64_t home_partition_id, Workload * h_wl);
 	BaseQuery * gen_requests_zipf(uint64_t home_partition_id, Workload * h_wl);
 	// for Zipfian distribution
-	double zeta(uint64_t n, double theta);
-	uint64_t zipf(uint64_t n, double theta);
+	static double zeta(uint64_t n, double theta);
+	uint64_t zipf(uint64_t n, const SkewPhase &phase);
+	// the phase in effect now; offset is how far its hot keys have moved
+	const SkewPhase &get_phase(uint64_t &offset);
+	static void init_phases();
 
 	myrand * mrand;
 	static uint64_t the_n;
-	static double denom;
-	double zeta_2_theta;
+	static std::vector<SkewPhase> phases;
+	static pthread_mutex_t phase_lock;
 };
 
 class YCSBQuery : public BaseQuery {
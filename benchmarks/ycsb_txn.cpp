@@ -96,7 +96,7 @@ RC YCSBTxnManager::run_txn() {
   RC rc = RCOK;
   assert(CC_ALG != CALVIN);
 
-  if(IS_LOCAL(txn->txn_id) && state == YCSB_0 && next_record_id == 0) {
+  if(IS_LOCAL(txn->txn_id) && state == YCSB_0 && next_record_id == 0 && co_point == 0) {
     DEBUG("Running txn %ld\n",txn->txn_id);
     //query->print();
     query->partitions_touched.add_unique(GET_PART_ID(0,g_node_id));
@@ -105,9 +105,13 @@ RC YCSBTxnManager::run_txn() {
 
   uint64_t starttime = get_sys_clock();
 
+#if TXN_COROUTINE
+  rc = run_txn_co();
+#else
   while(rc == RCOK && !is_done()) {
     rc = run_txn_state();
   }
+#endif
 
   uint64_t curr_time = get_sys_clock();
   txn_stats.process_time += curr_time - starttime;
@@ -138,7 +142,9 @@ RC YCSBTxnManager::run_txn_post_wait() {
   uint64_t curr_time = get_sys_clock();
   txn_stats.process_time += curr_time - starttime;
   txn_stats.process_time_short += curr_time - starttime;
+#if !TXN_COROUTINE
   next_ycsb_state();
+#endif
   INC_STATS(get_thd_id(),trans_benchmark_compute_time,get_sys_clock() - curr_time);
   return RCOK;
 }
@@ -286,6 +292,28 @@ RC YCSBTxnManager::run_txn_state() {
   return rc;
 }
 
+// The requests of one txn as a resumable body. A remote request ships every following
+// request for the same node and resumes on its RQRY_RSP with next_record_id past them;
+// a lock wait resumes after get_row_post_wait() has filled in row.
+RC YCSBTxnManager::run_txn_co() {
+  YCSBQuery* ycsb_query = (YCSBQuery*) query;
+  RC rc = RCOK;
+  TXN_CO_BEGIN
+  while (!is_done()) {
+    if (!is_local_request(next_record_id)) {
+      rc = send_remote_request();
+      TXN_CO_AWAIT(rc);
+      continue;
+    }
+    rc = run_ycsb_0(ycsb_query->requests[next_record_id], row);
+    TXN_CO_AWAIT(rc);
+    rc = run_ycsb_1(ycsb_query->requests[next_record_id]->acctype, row);
+    next_record_id++;
+  }
+  TXN_CO_END
+  return rc;
+}
+
 RC YCSBTxnManager::run_ycsb_0(ycsb_request * req,row_t *& row_local) {
   uint64_t starttime = get_sys_clock();
   RC rc = RCOK;
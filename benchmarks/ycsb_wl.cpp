@@ -18,6 +18,7 @@
 #include "helper.h"
 #include "ycsb.h"
 #include "wl.h"
+#include "checkpoint.h"
 #include "thread.h"
 #include "table.h"
 #include "row.h"
@@ -52,13 +53,24 @@ RC YCSBWorkload::init() {
 
   printf("Initializing table... ");
   fflush(stdout);
-	init_table_parallel();
+#if CKPT_LOAD
+	if (checkpointer.load(this) != RCOK)
+#endif
+	if (load_snapshot() != RCOK) {
+		init_table_parallel();
+		dump_snapshot();
+	}
   printf("Done\n");
   fflush(stdout);
 //	init_table();
 	return RCOK;
 }
 
+string YCSBWorkload::snapshot_key() {
+	return Workload::snapshot_key() + "_t" + to_string(g_synth_table_size) + "_k" +
+				 to_string(KEY_TO_PART);
+}
+
 RC YCSBWorkload::init_schema(const char * schema_file) {
 	Workload::init_schema(schema_file);
 	the_table = tables["MAIN_TABLE"];
@@ -117,6 +129,7 @@ RC YCSBWorkload::init_table() {
             itemid_t * m_item =
                 (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
 			assert(m_item != NULL);
+			m_item->init();
             m_item->type = DT_row;
             m_item->location = new_row;
             m_item->valid = true;
@@ -182,6 +195,7 @@ void * YCSBWorkload::init_table_slice(){
 			itemid_t * m_item =
 			(itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
 			assert(m_item != NULL);
+			m_item->init();
 			m_item->type = DT_row;
 			m_item->location = new_row;
 			m_item->valid = true;
@@ -214,6 +228,7 @@ void * YCSBWorkload::init_table_slice(){
 			itemid_t * m_item =
 			(itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
 			assert(m_item != NULL);
+			m_item->init();
 			m_item->type = DT_row;
 			m_item->location = new_row;
 			m_item->valid = true;
@@ -279,6 +294,7 @@ void * YCSBWorkload::init_table_slice() {
 		itemid_t * m_item =
 			(itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
 		assert(m_item != NULL);
+		m_item->init();
 		m_item->type = DT_row;
 		m_item->location = new_row;
 		m_item->valid = true;
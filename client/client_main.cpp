@@ -91,7 +91,12 @@ int main(int argc, char *argv[]) {
 		query_to_row[i] = 0;
 	}
 
+#if SEED != 0
+	uint64_t seed = SEED + g_node_id;
+#else
 	uint64_t seed = get_sys_clock();
+#endif
+	g_seed = seed;
 	srand(seed);
 	printf("Random seed: %ld\n",seed);
 
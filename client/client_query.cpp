@@ -23,6 +23,8 @@
 #include "tpcc_helper.h"
 #include "pps_query.h"
 #include "da_query.h"
+#include "sim_manager.h"
+#include "helper.h"
 
 /*************************************************/
 //     class Query_queue
@@ -44,6 +46,10 @@ Client_query_queue::init(Workload * h_wl) {
 	size = g_thread_cnt;
 #else
   	size = g_servers_per_client;
+#endif
+#if STREAM_QUERIES
+	init_streams();
+	return;
 #endif
 	query_cnt = new uint64_t * [size];
 	for ( UInt32 id = 0; id < size; id ++) {
@@ -109,16 +115,10 @@ Client_query_queue::initQueriesParallel(uint64_t thd_id) {
 	}
 #endif
 #endif
-#if WORKLOAD == YCSB
-	YCSBQueryGenerator * gen = new YCSBQueryGenerator;
-	gen->init();
-#elif WORKLOAD == TPCC
-	TPCCQueryGenerator * gen = new TPCCQueryGenerator;
-	gen->init();
-#elif WORKLOAD == PPS
-	PPSQueryGenerator * gen = new PPSQueryGenerator;
-#elif WORKLOAD == DA
-	DAQueryGenerator  * gen = new DAQueryGenerator;
+#if WORKLOAD != DA
+	QueryGenerator * gen = create_generator(tid);
+#else
+	QueryGenerator * gen = create_generator(thd_id);
 #endif
 #if SERVER_GENERATE_QUERIES
   #if CC_ALG == BOCC || CC_ALG == FOCC || ONE_NODE_RECIEVE == 1
@@ -151,14 +151,158 @@ Client_query_queue::initQueriesParallel(uint64_t thd_id) {
 #endif
 }
 
+QueryGenerator * Client_query_queue::create_generator(uint64_t gen_id) {
+#if WORKLOAD == YCSB
+	YCSBQueryGenerator * gen = new YCSBQueryGenerator;
+	gen->init(gen_id);
+#elif WORKLOAD == TPCC
+	TPCCQueryGenerator * gen = new TPCCQueryGenerator;
+	gen->init(gen_id);
+#elif WORKLOAD == PPS
+	PPSQueryGenerator * gen = new PPSQueryGenerator;
+	gen->init(gen_id);
+#elif WORKLOAD == DA
+	DAQueryGenerator  * gen = new DAQueryGenerator;
+#endif
+	return gen;
+}
+
+#if STREAM_QUERIES
+static void free_query(BaseQuery * query) {
+#if WORKLOAD == YCSB
+	((YCSBQuery *)query)->release();
+	mem_allocator.free(query, sizeof(YCSBQuery));
+#elif WORKLOAD == TPCC
+	((TPCCQuery *)query)->release();
+	mem_allocator.free(query, sizeof(TPCCQuery));
+#elif WORKLOAD == PPS
+	((PPSQuery *)query)->release();
+	mem_allocator.free(query, sizeof(PPSQuery));
+#endif
+}
+
+static uint64_t query_partition(BaseQuery * query) {
+#if WORKLOAD == YCSB
+	return key_to_part(((YCSBQuery *)query)->requests[0]->key);
+#elif WORKLOAD == TPCC
+	return wh_to_part(((TPCCQuery *)query)->w_id);
+#else
+	return query->partitions[0];
+#endif
+}
+
+void Client_query_queue::init_streams() {
+	uint64_t inflight = g_inflight_max * std::max(g_part_cnt / g_node_cnt, (UInt32)1);
+	// slots still in flight hold back the ring, so keep it well above the window
+	ring_size = std::max((uint64_t)g_client_query_ring, 4 * inflight);
+	streams = new ClientQueryStream * [g_client_thread_cnt];
+	for (uint64_t thd_id = 0; thd_id < g_client_thread_cnt; thd_id++) {
+		streams[thd_id] = new ClientQueryStream[size];
+		for (uint64_t server_id = 0; server_id < size; server_id++) {
+			ClientQueryStream * stream = &streams[thd_id][server_id];
+			stream->gen = create_generator(thd_id * size + server_id);
+			stream->ring = new BaseQuery * [ring_size];
+			memset(stream->ring, 0, sizeof(BaseQuery *) * ring_size);
+			stream->in_flight = new bool [ring_size];
+			memset((void *)stream->in_flight, 0, sizeof(bool) * ring_size);
+			stream->id = thd_id * size + server_id;
+			stream->home_partition_id = server_id + g_server_start_node;
+			stream->head = 0;
+			stream->tail = 0;
+		}
+	}
+#if CLIENT_QUERY_PREFILL
+	pthread_t prefill_thd;
+	pthread_create(&prefill_thd, NULL, prefillHelper, this);
+	pthread_detach(prefill_thd);
+#endif
+}
+
+// false while the next slot still waits for the CL_RSP of its query
+bool Client_query_queue::fill_stream(ClientQueryStream * stream) {
+	uint64_t slot = stream->tail % ring_size;
+	if (stream->in_flight[slot]) {
+		// no response comes after the run ends: leave that query to its message
+		if (!simulation->is_done()) return false;
+		stream->in_flight[slot] = false;
+	} else if (stream->ring[slot] != NULL) {
+		free_query(stream->ring[slot]);
+	}
+	BaseQuery * query = stream->gen->create_query(_wl, stream->home_partition_id);
+	query->client_qid = stream->id * ring_size + slot;
+	stream->ring[slot] = query;
+	COMPILER_BARRIER
+	stream->tail = stream->tail + 1;
+	return true;
+}
+
+void Client_query_queue::query_done(uint64_t client_qid) {
+	assert(client_qid != UINT64_MAX);
+	uint64_t stream_id = client_qid / ring_size;
+	ClientQueryStream * stream = &streams[stream_id / size][stream_id % size];
+	uint64_t slot = client_qid % ring_size;
+	assert(stream->in_flight[slot]);
+	COMPILER_BARRIER
+	stream->in_flight[slot] = false;
+}
+
+// partition_id UINT64_MAX takes the next query whatever its partition
+BaseQuery * Client_query_queue::next_stream_query(uint64_t server_id, uint64_t thread_id,
+																									uint64_t partition_id) {
+	assert(server_id < size && thread_id < g_client_thread_cnt);
+	ClientQueryStream * stream = &streams[thread_id][server_id];
+	while (true) {
+#if CLIENT_QUERY_PREFILL
+		while (stream->head == stream->tail) PAUSE_SILO
+#else
+		while (!fill_stream(stream)) PAUSE_SILO
+#endif
+		uint64_t slot = stream->head % ring_size;
+		BaseQuery * query = stream->ring[slot];
+		// a skipped query is never sent, so its slot stays free
+		bool send = partition_id == UINT64_MAX || query_partition(query) == partition_id;
+		if (send) stream->in_flight[slot] = true;
+		COMPILER_BARRIER
+		stream->head = stream->head + 1;
+		if (send) return query;
+	}
+}
+
+// keeps every ring half generated ahead of its client thread
+void * Client_query_queue::prefillHelper(void * context) {
+	Client_query_queue * queue = (Client_query_queue *)context;
+	while (!simulation->is_done()) {
+		bool idle = true;
+		for (uint64_t thd_id = 0; thd_id < g_client_thread_cnt; thd_id++) {
+			for (uint64_t server_id = 0; server_id < queue->size; server_id++) {
+				ClientQueryStream * stream = &queue->streams[thd_id][server_id];
+				while (stream->tail - stream->head < queue->ring_size / 2 &&
+							 queue->fill_stream(stream)) {
+					idle = false;
+				}
+			}
+		}
+		if (idle) usleep(100);
+	}
+	return NULL;
+}
+#endif
+
 bool Client_query_queue::done() { return false; }
 
 BaseQuery *
 Client_query_queue::get_next_query(uint64_t server_id,uint64_t thread_id) {
-#if WORKLOAD == DA
+#if STREAM_QUERIES
+  return next_stream_query(server_id, thread_id);
+#elif WORKLOAD == DA
   BaseQuery * query;
+#if DA_LOCKFREE_QUEUE
+  DAQuery * da_query;
+  while (!da_query_queue.pop(da_query)) PAUSE_SILO
+  query = da_query;
+#else
   query=da_gen_qry_queue.pop_data();
-  //while(!da_query_queue.pop(query));
+#endif
   return query;
 #else
   assert(server_id < size);
@@ -176,10 +320,15 @@ Client_query_queue::get_next_query(uint64_t server_id,uint64_t thread_id) {
 
 BaseQuery *
 Client_query_queue::get_next_query_partition(uint64_t server_id, uint64_t partition_id,uint64_t thread_id){
+#if STREAM_QUERIES
+	return next_stream_query(server_id, thread_id, partition_id);
+#endif
 =======
 BaseQuery *
 Client_query_queue::get_next_query_partition(uint64_t server_id, uint64_t partition_id,uint64_t thread_id){
-#if WORKLOAD == YCSB
+#if STREAM_QUERIES
+	return next_stream_query(server_id, thread_id, partition_id);
+#elif WORKLOAD == YCSB
 >>>>>>> 8ee691f8bc5012b01a09fa4ed4cd44586f4b7b9d
 	uint64_t query_id = __sync_fetch_and_add(query_cnt[server_id], 1);
 	if(query_id > g_max_txn_per_part) {
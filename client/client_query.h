@@ -26,6 +26,22 @@ class YCSBQuery;
 class YCSBClientQuery;
 class TPCCQuery;
 class tpcc_client_query;
+class QueryGenerator;
+
+#define STREAM_QUERIES (CLIENT_QUERY_STREAM && !SERVER_GENERATE_QUERIES && WORKLOAD != DA)
+
+// Queries of one client thread to one server, generated on demand into a ring.
+// A query handed out stays in flight until its CL_RSP arrives, and its slot is
+// only regenerated after that, so no message still points into a freed query.
+struct ClientQueryStream {
+	QueryGenerator * gen;
+	BaseQuery ** ring;
+	volatile bool * in_flight; // per slot: sent and not answered yet
+	uint64_t id; // client thread * servers + server
+	uint64_t home_partition_id;
+	volatile uint64_t head; // next query handed to the client thread
+	volatile uint64_t tail; // next slot to generate
+};
 
 // We assume a separate task queue for each thread in order to avoid
 // contention in a centralized query queue. In reality, more sophisticated
@@ -39,8 +55,23 @@ public:
   void initQueriesParallel(uint64_t thd_id);
   static void * initQueriesHelper(void * context);
   BaseQuery * get_next_query_partition(uint64_t server_id, uint64_t partition_id,uint64_t thread_id);
+#if STREAM_QUERIES
+	// the CL_RSP of the query with this BaseQuery::client_qid arrived
+	void query_done(uint64_t client_qid);
+#endif
+	// a generator of the compiled workload, also used by runbench
+	QueryGenerator * create_generator(uint64_t gen_id);
 
 private:
+#if STREAM_QUERIES
+	void init_streams();
+	bool fill_stream(ClientQueryStream * stream);
+	BaseQuery * next_stream_query(uint64_t server_id, uint64_t thread_id,
+																uint64_t partition_id = UINT64_MAX);
+	static void * prefillHelper(void * context);
+	ClientQueryStream ** streams; // [client thread][server]
+	uint64_t ring_size;
+#endif
 	Workload * _wl;
   uint64_t size;
   std::vector<std::vector<BaseQuery*>> queries;
@@ -23,6 +23,7 @@
 #include "../system/txn.h"
 #include "dli.h"
 #include "row_dta.h"
+#include "rts_cache.h"
 
 void get_rw_set(TxnManager* txn, std::list<dta_item>& rset, std::list<dta_item>& wset) {
   uint64_t len = txn->get_access_cnt();
@@ -101,8 +102,13 @@ RC Dta::validate(TxnManager* txn) {
   for (UInt32 i = 0; i < wset->set_size; i++) {
     // 1. get the max read timestamp, and just the lower
     row_t* cur_wrow = wset->rows[i];
-    if (lower <= cur_wrow->manager->timestamp_last_read) {
-      lower = cur_wrow->manager->timestamp_last_read + 1;
+#if RTS_CACHE_ENABLE
+    uint64_t rts = dta_rts_cache.getRts(cur_wrow->get_primary_key(), 0, txn->get_thd_id());
+#else
+    uint64_t rts = cur_wrow->manager->timestamp_last_read;
+#endif
+    if (lower <= rts) {
+      lower = rts + 1;
     }
     if (lower >= upper) goto VALID_END;
 
@@ -15,6 +15,7 @@
 */
 
 #include "row_dta.h"
+#include "rts_cache.h"
 
 #include "dta.h"
 #include "helper.h"
@@ -249,6 +250,9 @@ RC Row_dta::commit(access_t type, TxnManager* txn, row_t* data, uint64_t& versio
   uint64_t txn_commit_ts = txn->get_commit_timestamp();
 
   if (txn_commit_ts > timestamp_last_read) timestamp_last_read = txn_commit_ts;
+#if RTS_CACHE_ENABLE
+  dta_rts_cache.add(_row->get_primary_key(), 0, txn_commit_ts);
+#endif
   uncommitted_reads->erase(txn->get_txn_id());
 
   if (type == WR) {
@@ -21,6 +21,7 @@
 #include "txn.h"
 #include "row_lock.h"
 
+#if !ROW_LOCK_WORD_CC
 void Row_lock::init(row_t * row) {
     _row = row;
     owners_size = 1;//1031;
@@ -39,17 +40,24 @@ void Row_lock::init(row_t * row) {
     lock_type = LOCK_NONE;
     blatch = false;
     own_starttime = 0;
+#if CLV_CC
+    retired = NULL;
+    clv_writer = NULL;
+    clv_image = NULL;
+#endif
 
 }
 
+template <UInt32 ALG>
 RC Row_lock::lock_get(lock_t type, TxnManager * txn) {
 	uint64_t *txnids = NULL;
 	int txncnt = 0;
-	return lock_get(type, txn, txnids, txncnt);
+	return lock_get<ALG>(type, txn, txnids, txncnt);
 }
 
+template <UInt32 ALG>
 RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt) {
-    assert (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN);
+    assert (ALG == NO_WAIT || ALG == WAIT_DIE || ALG == CALVIN);
     RC rc;
     uint64_t starttime = get_sys_clock();
     uint64_t lock_get_start_time = starttime;
@@ -68,25 +76,25 @@ RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txn
 #if TWOPL_LITE
 	  conflict = owner_cnt > 0;
 #endif
-	if (CC_ALG == WAIT_DIE && !conflict) {
+	if (ALG == WAIT_DIE && !conflict) {
 		if (waiters_head && txn->get_timestamp() < waiters_head->txn->get_timestamp()) {
 			conflict = true;
 		}
 	}
-    if (CC_ALG == CALVIN && !conflict) {
+    if (ALG == CALVIN && !conflict) {
     if (waiters_head) conflict = true;
     }
 
     if (conflict) {
     //printf("conflict! rid%ld txnid%ld ",_row->get_primary_key(),txn->get_txn_id());
         // Cannot be added to the owner list.
-        if (CC_ALG == NO_WAIT) {
+        if (ALG == NO_WAIT) {
             rc = Abort;
       DEBUG("abort %ld,%ld %ld %lx\n", txn->get_txn_id(), txn->get_batch_id(),
             _row->get_primary_key(), (uint64_t)_row);
       //printf("abort %ld %ld %lx\n",txn->get_txn_id(),_row->get_primary_key(),(uint64_t)_row);
             goto final;
-        } else if (CC_ALG == WAIT_DIE) {
+        } else if (ALG == WAIT_DIE) {
             ///////////////////////////////////////////////////////////
             //  - T is the txn currently running
             //  IF T.ts > min ts of owners
@@ -153,7 +161,7 @@ RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txn
               _row->get_primary_key(), (uint64_t)_row);
               rc = Abort;
             }
-        } else if (CC_ALG == CALVIN){
+        } else if (ALG == CALVIN){
             LockEntry * entry = get_entry();
             entry->start_ts = get_sys_clock();
             entry->txn = txn;
@@ -180,13 +188,13 @@ RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txn
 #if DEBUG_TIMELINE
         printf("LOCK %ld %ld\n",entry->txn->get_txn_id(),entry->start_ts);
 #endif
-#if CC_ALG != NO_WAIT
-        LockEntry * entry = get_entry();
-        entry->type = type;
-        entry->start_ts = get_sys_clock();
-        entry->txn = txn;
-        STACK_PUSH(owners[hash(txn->get_txn_id())], entry);
-#endif
+        if (ALG != NO_WAIT) {
+          LockEntry * entry = get_entry();
+          entry->type = type;
+          entry->start_ts = get_sys_clock();
+          entry->txn = txn;
+          STACK_PUSH(owners[hash(txn->get_txn_id())], entry);
+        }
         if(owner_cnt > 0) {
           assert(type == LOCK_SH);
           INC_STATS(txn->get_thd_id(),twopl_sh_bypass_cnt,1);
@@ -200,6 +208,9 @@ RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txn
         }
         lock_type = type;
         rc = RCOK;
+#if CLV_CC
+        if (retired) clv_violate(type, txn);
+#endif
 
     }
 final:
@@ -222,7 +233,8 @@ INC_STATS(txn->get_thd_id(),twopl_getlock_cnt,1);
 }
 
 
-RC Row_lock::lock_release(TxnManager * txn) {
+template <UInt32 ALG>
+RC Row_lock::lock_release(TxnManager * txn, row_t * rollback) {
 
 #if CC_ALG == CALVIN
     if (txn->isRecon()) {
@@ -241,9 +253,44 @@ RC Row_lock::lock_release(TxnManager * txn) {
   DEBUG("unlock (%ld,%ld): owners %d, own type %d, key %ld %lx\n", txn->get_txn_id(),
         txn->get_batch_id(), owner_cnt, lock_type, _row->get_primary_key(), (uint64_t)_row);
 
+#if CLV_CC
+      if (retired && retired->txn == txn) {
+        if (rollback && clv_writer) {
+          // the exclusive owner built on this write and aborts with it: leave the row to
+          // its rollback
+          clv_image = (char *) mem_allocator.alloc(_row->get_tuple_size());
+          memcpy(clv_image, rollback->get_data(), _row->get_tuple_size());
+        } else {
+          if (rollback) _row->copy(rollback);
+          clv_writer = NULL;
+        }
+        return_entry(retired);
+        retired = NULL;
+        if (g_central_man)
+            glob_manager.release_row(_row);
+        else
+            pthread_mutex_unlock( latch );
+        return RCOK;
+      }
+      if (rollback) {
+        if (clv_writer == txn && clv_image)
+          _row->set_data(clv_image);
+        else
+          _row->copy(rollback);
+      }
+      if (clv_writer == txn) {
+        assert(rollback || !clv_image);
+        if (clv_image) mem_allocator.free(clv_image, _row->get_tuple_size());
+        clv_image = NULL;
+        clv_writer = NULL;
+      }
+#else
+      if (rollback) _row->copy(rollback);
+#endif
+
       // If CC is NO_WAIT or WAIT_DIE, txn should own this lock
       // What about Calvin?
-#if CC_ALG == NO_WAIT
+      if (ALG == NO_WAIT) {
       //这里assert=0，先改一下看看:注释掉assert if (owner_cnt==0) 改成 (owner_cnt<=0)
       assert(owner_cnt > 0);
       owner_cnt--;
@@ -261,7 +308,7 @@ RC Row_lock::lock_release(TxnManager * txn) {
         lock_type = LOCK_NONE;
       }
 
-#else
+      } else {
 
       // Try to find the entry in the owners
       LockEntry * en = owners[hash(txn->get_txn_id())];
@@ -305,18 +352,40 @@ RC Row_lock::lock_release(TxnManager * txn) {
           return_entry(en);
           waiter_cnt --;
       }
-#endif
+      }
 
   if (owner_cnt == 0) ASSERT(lock_type == LOCK_NONE);
-#if DEBUG_ASSERT && CC_ALG == WAIT_DIE
-      for (en = waiters_head; en != NULL && en->next != NULL; en = en->next)
-        assert(en->next->txn->get_timestamp() < en->txn->get_timestamp());
-      for (en = waiters_head; en != NULL && en->next != NULL; en = en->next)
-        assert(en->txn->get_txn_id() !=txn->get_txn_id());
+#if DEBUG_ASSERT
+      if (ALG == WAIT_DIE) {
+        LockEntry * en;
+        for (en = waiters_head; en != NULL && en->next != NULL; en = en->next)
+          assert(en->next->txn->get_timestamp() < en->txn->get_timestamp());
+        for (en = waiters_head; en != NULL && en->next != NULL; en = en->next)
+          assert(en->txn->get_txn_id() !=txn->get_txn_id());
+      }
 #endif
 
+      grant_waiters<ALG>(txn);
+
+      uint64_t timespan = get_sys_clock() - starttime;
+      txn->txn_stats.cc_time += timespan;
+      txn->txn_stats.cc_time_short += timespan;
+      INC_STATS(txn->get_thd_id(),twopl_release_time,timespan);
+      INC_STATS(txn->get_thd_id(),twopl_release_cnt,1);
+
+      if (g_central_man)
+          glob_manager.release_row(_row);
+      else
+          pthread_mutex_unlock( latch );
+
+
+    return RCOK;
+}
+
+// If any waiter can join the owners, just do it!
+template <UInt32 ALG>
+void Row_lock::grant_waiters(TxnManager * txn) {
       LockEntry * entry;
-      // If any waiter can join the owners, just do it!
       while (waiters_head && !conflict_lock(lock_type, waiters_head->type)) {
           LIST_GET_HEAD(waiters_head, waiters_tail, entry);
 #if DEBUG_TIMELINE
@@ -333,14 +402,16 @@ RC Row_lock::lock_release(TxnManager * txn) {
 #endif
           INC_STATS(txn->get_thd_id(),twopl_wait_time,timespan);
 
-#if CC_ALG != NO_WAIT
-          STACK_PUSH(owners[hash(entry->txn->get_txn_id())], entry);
-#endif
+          if (ALG != NO_WAIT) STACK_PUSH(owners[hash(entry->txn->get_txn_id())], entry);
           owner_cnt ++;
           waiter_cnt --;
           if(entry->txn->get_timestamp() > max_owner_ts) {
               max_owner_ts = entry->txn->get_timestamp();
           }
+#if CLV_CC
+          // before the waiter can run on to its commit
+          if (retired) clv_violate(entry->type, entry->txn);
+#endif
           ASSERT(entry->txn->lock_ready == false);
       //if(entry->txn->decr_lr() == 0 && entry->txn->locking_done) {
           if(entry->txn->decr_lr() == 0) {
@@ -361,20 +432,77 @@ RC Row_lock::lock_release(TxnManager * txn) {
           return_entry(entry);
 #endif
       }
+}
 
-      uint64_t timespan = get_sys_clock() - starttime;
-      txn->txn_stats.cc_time += timespan;
-      txn->txn_stats.cc_time_short += timespan;
-      INC_STATS(txn->get_thd_id(),twopl_release_time,timespan);
-      INC_STATS(txn->get_thd_id(),twopl_release_cnt,1);
+#if CLV_CC
+void Row_lock::lock_retire(TxnManager * txn) {
+    if (g_central_man)
+        glob_manager.lock_row(_row);
+    else
+        pthread_mutex_lock( latch );
+    assert(retired == NULL && lock_type == LOCK_EX && owner_cnt == 1);
+#if CC_ALG == NO_WAIT
+    LockEntry * en = get_entry();
+    en->type = LOCK_EX;
+    en->start_ts = own_starttime;
+    en->txn = txn;
+#else
+    LockEntry * en = owners[hash(txn->get_txn_id())];
+    LockEntry * prev = NULL;
+    while (en != NULL && en->txn != txn) {
+        prev = en;
+        en = en->next;
+    }
+    assert(en);
+    if (prev)
+        prev->next = en->next;
+    else
+        owners[hash(txn->get_txn_id())] = en->next;
+#endif
+    DEBUG("retire (%ld,%ld): key %ld %lx\n", txn->get_txn_id(), txn->get_batch_id(),
+          _row->get_primary_key(), (uint64_t)_row);
+    retired = en;
+    owner_cnt --;
+    uint64_t endtime = get_sys_clock();
+    INC_STATS(txn->get_thd_id(),twopl_owned_cnt,1);
+    INC_STATS(txn->get_thd_id(),twopl_owned_time,endtime - own_starttime);
+    INC_STATS(txn->get_thd_id(),twopl_ex_owned_time,endtime - own_starttime);
+    INC_STATS(txn->get_thd_id(),twopl_ex_owned_cnt,1);
+    lock_type = LOCK_NONE;
 
-      if (g_central_man)
-          glob_manager.release_row(_row);
-      else
-          pthread_mutex_unlock( latch );
+    grant_waiters<CC_ALG>(txn);
+
+    if (g_central_man)
+        glob_manager.release_row(_row);
+    else
+        pthread_mutex_unlock( latch );
+}
 
+// called under the latch: txn is granted the row over the retired holder
+void Row_lock::clv_violate(lock_t type, TxnManager * txn) {
+    txn->clv_depend_on(retired->txn);
+    if (type == LOCK_EX) clv_writer = txn;
+    INC_STATS(txn->get_thd_id(),clv_violate_cnt,1);
+}
+#endif
 
-    return RCOK;
+template <UInt32 ALG>
+bool Row_lock::copy_clean(char * dst, uint64_t thd_id) {
+    if (g_central_man)
+        glob_manager.lock_row(_row);
+    else
+        pthread_mutex_lock( latch );
+    bool dirty = owner_cnt > 0 && lock_type == LOCK_EX;
+#if CLV_CC
+    // a retired holder has not committed its write yet
+    dirty = dirty || retired != NULL || clv_writer != NULL;
+#endif
+    if (!dirty) memcpy(dst, _row->get_data(), _row->get_tuple_size());
+    if (g_central_man)
+        glob_manager.release_row(_row);
+    else
+        pthread_mutex_unlock( latch );
+    return !dirty;
 }
 
 bool Row_lock::conflict_lock(lock_t l1, lock_t l2) {
@@ -385,6 +513,7 @@ bool Row_lock::conflict_lock(lock_t l1, lock_t l2) {
     else
         return false;
 }
+#endif
 
 LockEntry * Row_lock::get_entry() {
   LockEntry *entry = (LockEntry *)mem_allocator.alloc(sizeof(LockEntry));
@@ -398,3 +527,321 @@ void Row_lock::return_entry(LockEntry * entry) {
     mem_allocator.free(entry, sizeof(LockEntry));
 }
 
+#if ROW_LOCK_WORD_CC
+static inline bool lw_conflict(uint64_t state, lock_t type) {
+#if TWOPL_LITE
+    return LW_CNT(state) > 0;
+#else
+    return (state & LW_EX) || (type == LOCK_EX && LW_CNT(state) > 0);
+#endif
+}
+
+// one more owner of type
+static inline uint64_t lw_add(uint64_t state, lock_t type) {
+    return (state + 1) | (type == LOCK_EX ? LW_EX : 0);
+}
+
+// one owner less; the last one takes EX along
+static inline uint64_t lw_sub(uint64_t state) {
+    assert(LW_CNT(state) > 0);
+    state--;
+    return LW_CNT(state) == 0 ? state & ~LW_EX : state;
+}
+
+void Row_lock::init(row_t * row) {
+    _row = row;
+#if WAIT_DIE_CC
+    word.state = 0;
+    word.min_ts = 0;
+    wait = NULL;
+#else
+    state = 0;
+#endif
+}
+
+template <UInt32 ALG>
+RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt) {
+    return lock_get<ALG>(type, txn);
+}
+
+#if WAIT_DIE_CC
+static inline bool lw_cas(LockWord * word, LockWord oldval, LockWord newval) {
+    return __sync_bool_compare_and_swap((unsigned __int128 *)word,
+                                        *(unsigned __int128 *)&oldval,
+                                        *(unsigned __int128 *)&newval);
+}
+
+// the owners' bound once txn joins them
+static inline uint64_t lw_min_ts(LockWord word, TxnManager * txn) {
+    if (LW_CNT(word.state) == 0 || txn->get_timestamp() < word.min_ts)
+        return txn->get_timestamp();
+    return word.min_ts;
+}
+#endif
+
+template <UInt32 ALG>
+RC Row_lock::lock_get(lock_t type, TxnManager * txn) {
+    RC rc = RCOK;
+    uint64_t starttime = get_sys_clock();
+#if WAIT_DIE_CC
+    if (ALG == WAIT_DIE) {
+        LockWord o, n;
+        do {
+            // a torn read fails the CAS
+            o = word;
+            if ((o.state & LW_WAIT) || lw_conflict(o.state, type)) {
+                rc = lock_get_slow(type, txn);
+                break;
+            }
+            n.state = lw_add(o.state, type);
+            n.min_ts = lw_min_ts(o, txn);
+        } while (!lw_cas(&word, o, n));
+    }
+#endif
+#if NO_WAIT_CC
+    if (ALG == NO_WAIT) {
+        volatile uint64_t * state = lw_state();
+        uint64_t o;
+        do {
+            o = *state;
+            if (lw_conflict(o, type)) {
+                DEBUG("abort %ld,%ld %ld %lx\n", txn->get_txn_id(), txn->get_batch_id(),
+                      _row->get_primary_key(), (uint64_t)_row);
+                rc = Abort;
+                break;
+            }
+        } while (!ATOM_CAS(*state, o, lw_add(o, type)));
+    }
+#endif
+    uint64_t curr_time = get_sys_clock();
+    uint64_t timespan = curr_time - starttime;
+    if (rc == WAIT && txn->twopl_wait_start == 0) {
+        txn->twopl_wait_start = curr_time;
+    }
+    txn->txn_stats.cc_time += timespan;
+    txn->txn_stats.cc_time_short += timespan;
+    INC_STATS(txn->get_thd_id(),twopl_getlock_time,timespan);
+    INC_STATS(txn->get_thd_id(),twopl_getlock_cnt,1);
+    return rc;
+}
+
+template <UInt32 ALG>
+RC Row_lock::lock_release(TxnManager * txn, row_t * rollback) {
+    uint64_t starttime = get_sys_clock();
+    DEBUG("unlock (%ld,%ld): key %ld %lx\n", txn->get_txn_id(), txn->get_batch_id(),
+          _row->get_primary_key(), (uint64_t)_row);
+    if (rollback) _row->copy(rollback);
+#if WAIT_DIE_CC
+    if (ALG == WAIT_DIE) {
+        LockWord o, n;
+        do {
+            o = word;
+            if (o.state & LW_WAIT) {
+                lock_release_slow(txn->get_thd_id());
+                break;
+            }
+            n.state = lw_sub(o.state);
+            // a bound of the owners is one of the remaining ones
+            n.min_ts = o.min_ts;
+        } while (!lw_cas(&word, o, n));
+    }
+#endif
+#if NO_WAIT_CC
+    if (ALG == NO_WAIT) {
+        volatile uint64_t * state = lw_state();
+        uint64_t o;
+        do {
+            o = *state;
+        } while (!ATOM_CAS(*state, o, lw_sub(o)));
+    }
+#endif
+    uint64_t timespan = get_sys_clock() - starttime;
+    txn->txn_stats.cc_time += timespan;
+    txn->txn_stats.cc_time_short += timespan;
+    INC_STATS(txn->get_thd_id(),twopl_release_time,timespan);
+    INC_STATS(txn->get_thd_id(),twopl_release_cnt,1);
+    return RCOK;
+}
+
+template <UInt32 ALG>
+bool Row_lock::copy_clean(char * dst, uint64_t thd_id) {
+    // joins the owners as a reader for the copy
+#if WAIT_DIE_CC
+    if (ALG == WAIT_DIE) {
+        LockWord o, n;
+        do {
+            o = word;
+            if ((o.state & LW_WAIT) || lw_conflict(o.state, LOCK_SH)) return false;
+            n.state = lw_add(o.state, LOCK_SH);
+            // older than every txn: writers that meet the copy die instead of queueing on it
+            n.min_ts = 0;
+        } while (!lw_cas(&word, o, n));
+        memcpy(dst, _row->get_data(), _row->get_tuple_size());
+        do {
+            o = word;
+            if (o.state & LW_WAIT) {
+                lock_release_slow(thd_id);
+                break;
+            }
+            n.state = lw_sub(o.state);
+            n.min_ts = o.min_ts;
+        } while (!lw_cas(&word, o, n));
+    }
+#endif
+#if NO_WAIT_CC
+    if (ALG == NO_WAIT) {
+        volatile uint64_t * state = lw_state();
+        uint64_t o;
+        do {
+            o = *state;
+            if (lw_conflict(o, LOCK_SH)) return false;
+        } while (!ATOM_CAS(*state, o, lw_add(o, LOCK_SH)));
+        memcpy(dst, _row->get_data(), _row->get_tuple_size());
+        do {
+            o = *state;
+        } while (!ATOM_CAS(*state, o, lw_sub(o)));
+    }
+#endif
+    return true;
+}
+
+#if WAIT_DIE_CC
+LockWaitList * Row_lock::get_wait_list() {
+    if (wait == NULL) {
+        LockWaitList * wl = (LockWaitList *) mem_allocator.alloc(sizeof(LockWaitList));
+        pthread_mutex_init(&wl->latch, NULL);
+        wl->head = NULL;
+        wl->tail = NULL;
+        wl->cnt = 0;
+        if (!ATOM_CAS(wait, (LockWaitList *) NULL, wl)) {
+            pthread_mutex_destroy(&wl->latch);
+            mem_allocator.free(wl, sizeof(LockWaitList));
+        }
+    }
+    return wait;
+}
+
+// under the latch: with WAIT set only the latch holder changes the word
+void Row_lock::set_wait(bool on) {
+    LockWord o, n;
+    do {
+        o = word;
+        n = o;
+        n.state = on ? o.state | LW_WAIT : o.state & ~LW_WAIT;
+    } while (!lw_cas(&word, o, n));
+}
+
+RC Row_lock::lock_get_slow(lock_t type, TxnManager * txn) {
+    RC rc;
+    LockWaitList * wl = get_wait_list();
+    uint64_t mtx_wait_starttime = get_sys_clock();
+    pthread_mutex_lock(&wl->latch);
+    INC_STATS(txn->get_thd_id(),mtx[17],get_sys_clock() - mtx_wait_starttime);
+    set_wait(true);
+    LockWord o = word;
+    if (LW_CNT(o.state) > 0) {
+        INC_STATS(txn->get_thd_id(),twopl_already_owned_cnt,1);
+    }
+    bool conflict = lw_conflict(o.state, type);
+    if (!conflict && wl->head && txn->get_timestamp() < wl->head->txn->get_timestamp()) {
+        conflict = true;
+    }
+    if (!conflict) {
+        LockWord n;
+        n.state = lw_add(o.state, type);
+        n.min_ts = lw_min_ts(o, txn);
+        word = n;
+        if (LW_CNT(o.state) > 0) {
+            INC_STATS(txn->get_thd_id(),twopl_sh_bypass_cnt,1);
+        }
+        rc = RCOK;
+    } else if (LW_CNT(o.state) > 0 && txn->get_timestamp() > o.min_ts) {
+        // younger than one of the owners: die
+        INC_STATS(txn->get_thd_id(), twopl_diff_time, (txn->get_timestamp() - o.min_ts));
+        DEBUG("abort (%ld,%ld): key %ld %lx\n", txn->get_txn_id(), txn->get_batch_id(),
+              _row->get_primary_key(), (uint64_t)_row);
+        rc = Abort;
+    } else {
+        // the waiter list is always in timestamp order
+        LockEntry * entry = get_entry();
+        entry->start_ts = get_sys_clock();
+        entry->txn = txn;
+        entry->type = type;
+        ATOM_CAS(txn->lock_ready,1,0);
+        txn->incr_lr();
+        LockEntry * en = wl->head;
+        while (en != NULL && txn->get_timestamp() < en->txn->get_timestamp()) {
+            en = en->next;
+        }
+        if (en) {
+            LIST_INSERT_BEFORE(en, entry, wl->head);
+        } else {
+            LIST_PUT_TAIL(wl->head, wl->tail, entry);
+        }
+        wl->cnt++;
+        DEBUG("lk_wait (%ld,%ld): key %ld %lx\n", txn->get_txn_id(), txn->get_batch_id(),
+              _row->get_primary_key(), (uint64_t)_row);
+        rc = WAIT;
+    }
+    if (wl->head == NULL) set_wait(false);
+    pthread_mutex_unlock(&wl->latch);
+    return rc;
+}
+
+void Row_lock::lock_release_slow(uint64_t thd_id) {
+    LockWaitList * wl = wait;
+    uint64_t mtx_wait_starttime = get_sys_clock();
+    pthread_mutex_lock(&wl->latch);
+    INC_STATS(thd_id,mtx[18],get_sys_clock() - mtx_wait_starttime);
+    // WAIT may have gone since the fast path saw it
+    LockWord o, n;
+    do {
+        o = word;
+        n = o;
+        n.state = lw_sub(o.state);
+    } while (!lw_cas(&word, o, n));
+
+    // If any waiter can join the owners, just do it!
+    LockEntry * entry;
+    while (wl->head && !lw_conflict(word.state, wl->head->type)) {
+        LIST_GET_HEAD(wl->head, wl->tail, entry);
+        DEBUG("2lock (%ld,%ld): key %ld %lx\n", entry->txn->get_txn_id(),
+              entry->txn->get_batch_id(), _row->get_primary_key(), (uint64_t)_row);
+        do {
+            o = word;
+            n.state = lw_add(o.state, entry->type);
+            n.min_ts = lw_min_ts(o, entry->txn);
+        } while (!lw_cas(&word, o, n));
+        wl->cnt--;
+        uint64_t timespan = get_sys_clock() - entry->txn->twopl_wait_start;
+        entry->txn->twopl_wait_start = 0;
+        entry->txn->txn_stats.cc_block_time += timespan;
+        entry->txn->txn_stats.cc_block_time_short += timespan;
+        INC_STATS(thd_id,twopl_wait_time,timespan);
+        ASSERT(entry->txn->lock_ready == false);
+        if(entry->txn->decr_lr() == 0) {
+            if(ATOM_CAS(entry->txn->lock_ready,false,true)) {
+                txn_table.restart_txn(thd_id, entry->txn->get_txn_id(),
+                                      entry->txn->get_batch_id());
+            }
+        }
+        return_entry(entry);
+    }
+    if (wl->head == NULL) set_wait(false);
+    pthread_mutex_unlock(&wl->latch);
+}
+#endif
+#endif
+
+#define LOCK_CC_INSTANTIATE(ALG)                                                          \
+  template RC Row_lock::lock_get<ALG>(lock_t type, TxnManager * txn);                     \
+  template RC Row_lock::lock_get<ALG>(lock_t type, TxnManager * txn, uint64_t* &txnids,   \
+                                      int &txncnt);                                       \
+  template RC Row_lock::lock_release<ALG>(TxnManager * txn, row_t * rollback);            \
+  template bool Row_lock::copy_clean<ALG>(char * dst, uint64_t thd_id);
+#if CC_ALG_RUNTIME
+LOCK_CC_INSTANTIATE(NO_WAIT)
+LOCK_CC_INSTANTIATE(WAIT_DIE)
+#else
+LOCK_CC_INSTANTIATE(CC_ALG)
+#endif
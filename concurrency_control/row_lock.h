@@ -25,21 +25,92 @@ struct LockEntry {
   LockEntry * prev;
 };
 
+#if ROW_LOCK_WORD_CC
+// [EX][WAIT][owner count]
+#define LW_EX (1UL << 63)
+#define LW_WAIT (1UL << 62)
+#define LW_CNT(state) ((state) & (LW_WAIT - 1))
+
+struct alignas(16) LockWord {
+  uint64_t state;
+  // WAIT_DIE: none of the owners is older
+  uint64_t min_ts;
+};
+
+struct LockWaitList {
+  pthread_mutex_t latch;
+  LockEntry * head;
+  LockEntry * tail;
+  uint32_t cnt;
+};
+#endif
+
+// Calls the instantiation of f for the algorithm of the run. With CC_ALG_RUNTIME it is the
+// one branch on g_cc_alg of a row access; below it every algorithm runs its own code.
+#if CC_ALG_RUNTIME
+#define LOCK_CC_DISPATCH(f, args) return g_cc_alg == WAIT_DIE ? f<WAIT_DIE> args : f<NO_WAIT> args
+#else
+#define LOCK_CC_DISPATCH(f, args) return f<CC_ALG> args
+#endif
+
 class Row_lock {
 public:
 	void init(row_t * row);
 	// [DL_DETECT] txnids are the txn_ids that current txn is waiting for.
-    RC lock_get(lock_t type, TxnManager * txn);
-    RC lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt);
-    RC lock_release(TxnManager * txn);
+    RC lock_get(lock_t type, TxnManager * txn) { LOCK_CC_DISPATCH(lock_get, (type, txn)); }
+    RC lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt) {
+        LOCK_CC_DISPATCH(lock_get, (type, txn, txnids, txncnt));
+    }
+    // rollback: before image to restore, copied under the latch
+    RC lock_release(TxnManager * txn, row_t * rollback = NULL) {
+        LOCK_CC_DISPATCH(lock_release, (txn, rollback));
+    }
+    // copies the tuple unless a writer holds it, i.e. it may carry an uncommitted write
+    bool copy_clean(char * dst, uint64_t thd_id) { LOCK_CC_DISPATCH(copy_clean, (dst, thd_id)); }
+#if CLV_CC
+    // The prepared owner of an exclusive lock gives it up but stays on the row as its
+    // retired holder until it finishes. Txns granted the row meanwhile depend on it.
+    void lock_retire(TxnManager * txn);
+#endif
 
 private:
+	// instantiated in row_lock.cpp for the algorithms of the build
+	template <UInt32 ALG> RC lock_get(lock_t type, TxnManager * txn);
+	template <UInt32 ALG> RC lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt);
+	template <UInt32 ALG> RC lock_release(TxnManager * txn, row_t * rollback);
+	template <UInt32 ALG> bool copy_clean(char * dst, uint64_t thd_id);
+#if ROW_LOCK_WORD_CC
+	/*
+	   The lock is one word. NO_WAIT decides on the word alone; WAIT_DIE keeps the owners'
+	   lower timestamp bound next to it and changes both with one 16-byte CAS. Only a
+	   conflicting request takes the latch of the waiter list, allocated for the rows
+	   that see one: it sets WAIT, which sends every other request and release of the row
+	   to the latch until the list is empty again. A build that runs both keeps the WAIT_DIE
+	   layout; NO_WAIT uses its state word only.
+	*/
+#if WAIT_DIE_CC
+	LockWord word;
+	LockWaitList * wait;
+	RC lock_get_slow(lock_t type, TxnManager * txn);
+	void lock_release_slow(uint64_t thd_id);
+	LockWaitList * get_wait_list();
+	void set_wait(bool on);
+	volatile uint64_t * lw_state() { return (volatile uint64_t *)&word.state; }
+#else
+	volatile uint64_t state;
+	volatile uint64_t * lw_state() { return &state; }
+#endif
+	row_t * _row;
+	LockEntry * get_entry();
+	void 		return_entry(LockEntry * entry);
+#else
     pthread_mutex_t * latch;
 	bool blatch;
 
 	bool 		conflict_lock(lock_t l1, lock_t l2);
 	LockEntry * get_entry();
 	void 		return_entry(LockEntry * entry);
+	template <UInt32 ALG> void grant_waiters(TxnManager * txn);
 	row_t * _row;
   uint64_t hash(uint64_t id) {
     return id % owners_size;
@@ -58,6 +129,16 @@ private:
 	LockEntry * waiters_tail;
   uint64_t max_owner_ts;
   uint64_t own_starttime;
+#endif
+#if CLV_CC
+	void clv_violate(lock_t type, TxnManager * txn);
+	// at most one: a txn granted the row over it cannot retire before it finished
+	LockEntry * retired;
+	// exclusive owner granted over the retired holder, and the before image the holder
+	// left when it aborted under that owner: the owner's rollback restores this one
+	TxnManager * clv_writer;
+	char * clv_image;
+#endif
 };
 
 #endif
@@ -20,19 +20,11 @@ public:
 	void 				release();
 	bool				try_lock();
 	uint64_t 			get_tid();
-#if ATOMIC_WORD
 	void 				assert_lock() {assert(_tid_word & LOCK_BIT); }
-#else
-	void 				assert_lock() { }
-#endif
 
 private:
-#if ATOMIC_WORD
+	// tid with LOCK_BIT on top; readers never take the lock
 	volatile uint64_t	_tid_word;
-#else
- 	pthread_mutex_t * 	_latch;
-	ts_t 				_tid;
-#endif
 	row_t * 			_row;
 };
 
@@ -18,6 +18,7 @@
 #include "txn.h"
 #include "table.h"
 #include "row_wkdb.h"
+#include "rts_cache.h"
 #include "mem_alloc.h"
 #include "manager.h"
 #include "helper.h"
@@ -180,6 +181,9 @@ RC Row_wkdb::commit(access_t type, TxnManager * txn, row_t * data) {
 
 	if (txn_commit_ts > timestamp_last_read)
 		timestamp_last_read = txn_commit_ts;
+#if RTS_CACHE_ENABLE
+	wkdb_rts_cache.add(_row->get_primary_key(), 0, txn_commit_ts);
+#endif
 
 	uncommitted_reads->erase(txn->get_txn_id());
 
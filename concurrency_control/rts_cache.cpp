@@ -7,251 +7,170 @@
 #include "helper.h"
 #include "rts_cache.h"
 #include "mem_alloc.h"
+#include "stats.h"
+#include "sim_manager.h"
 
 void RtsCache::init() {
-  lock_ = (pthread_mutex_t *) 
-		mem_allocator.alloc(sizeof(pthread_mutex_t));
-	pthread_mutex_init(lock_, NULL);
+  shards = (RtsShard *) mem_allocator.align_alloc(sizeof(RtsShard) * RTS_CACHE_SHARD_CNT);
+  for (uint64_t i = 0; i < RTS_CACHE_SHARD_CNT; i++) {
+    shards[i].seq = 0;
+    pthread_mutex_init(&shards[i].latch, NULL);
+    shards[i].cnt = 0;
+  }
+}
+
+// shards touched by [StartKey, EndKey), starting with shard_of(StartKey)
+uint64_t RtsCache::shard_cnt(uint64_t StartKey, uint64_t EndKey) {
+  uint64_t stripes = ((EndKey - 1) >> RTS_CACHE_STRIPE_BITS) - (StartKey >> RTS_CACHE_STRIPE_BITS) + 1;
+  return stripes < RTS_CACHE_SHARD_CNT ? stripes : RTS_CACHE_SHARD_CNT;
 }
 
 RC RtsCache::add(uint64_t StartKey, uint64_t EndKey, uint64_t timestamp){
-  RC ret = RCOK;
-  map<uint64_t,RtsEnt>::iterator it;
-  RtsEnt newent;
-  newent.StartKey = StartKey;
   if (EndKey == 0)
-    newent.EndKey = StartKey + 1;
-  else
-    newent.EndKey = EndKey;
-  newent.rts = timestamp;
+    EndKey = StartKey + 1;
+  uint64_t first = shard_of(StartKey);
+  uint64_t cnt = shard_cnt(StartKey, EndKey);
+  for (uint64_t i = 0; i < cnt; i++) {
+    addShard(&shards[(first + i) % RTS_CACHE_SHARD_CNT], StartKey, EndKey, timestamp);
+  }
+  return RCOK;
+}
 
-  map<uint64_t,RtsEnt>::iterator startIt, endIt;
-  startIt = RtsCaches.lower_bound(newent.StartKey);
-  if (startIt != RtsCaches.begin())
-    startIt--;
-  endIt = RtsCaches.upper_bound(newent.EndKey);
-  if (endIt != RtsCaches.end())
-    endIt++;
+static inline void push_ent(RtsEnt * ents, uint64_t &cnt, uint64_t StartKey, uint64_t EndKey,
+                            uint64_t rts) {
+  if (StartKey >= EndKey)
+    return;
+  if (cnt > 0 && ents[cnt - 1].EndKey == StartKey && ents[cnt - 1].rts == rts) {
+    ents[cnt - 1].EndKey = EndKey;
+    return;
+  }
+  ents[cnt].StartKey = StartKey;
+  ents[cnt].EndKey = EndKey;
+  ents[cnt].rts = rts;
+  cnt++;
+}
 
-  for(it=startIt; it!=endIt;){
-    RtsEnt& rtsent = it->second;
-    if (!newent.getOverlaps(rtsent)) {
-      it++;
-      continue;
+// Merge the two neighbours closest in rts; the gap between them is covered too.
+uint64_t RtsCache::evict(RtsEnt * ents, uint64_t cnt) {
+  assert(cnt > 1);
+  uint64_t victim = 0;
+  uint64_t min_diff = UINT64_MAX;
+  for (uint64_t i = 0; i + 1 < cnt; i++) {
+    uint64_t diff = ents[i].rts > ents[i + 1].rts ? ents[i].rts - ents[i + 1].rts
+                                                  : ents[i + 1].rts - ents[i].rts;
+    if (diff < min_diff) {
+      min_diff = diff;
+      victim = i;
     }
-    int ss = KeyCompare(newent.StartKey, rtsent.StartKey);
-    int ee = KeyCompare(newent.EndKey, rtsent.EndKey);
-
-    if (rtsent.rts < timestamp){
-      // New: ------------
-      // Old: ------------
-      //
-      // New: ------------
-      // Old:
-      if (ss == 0 && ee == 0){
-        rtsent.rts = timestamp;
-        return ret;
-      }
-      // New: ------------
-      // Old:   --------
-      //
-      // New: ------------
-      // Old:
-      else if (ss <= 0 && ee >= 0){
-        RtsCaches.erase(it++);
-      }
-      // New:   --------
-      // Old: ------------
-      //
-      // New:   --------
-      // Old: --        --
-      else if (ss > 0 && ee < 0){
-        uint64_t oldEnd = rtsent.EndKey;
-        rtsent.EndKey = newent.StartKey;
-
-        RtsEnt entl(newent.EndKey, oldEnd, timestamp);
-        RtsCaches.emplace(entl.StartKey, std::move(entl));
-        it++;
-      }
-      // New:     --------          --------
-      // Old: --------      or  ------------
-      //
-      // New:     --------          --------
-      // Old: ----              ----
-      else if (ee >= 0){
-        rtsent.EndKey = newent.StartKey;
-        it++;
-      }
-      // New: --------          --------
-      // Old:     --------  or  ------------
-      //
-      // New: --------          --------
-      // Old:         ----              ----
-      else if (ss <= 0){
-        RtsEnt entr(newent.EndKey, rtsent.EndKey, rtsent.rts);
-        RtsCaches.emplace(entr.StartKey, std::move(entr));
+  }
+  ents[victim].EndKey = ents[victim + 1].EndKey;
+  if (ents[victim + 1].rts > ents[victim].rts)
+    ents[victim].rts = ents[victim + 1].rts;
+  for (uint64_t i = victim + 1; i + 1 < cnt; i++)
+    ents[i] = ents[i + 1];
+  return cnt - 1;
+}
 
-        RtsCaches.erase(it++);
-      }
-      else {
-        // here means that the two range have no overlap.
-      }
+void RtsCache::addShard(RtsShard * shard, uint64_t StartKey, uint64_t EndKey, uint64_t timestamp) {
+  // every old range splits in at most three, plus the gaps around them
+  RtsEnt ents[RTS_CACHE_SHARD_SIZE * 2 + 3];
+  uint64_t cnt = 0;
+  bool changed = false;
+  pthread_mutex_lock(&shard->latch);
+  uint64_t pos = StartKey;
+  for (uint64_t i = 0; i < shard->cnt; i++) {
+    RtsEnt &ent = shard->ents[i];
+    if (ent.EndKey <= StartKey) {
+      push_ent(ents, cnt, ent.StartKey, ent.EndKey, ent.rts);
+      continue;
     }
-    else if (rtsent.rts > timestamp){
-      // Old: -----------      -----------      -----------      -----------
-      // New:    -----     or  -----------  or  --------     or     --------
-      //
-      // Old: -----------      -----------      -----------      -----------
-      // New:
-      if (ss >= 0 && ee <= 0){
-        return ret;
-      }
-      // Old:    ------
-      // New: ------------
-      //
-      // Old:    ------
-      // New: ---      ---
-      else if (ss < 0 && ee > 0){
-        RtsEnt entl(newent.StartKey, rtsent.StartKey, timestamp);
-        RtsCaches.emplace(entl.StartKey, std::move(entl));
-
-        newent.StartKey = rtsent.EndKey;
-        it++;
-      }
-      // Old: --------          --------
-      // New:     --------  or  ------------
-      //
-      // Old: --------          --------
-      // New:         ----              ----
-      else if (ee > 0){
-        newent.StartKey = rtsent.EndKey;
-        it++;
-      }
-      // Old:     --------          --------
-      // New: --------      or  ------------
-      //
-      // Old:     --------          --------
-      // New: ----              ----
-      else if (ss < 0){
-        newent.EndKey = rtsent.StartKey;
-        it++;
-      }
-      else{
-        // here no overlap;
-        it++;
+    if (ent.StartKey >= EndKey) {
+      if (pos < EndKey) {
+        push_ent(ents, cnt, pos, EndKey, timestamp);
+        pos = EndKey;
+        changed = true;
       }
+      push_ent(ents, cnt, ent.StartKey, ent.EndKey, ent.rts);
+      continue;
     }
-    else {
-      if (ss == 0 && ee == 0){
-        // New: ------------
-        // Old: ------------
-        //
-        // New: ------------
-        // Old:
-
-        //do nothing
-        return ret;
-      }
-      else if (ss == 0 && ee > 0){
-        // New: ------------
-        // Old: ----------
-        //
-        // New:           --
-        // Old: ==========
-        newent.StartKey = rtsent.EndKey;
-        it++;
-      }
-      else if (ss < 0 && ee == 0){
-        // New: ------------
-        // Old:   ----------
-        //
-        // New: --
-        // Old:   ==========
-        newent.EndKey = rtsent.StartKey;
-        it++;
-      }
-      else if (ss < 0 && ee > 0){
-        // New: ------------
-        // Old:   --------
-        //
-        // New: --        --
-        // Old:   ========
-        RtsEnt entl(newent.StartKey, rtsent.StartKey, timestamp);
-        RtsCaches.emplace(entl.StartKey, std::move(entl));
-
-        newent.StartKey = rtsent.EndKey;
-        it++;
-      }
-      else if (ss >= 0 && ee <= 0){
-        // New:     ----
-        // Old: ------------
-        //
-        // New:
-        // Old: ------------
-
-        //do nothing
-        return ret;
-      }
-      else if (ee > 0){
-        // New:     --------
-        // Old: --------
-        //
-        // New:         ----
-        // Old: --------
-        newent.StartKey = rtsent.EndKey;
-        it++;
-      }
-      else if (ss < 0){
-        // New: --------
-        // Old:     --------
-        //
-        // New: ----
-        // Old:     ====----
-        newent.EndKey = rtsent.StartKey;
-        it++;
-      }
-      else{
-        //no overlap
-        it++;
-      }
+    uint64_t lo = ent.StartKey > StartKey ? ent.StartKey : StartKey;
+    uint64_t hi = ent.EndKey < EndKey ? ent.EndKey : EndKey;
+    push_ent(ents, cnt, ent.StartKey, lo, ent.rts);
+    if (pos < lo) {
+      push_ent(ents, cnt, pos, lo, timestamp);
+      changed = true;
     }
+    if (ent.rts < timestamp) {
+      push_ent(ents, cnt, lo, hi, timestamp);
+      changed = true;
+    } else {
+      push_ent(ents, cnt, lo, hi, ent.rts);
+    }
+    push_ent(ents, cnt, hi, ent.EndKey, ent.rts);
+    pos = hi;
+  }
+  if (pos < EndKey) {
+    push_ent(ents, cnt, pos, EndKey, timestamp);
+    changed = true;
+  }
+  if (changed) {
+    while (cnt > RTS_CACHE_SHARD_SIZE)
+      cnt = evict(ents, cnt);
+    shard->seq++;
+    COMPILER_BARRIER
+    for (uint64_t i = 0; i < cnt; i++)
+      shard->ents[i] = ents[i];
+    shard->cnt = cnt;
+    COMPILER_BARRIER
+    shard->seq++;
   }
-  RtsCaches.emplace(newent.StartKey, std::move(newent));
-  return ret;
+  pthread_mutex_unlock(&shard->latch);
 }
 
-RC RtsCache::addWithMutex(uint64_t StartKey, uint64_t EndKey, uint64_t timestamp){
-  pthread_mutex_lock(lock_);
-  RC ret = add(StartKey, EndKey, timestamp);
-  pthread_mutex_unlock(lock_);
-  return ret;
+uint64_t RtsCache::getShardRts(RtsShard * shard, uint64_t StartKey, uint64_t EndKey) {
+  while (true) {
+    uint64_t start = shard->seq;
+    COMPILER_BARRIER
+    if (start % 2 == 1) {
+      PAUSE_SILO
+      continue;
+    }
+    // a torn cnt is caught by the seq check below
+    uint64_t cnt = shard->cnt;
+    if (cnt > RTS_CACHE_SHARD_SIZE)
+      cnt = RTS_CACHE_SHARD_SIZE;
+    // first range ending after StartKey
+    uint64_t lo = 0, hi = cnt;
+    while (lo < hi) {
+      uint64_t mid = (lo + hi) / 2;
+      if (shard->ents[mid].EndKey <= StartKey)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    uint64_t rts = 0;
+    for (uint64_t i = lo; i < cnt && shard->ents[i].StartKey < EndKey; i++) {
+      if (shard->ents[i].rts > rts)
+        rts = shard->ents[i].rts;
+    }
+    COMPILER_BARRIER
+    if (shard->seq == start)
+      return rts;
+  }
 }
 
-uint64_t RtsCache::getRts(uint64_t StartKey, uint64_t EndKey){
-  pthread_mutex_lock(lock_);
-  map<uint64_t,RtsEnt>::iterator it;
+uint64_t RtsCache::getRts(uint64_t StartKey, uint64_t EndKey, uint64_t thd_id){
+  uint64_t starttime = get_sys_clock();
+  if (EndKey == 0)
+    EndKey = StartKey + 1;
   uint64_t rts = 0;
-  RtsEnt newent;
-  newent.StartKey = StartKey;
-  if (EndKey ==0)
-    newent.EndKey = StartKey+1;
-  else
-    newent.EndKey = EndKey;
-
-  map<uint64_t,RtsEnt>::iterator startIt, endIt;
-  startIt = RtsCaches.lower_bound(newent.StartKey);
-  if (startIt != RtsCaches.begin())
-    startIt--;
-  endIt = RtsCaches.upper_bound(newent.EndKey);
-  if (endIt != RtsCaches.end())
-    endIt++;
-
-  for(it=startIt;it!=endIt;it++) {
-    RtsEnt rtsent = it->second;
-    if (newent.getOverlaps(rtsent))
-      rts = rtsent.rts;
+  uint64_t first = shard_of(StartKey);
+  uint64_t cnt = shard_cnt(StartKey, EndKey);
+  for (uint64_t i = 0; i < cnt; i++) {
+    uint64_t shard_rts = getShardRts(&shards[(first + i) % RTS_CACHE_SHARD_CNT], StartKey, EndKey);
+    if (shard_rts > rts)
+      rts = shard_rts;
   }
-  pthread_mutex_unlock(lock_);
+  INC_STATS_ARR(thd_id, rts_cache_get_latency, get_sys_clock() - starttime);
   return rts;
 }
-
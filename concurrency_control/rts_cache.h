@@ -20,17 +20,37 @@ public:
   uint64_t rts;
 };
 
+// Disjoint ranges sorted by StartKey. Readers go without the latch and retry
+// if seq changed (odd while a writer copies in a new array).
+struct RtsShard {
+  volatile uint64_t seq;
+  pthread_mutex_t latch;
+  uint64_t cnt;
+  RtsEnt ents[RTS_CACHE_SHARD_SIZE];
+  char _pad[CL_SIZE];
+};
+
+/*
+   Read timestamps of key ranges. Keys are striped over RTS_CACHE_SHARD_CNT
+   shards; a range is recorded in every shard it touches and each shard only
+   answers for its own keys. A full shard merges two neighbouring ranges into
+   one with the larger rts, so getRts may overestimate but never misses a read.
+*/
 class RtsCache {
   public:
     RtsCache() {};
     void init();
     RC add(uint64_t StartKey, uint64_t EndKey, uint64_t timestamp);
-
-    RC addWithMutex(uint64_t StartKey, uint64_t EndKey, uint64_t timestamp);
-    uint64_t getRts(uint64_t StartKey, uint64_t EndKey);
+    uint64_t getRts(uint64_t StartKey, uint64_t EndKey, uint64_t thd_id);
   private:
-    pthread_mutex_t * lock_;
-    std::map<uint64_t,RtsEnt> RtsCaches;
+    static uint64_t shard_of(uint64_t key) {
+      return (key >> RTS_CACHE_STRIPE_BITS) % RTS_CACHE_SHARD_CNT;
+    }
+    uint64_t shard_cnt(uint64_t StartKey, uint64_t EndKey);
+    void addShard(RtsShard * shard, uint64_t StartKey, uint64_t EndKey, uint64_t timestamp);
+    uint64_t getShardRts(RtsShard * shard, uint64_t StartKey, uint64_t EndKey);
+    static uint64_t evict(RtsEnt * ents, uint64_t cnt);
+    RtsShard * shards;
 };
 
 #endif  // !RTS_CACHE
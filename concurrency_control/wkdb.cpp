@@ -22,6 +22,7 @@
 #include "manager.h"
 #include "mem_alloc.h"
 #include "row_wkdb.h"
+#include "rts_cache.h"
 
 wkdb_set_ent::wkdb_set_ent() {
 	set_size = 0;
@@ -75,8 +76,13 @@ RC Wkdb::validate(TxnManager * txn) {
     while(!ATOM_CAS(cur_wrow->manager->wkdb_avail,true,false)) { }
     // pthread_mutex_lock( cur_wrow->manager->latch );
 
-    if (lower <= cur_wrow->manager->timestamp_last_read) {
-      lower = cur_wrow->manager->timestamp_last_read + 1;
+#if RTS_CACHE_ENABLE
+    uint64_t rts = wkdb_rts_cache.getRts(cur_wrow->get_primary_key(), 0, txn->get_thd_id());
+#else
+    uint64_t rts = cur_wrow->manager->timestamp_last_read;
+#endif
+    if (lower <= rts) {
+      lower = rts + 1;
     }
     if (lower >= upper) {
       ATOM_CAS(cur_wrow->manager->wkdb_avail,false,true);
@@ -40,6 +40,9 @@
 
 //InputActionSequenceCreator
 #define INPUT_FILE_PATH "./input.txt"
+// hand generated actions to the clients through a lock-free queue rather than
+// the mutex and condition variables of DABlockQueue
+#define DA_LOCKFREE_QUEUE true
 
 // ! Parameters used to locate distributed performance bottlenecks.
 
@@ -90,6 +93,14 @@
 
 #define LOAD_METHOD LOAD_MAX
 #define LOAD_PER_SERVER 100
+// LOAD_OPEN: open-loop clients. Transactions arrive at LOAD_PER_SERVER per second and
+// server following ARRIVAL_DIST whether or not earlier ones finished, and latency
+// counts from the scheduled arrival. An arrival held back by MAX_TXN_IN_FLIGHT is
+// sent as soon as a slot frees and still timed from its schedule.
+// ARRIVAL_RATE_SCHEDULE: "start_sec:rate,..." changes the per-server rate over the run
+#define ARRIVAL_DIST ARRIVAL_POISSON
+#define ARRIVAL_BURST_LEN 10 // arrivals sharing one instant under ARRIVAL_BURSTY
+#define ARRIVAL_RATE_SCHEDULE ""
 
 #define DETEST 0
 #define REMUS 1
@@ -151,8 +162,20 @@
 #define FIN_BY_TIME true
 #define MAX_TXN_IN_FLIGHT 20000
 #define MAX_TXN_IN_PART 10000
+// cap the local txns running on a server and tune the cap every ADMISSION_EPOCH
+// from throughput, abort rate and work queue delay; new txns over the cap wait
+// in the work queue. ADMISSION_MIN <= cap <= MAX_TXN_IN_FLIGHT * clients
+#define ADMISSION_CONTROL false
+#define ADMISSION_EPOCH 10 * 1000000UL // 10ms
+#define ADMISSION_MIN 4
+#define ADMISSION_ABORT_RATE 0.5 // halve the cap above this abort rate,
+#define ADMISSION_QUEUE_DELAY 1 * 1000000UL // above this avg work queue delay (1ms),
+#define ADMISSION_TOLERANCE 0.05 // or when the last raise lost 5% of the throughput
 
 #define SERVER_GENERATE_QUERIES false
+// run YCSB and TPC-C transactions as resumable bodies (TXN_CO_* in txn.h) instead of
+// re-dispatching through the per-step state machine after every wait
+#define TXN_COROUTINE false
 
 //migartion_alg DETEST REMUS SQUALL LOCK DETEST_SPLIT
 #define MIGRATION_ALG DETEST
@@ -189,6 +212,8 @@
 #define TPORT_TYPE tcp
 #define TPORT_PORT 8100
 #define SET_AFFINITY true
+// per thread class cpu/node policy, see system/placement.h; defaults if the file is missing
+#define PLACEMENT_FILE "placement.txt"
 
 #define MAX_TPORT_NAME 128
 #define MSG_SIZE 128
@@ -197,6 +222,13 @@
 #define NETWORK_TEST false
 #define NETWORK_DELAY_TEST false
 #define NETWORK_DELAY 0UL
+// record the message batches received by a server node in TRACE_DIR, or replay
+// such a trace on one node without network, see transport/msg_trace.h
+#define TRACE_RECORD false
+#define TRACE_REPLAY false
+#define TRACE_DIR "."
+// hand out a recorded batch no earlier than it arrived in the recorded run
+#define TRACE_PACED true
 #define TCP_DELAY_TEST true
 #define TCP_DELAY 500000000UL // in ns = 100ms
 
@@ -207,6 +239,8 @@
 #define MSG_SIZE_MAX 600000
 #define MSG_CHUNK_SIZE 524288 //if msg > MSG_CHUNK_SIZE, SPLIT and SEND
 #define MSG_TIME_LIMIT 0
+// ns an RFIN that needs no answer may wait to leave with the next batch to its node
+#define MSG_FIN_PIGGYBACK 20000
 
 #define SIM_FULL_ROW true
 
@@ -217,6 +251,17 @@
 // WAIT_DIE, NO_WAIT, TIMESTAMP, MVCC, CALVIN, MAAT, WOOKONG, TICTOC, SI
 #define ISOLATION_LEVEL SERIALIZABLE
 #define CC_ALG SSI
+// NO_WAIT, WAIT_DIE: the build runs either one, picked at startup with --cc_alg= (g_cc_alg);
+// CC_ALG is the default. The other CC families, WORKLOAD and MIGRATION_ALG stay compile time.
+#define CC_ALG_RUNTIME false
+// 2PC shortcuts under lock-based CC (NO_WAIT, WAIT_DIE, DL_DETECT): participants that only read
+// skip the prepare round and release at once, a txn with one remote writer commits in one phase
+#define TWOPC_OPT true
+// controlled lock violation (NO_WAIT, WAIT_DIE): a txn releases its locks once it is prepared,
+// a later txn may take them but commits only after the prepared one and aborts with it
+#define CLV false
+// NO_WAIT, WAIT_DIE: row lock state in one atomic word, waiter list only under conflict
+#define ROW_LOCK_WORD true
 #define YCSB_ABORT_MODE false
 #define QUEUE_CAPACITY_NEW 1000000
 // all transactions acquire tuples according to the primary key order.
@@ -255,6 +300,16 @@
 #define TXN_QUEUE_SIZE_LIMIT THREAD_CNT
 // [CALVIN]
 #define SEQ_THREAD_CNT 4
+// lock threads per node; with more than one, rows are sharded across them by key hash
+#define CALVIN_LOCK_THREAD_CNT 1
+// sequencer epochs still running are found through a ring indexed by epoch % depth
+#define SEQ_EPOCH_DEPTH 64
+// messages of the last sealed epoch dispatched per sequencer loop iteration
+#define SEQ_DISPATCH_BATCH 64
+// shrink the batch timer down to SEQ_BATCH_TIMER_MIN while the workers keep
+// up, grow it back up to SEQ_BATCH_TIMER while epochs back up
+#define SEQ_BATCH_ADAPTIVE false
+#define SEQ_BATCH_TIMER_MIN 500 * 1000UL // 0.5ms
 // [TICTOC]
 #define MAX_NUM_WAITS 4
 #define PRE_ABORT true
@@ -263,15 +318,58 @@
 // [SILO]
 #define VALIDATION_LOCK				"no-wait" // no-wait or waiting
 #define PRE_ABORT2					"true"
-#define ATOMIC_WORD					false
+// [SILO, TICTOC] row latch: tries spent spinning before yielding the cpu
+#define LATCH_SPIN_CNT 16
+// [RTS CACHE] (WOOKONG, DTA)
+// validation takes the read timestamps of the written keys from the RtsCache, which
+// commits fill, instead of the rows; keys of different tables share entries, so the
+// bound may be higher than the row's
+#define RTS_CACHE_ENABLE true
+// key ranges are striped over the shards in runs of 2^RTS_CACHE_STRIPE_BITS keys
+#define RTS_CACHE_SHARD_CNT 64
+#define RTS_CACHE_STRIPE_BITS 10
+// ranges kept per shard; past that the two neighbours closest in rts are merged
+#define RTS_CACHE_SHARD_SIZE 128
 /***********************************************/
 // Logging
 /***********************************************/
 #define LOG_COMMAND         false
 #define LOG_REDO          false
 #define LOGGING false
-#define LOG_BUF_MAX 10
+// group commit: an epoch is closed (one fdatasync) after LOG_BUF_TIMEOUT or
+// once LOG_BUF_MAX commits are waiting on it, whichever comes first
+#define LOG_BUF_MAX 1000
 #define LOG_BUF_TIMEOUT 10 * 1000000UL // 10ms
+#define LOG_BUF_SIZE (1UL << 20) // per-worker log buffer half, in bytes
+#define LOG_FILE "logfile.log"
+// replay the tail of LOG_FILE over the last checkpoint before the run starts, so
+// restart takes a checkpoint load plus the log since it; needs CKPT_LOAD. With no
+// checkpoint yet the whole log is replayed over a generated database, which only
+// matches the logged one with a fixed SEED or a SNAPSHOT
+#define LOG_RECOVER false
+#define LOG_RECOVER_THREAD_CNT 4
+// fuzzy checkpoints of the local partitions, one file per partition in CKPT_DIR.
+// Under the locking CCs, which write in place, a row is copied only while no writer
+// holds its lock; HSTORE and HSTORE_SPEC are not supported
+#define CHECKPOINT false
+#define CKPT_DIR "."
+#define CKPT_INTERVAL 10 * 1000000000UL // 10s between two checkpoints
+// rebuild tables and indexes from the last checkpoint instead of generating them
+#define CKPT_LOAD false
+// the checkpointer backs off while more than 1% of commits are slower than
+// CKPT_LATENCY_BOUND, i.e. it keeps the foreground p99 under the bound
+#define CKPT_LATENCY_BOUND 10 * 1000000UL // 10ms
+#define CKPT_CHUNK_SIZE (1UL << 20) // bytes copied between two throttle checks
+// keep the generated database in SNAPSHOT_DIR, one directory per workload
+// parameters, and map it back in instead of regenerating it in later runs
+#define SNAPSHOT false
+#define SNAPSHOT_DIR "."
+// time series of throughput, abort rate, queue depths, message rates and
+// latency percentiles, one line per TS_INTERVAL written by the stat thread
+#define TS_ENABLE false
+#define TS_INTERVAL 100 * 1000000UL // 100ms
+#define TS_FORMAT TS_CSV // TS_CSV or TS_JSON
+#define TS_FILE "stats_ts" // stats_ts_<node>.csv or .json
 
 /***********************************************/
 // Benchmark
@@ -280,6 +378,14 @@
 #define MAX_ROW_PER_TXN     SYNTH_TABLE_SIZE
 #define QUERY_INTVL         1UL
 #define MAX_TXN_PER_PART 500000
+// Clients generate queries on demand into a ring per client thread and server
+// rather than pre-generating MAX_TXN_PER_PART per server. A ring holds at least
+// four times the queries a client can have in flight to a server; a slot is
+// only regenerated once the CL_RSP of its query arrived.
+// CLIENT_QUERY_PREFILL keeps half of each ring generated ahead by a background thread.
+#define CLIENT_QUERY_STREAM true
+#define CLIENT_QUERY_RING 1024
+#define CLIENT_QUERY_PREFILL false
 #define FIRST_PART_LOCAL      false
 #define MAX_TUPLE_SIZE        512 // in bytes
 #define GEN_BY_MPR false
@@ -290,7 +396,24 @@
 #define SKEW_METHOD ZIPF
 #define DATA_PERC (SYNTH_TABLE_SIZE / 64)
 #define ACCESS_PERC 0.3
+// SKEW_SHIFT: move the hot keys during the run, in time since the run start
+//    SHIFT_NONE: the hot keys stay put
+//    SHIFT_DRIFT: the hot keys move by SHIFT_DRIFT_RATE keys per partition and second
+//    SHIFT_JUMP: the hot keys move by SHIFT_JUMP_KEYS keys per partition every SHIFT_INTERVAL
+//    SHIFT_TRACE: phases from SHIFT_TRACE_FILE, one "start_sec offset theta" line each
+// SHIFT_THETA lists the ZIPF_THETA of successive SHIFT_INTERVALs under SHIFT_DRIFT
+// and SHIFT_JUMP, cycled; empty keeps ZIPF_THETA
+#define SKEW_SHIFT SHIFT_NONE
+#define SHIFT_INTERVAL 10 * 1000000000UL // 10s
+#define SHIFT_DRIFT_RATE 1000
+#define SHIFT_JUMP_KEYS (SYNTH_TABLE_SIZE / PART_CNT / 8)
+#define SHIFT_THETA ""
+#define SHIFT_TRACE_FILE "skew_trace.txt"
 #define INIT_PARALLELISM (PART_CNT / NODE_CNT)
+// TPCC and PPS table loaders; 0 starts one thread per online core
+#define LOAD_THREAD_CNT 0
+// index entries a loader thread buffers per index before a bulk insert
+#define LOAD_INDEX_BATCH 4096
 #define SYNTH_TABLE_SIZE 131072 * 128
 #define ZIPF_THETA 0.6
 #define TXN_WRITE_PERC 0.1
@@ -353,7 +476,15 @@ enum DATxnType {
 
 extern TPCCTxnType g_tpcc_txn_type;
 //#define TXN_TYPE          TPCC_ALL
+// transaction mix; new-order takes the remainder
 #define PERC_PAYMENT 0.2
+#define PERC_ORDER_STATUS 0.0
+#define PERC_DELIVERY 0.0
+#define PERC_STOCK_LEVEL 0.0
+// run the standard mix instead of the one above: 43% payment and 4% each of
+// order-status, delivery and stock-level, with 60% of the payment and
+// order-status customers selected by last name (none otherwise)
+#define TPCC_STD_MIX false
 #define FIRSTNAME_MINLEN      8
 #define FIRSTNAME_LEN         16
 #define LASTNAME_LEN        16
@@ -378,6 +509,12 @@ extern TPCCTxnType g_tpcc_txn_type;
 #define PERC_PPS_ORDERPRODUCT 0.6
 #define PERC_PPS_UPDATEPRODUCTPART 0.2
 #define PERC_PPS_UPDATEPART 0.0
+// zipf over the part, supplier and product keys of PPS queries; 0 is uniform
+#define PPS_ZIPF_THETA 0.0
+// chance that a part supplied by a supplier, used by a product or updated with a
+// product lies in the supplier's or product's partition; 0 places parts uniformly,
+// 1 keeps every PPS transaction on one partition
+#define PPS_PART_AFFINITY 0.0
 
 enum PPSTxnType {
   PPS_ALL = 0,
@@ -426,6 +563,9 @@ enum PPSTxnType {
 // INDEX_STRUCT
 #define IDX_HASH 1
 #define IDX_BTREE 2
+// TS_FORMAT
+#define TS_CSV 1
+#define TS_JSON 2
 // WORKLOAD
 #define YCSB 1
 #define TPCC 2
@@ -482,6 +622,11 @@ enum PPSTxnType {
 // SKEW METHODS
 #define ZIPF 1
 #define HOT 2
+// SKEW SHIFTS
+#define SHIFT_NONE 0
+#define SHIFT_DRIFT 1
+#define SHIFT_JUMP 2
+#define SHIFT_TRACE 3
 // PRIORITY WORK QUEUE
 #define PRIORITY_FCFS 1
 #define PRIORITY_ACTIVE 2
@@ -492,6 +637,11 @@ enum PPSTxnType {
 // Load
 #define LOAD_MAX 1
 #define LOAD_RATE 2
+#define LOAD_OPEN 3
+// Open-loop arrivals
+#define ARRIVAL_POISSON 1
+#define ARRIVAL_CONSTANT 2
+#define ARRIVAL_BURSTY 3
 // Transport
 #define TCP 1
 #define IPC 2
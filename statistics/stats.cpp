@@ -24,7 +24,7 @@
 #include "global.h"
 #include "helper.h"
 #include "mem_alloc.h"
-#include "stats_array.h"
+#include "stats_hist.h"
 #include "work_queue.h"
 
 void Stats_thd::init(uint64_t thd_id) {
@@ -57,10 +57,11 @@ void Stats_thd::init(uint64_t thd_id) {
 
 	//all_lat.init(g_max_txn_per_part,ArrIncr);
 
-	client_client_latency.init(g_max_txn_per_part,ArrIncr);
-	last_start_commit_latency.init(g_max_txn_per_part,ArrIncr);
-	first_start_commit_latency.init(g_max_txn_per_part,ArrIncr);
-	start_abort_commit_latency.init(g_max_txn_per_part,ArrIncr);
+	client_client_latency.init();
+	last_start_commit_latency.init();
+	first_start_commit_latency.init();
+	start_abort_commit_latency.init();
+	rts_cache_get_latency.init();
 
     clear();
 
@@ -266,6 +267,9 @@ void Stats_thd::clear() {
   twopl_getlock_time=0;
   twopl_release_cnt=0;
   twopl_release_time=0;
+  clv_violate_cnt=0;
+  clv_wait_cnt=0;
+  clv_cascade_abort_cnt=0;
 
   // Calvin
   seq_txn_cnt=0;
@@ -293,6 +297,14 @@ void Stats_thd::clear() {
   sched_txn_table_time=0;
   sched_epoch_cnt=0;
   sched_epoch_diff=0;
+  sched_shard_txn_cnt=0;
+  sched_shard_lock_time=0;
+  // TPCC
+  tpcc_payment_cnt=0;
+  tpcc_new_order_cnt=0;
+  tpcc_order_status_cnt=0;
+  tpcc_delivery_cnt=0;
+  tpcc_stock_level_cnt=0;
   // DLI_MVCC_OCC
   dli_mvcc_occ_validate_time = 0;
   dli_mvcc_occ_check_cnt = 0;
@@ -359,6 +371,32 @@ void Stats_thd::clear() {
   log_flush_cnt=0;
   log_flush_time=0;
   log_process_time=0;
+  log_write_bytes=0;
+  log_buf_full_cnt=0;
+  log_buf_large_cnt=0;
+  log_commit_cnt=0;
+  log_commit_time=0;
+  log_truncate_cnt=0;
+  log_truncate_bytes=0;
+  log_truncate_time=0;
+
+  // Checkpoint
+  ckpt_cnt=0;
+  ckpt_time=0;
+  ckpt_bytes=0;
+  ckpt_row_cnt=0;
+  ckpt_retry_cnt=0;
+  ckpt_throttle_time=0;
+
+  // Admission control
+  admission_held_cnt=0;
+  admission_adjust_cnt=0;
+  admission_limit_sum=0;
+
+  // Message trace
+  trace_batch_cnt=0;
+  trace_bytes=0;
+  trace_time=0;
 
   // Transaction Table
   txn_table_new_cnt=0;
@@ -432,6 +470,7 @@ void Stats_thd::clear() {
     last_start_commit_latency.clear();
     first_start_commit_latency.clear();
     start_abort_commit_latency.clear();
+    rts_cache_get_latency.clear();
 }
 
 void Stats_thd::print_client(FILE * outf, bool prog) {
@@ -503,36 +542,8 @@ void Stats_thd::print_client(FILE * outf, bool prog) {
           mbuf_send_intv_time / BILLION, mbuf_send_intv_time_avg / BILLION,
           msg_copy_output_time / BILLION);
 
-  if (!prog) {
-  client_client_latency.quicksort(0,client_client_latency.cnt-1);
-  fprintf(outf,
-          ",ccl0=%f"
-          ",ccl1=%f"
-          ",ccl10=%f"
-          ",ccl25=%f"
-          ",ccl50=%f"
-          ",ccl75=%f"
-          ",ccl90=%f"
-          ",ccl95=%f"
-          ",ccl96=%f"
-          ",ccl97=%f"
-          ",ccl98=%f"
-          ",ccl99=%f"
-            ",ccl100=%f",
-            (double)client_client_latency.get_idx(0) / BILLION,
-            (double)client_client_latency.get_percentile(1) / BILLION,
-            (double)client_client_latency.get_percentile(10) / BILLION,
-            (double)client_client_latency.get_percentile(25) / BILLION,
-            (double)client_client_latency.get_percentile(50) / BILLION,
-            (double)client_client_latency.get_percentile(75) / BILLION,
-            (double)client_client_latency.get_percentile(90) / BILLION,
-            (double)client_client_latency.get_percentile(95) / BILLION,
-            (double)client_client_latency.get_percentile(96) / BILLION,
-            (double)client_client_latency.get_percentile(97) / BILLION,
-            (double)client_client_latency.get_percentile(98) / BILLION,
-            (double)client_client_latency.get_percentile(99) / BILLION,
-            (double)client_client_latency.get_idx(client_client_latency.cnt - 1) / BILLION);
-  }
+  // on progress lines this is the window since the previous one
+  client_client_latency.print(outf, "ccl");
 
   // 文件路径
   string filePath = "tpsclient.txt";
@@ -1066,13 +1077,16 @@ void Stats_thd::print(FILE * outf, bool prog) {
     ",twopl_getlock_cnt=%ld"
     ",twopl_getlock_time=%f"
     ",twopl_release_cnt=%ld"
-          ",twopl_release_time=%f\n",
+    ",twopl_release_time=%f"
+    ",clv_violate_cnt=%ld"
+    ",clv_wait_cnt=%ld"
+          ",clv_cascade_abort_cnt=%ld\n",
           twopl_already_owned_cnt, twopl_owned_cnt, twopl_sh_owned_cnt, twopl_ex_owned_cnt,
           twopl_sh_bypass_cnt, twopl_owned_time / BILLION, twopl_sh_owned_time / BILLION,
           twopl_ex_owned_time / BILLION, twopl_sh_owned_avg_time / BILLION,
           twopl_ex_owned_avg_time / BILLION, twopl_diff_time / BILLION, twopl_wait_time / BILLION,
           twopl_getlock_cnt, twopl_getlock_time / BILLION, twopl_release_cnt,
-          twopl_release_time / BILLION);
+          twopl_release_time / BILLION, clv_violate_cnt, clv_wait_cnt, clv_cascade_abort_cnt);
 
   // Calvin
   double seq_queue_wait_avg_time = 0;
@@ -1107,7 +1121,9 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ",sched_idle_time=%f"
   ",sched_txn_table_time=%f"
   ",sched_epoch_cnt=%ld"
-          ",sched_epoch_diff=%f\n",
+  ",sched_epoch_diff=%f"
+  ",sched_shard_txn_cnt=%ld"
+          ",sched_shard_lock_time=%f\n",
           seq_txn_cnt, seq_batch_cnt, seq_full_batch_cnt, seq_ack_time / BILLION,
           seq_batch_time / BILLION, seq_process_cnt, seq_complete_cnt, seq_process_time / BILLION,
           seq_prep_time / BILLION, seq_idle_time / BILLION, seq_queue_wait_time / BILLION,
@@ -1117,7 +1133,20 @@ void Stats_thd::print(FILE * outf, bool prog) {
           sched_queue_wait_avg_time / BILLION, sched_queue_enqueue_time / BILLION,
           sched_queue_dequeue_time / BILLION, calvin_sched_time / BILLION,
           sched_idle_time / BILLION, sched_txn_table_time / BILLION, sched_epoch_cnt,
-          sched_epoch_diff / BILLION);
+          sched_epoch_diff / BILLION, sched_shard_txn_cnt, sched_shard_lock_time / BILLION);
+  // TPCC: tpmC counts the committed new-orders per minute
+  double tpmc = 0;
+  if (total_runtime > 0) tpmc = tpcc_new_order_cnt / (total_runtime / BILLION / 60);
+  fprintf(outf,
+  "[TPCC]\n"
+  ",tpmc=%f"
+  ",tpcc_payment_cnt=%ld"
+  ",tpcc_new_order_cnt=%ld"
+  ",tpcc_order_status_cnt=%ld"
+  ",tpcc_delivery_cnt=%ld"
+          ",tpcc_stock_level_cnt=%ld\n",
+          tpmc, tpcc_payment_cnt, tpcc_new_order_cnt, tpcc_order_status_cnt, tpcc_delivery_cnt,
+          tpcc_stock_level_cnt);
   // DLI_MVCC_OCC
   fprintf(outf,
           ",dli_mvcc_occ_validate_time=%f"
@@ -1209,6 +1238,8 @@ void Stats_thd::print(FILE * outf, bool prog) {
   if (log_write_cnt > 0) log_write_avg_time = log_write_time / log_write_cnt;
   double log_flush_avg_time = 0;
   if (log_flush_cnt > 0) log_flush_avg_time = log_flush_time / log_flush_cnt;
+  double log_commit_avg_time = 0;
+  if (log_commit_cnt > 0) log_commit_avg_time = log_commit_time / log_commit_cnt;
   fprintf(outf,
     ",log_write_cnt=%ld"
     ",log_write_time=%f"
@@ -1216,9 +1247,52 @@ void Stats_thd::print(FILE * outf, bool prog) {
     ",log_flush_cnt=%ld"
     ",log_flush_time=%f"
     ",log_flush_avg_time=%f"
-          ",log_process_time=%f\n",
+          ",log_process_time=%f"
+          ",log_write_bytes=%ld"
+          ",log_buf_full_cnt=%ld"
+          ",log_buf_large_cnt=%ld"
+          ",log_commit_cnt=%ld"
+          ",log_commit_time=%f"
+          ",log_commit_avg_time=%f"
+          ",log_truncate_cnt=%ld"
+          ",log_truncate_bytes=%ld"
+          ",log_truncate_time=%f\n",
           log_write_cnt, log_write_time / BILLION, log_write_avg_time / BILLION, log_flush_cnt,
-          log_flush_time / BILLION, log_flush_avg_time / BILLION, log_process_time / BILLION);
+          log_flush_time / BILLION, log_flush_avg_time / BILLION, log_process_time / BILLION,
+          log_write_bytes, log_buf_full_cnt, log_buf_large_cnt, log_commit_cnt, log_commit_time / BILLION,
+          log_commit_avg_time / BILLION, log_truncate_cnt, log_truncate_bytes,
+          log_truncate_time / BILLION);
+
+  // Checkpoint
+  double ckpt_avg_time = 0;
+  if (ckpt_cnt > 0) ckpt_avg_time = ckpt_time / ckpt_cnt;
+  fprintf(outf,
+          ",ckpt_cnt=%ld"
+          ",ckpt_time=%f"
+          ",ckpt_avg_time=%f"
+          ",ckpt_bytes=%ld"
+          ",ckpt_row_cnt=%ld"
+          ",ckpt_retry_cnt=%ld"
+          ",ckpt_throttle_time=%f\n",
+          ckpt_cnt, ckpt_time / BILLION, ckpt_avg_time / BILLION, ckpt_bytes, ckpt_row_cnt,
+          ckpt_retry_cnt, ckpt_throttle_time / BILLION);
+
+  // Admission control
+  double admission_avg_limit = 0;
+  if (admission_adjust_cnt > 0)
+    admission_avg_limit = (double)admission_limit_sum / admission_adjust_cnt;
+  fprintf(outf,
+          ",admission_held_cnt=%ld"
+          ",admission_adjust_cnt=%ld"
+          ",admission_avg_limit=%f\n",
+          admission_held_cnt, admission_adjust_cnt, admission_avg_limit);
+
+  // Message trace
+  fprintf(outf,
+          ",trace_batch_cnt=%ld"
+          ",trace_bytes=%ld"
+          ",trace_time=%f\n",
+          trace_batch_cnt, trace_bytes, trace_time / BILLION);
 
   // Transaction Table
   double txn_table_get_avg_time = 0;
@@ -1319,106 +1393,14 @@ void Stats_thd::print(FILE * outf, bool prog) {
           ano_3_trans_write_skew_2, ano_2_trans_read_skew, ano_3_trans_read_skew_1,
           ano_3_trans_read_skew_2, ano_4_trans_read_skew, ano_unknown);
 
-  if (!prog) {
-      last_start_commit_latency.quicksort(0,last_start_commit_latency.cnt-1);
-  first_start_commit_latency.quicksort(0,first_start_commit_latency.cnt-1);
-  start_abort_commit_latency.quicksort(0,start_abort_commit_latency.cnt-1);
-
-    fprintf(
-        outf,
-          ",fscl0=%f"
-          ",fscl1=%f"
-          ",fscl10=%f"
-          ",fscl25=%f"
-          ",fscl50=%f"
-          ",fscl75=%f"
-          ",fscl90=%f"
-          ",fscl95=%f"
-          ",fscl96=%f"
-          ",fscl97=%f"
-          ",fscl98=%f"
-          ",fscl99=%f"
-          ",fscl100=%f"
-          ",fscl_avg=%f"
-        ",fscl_cnt=%ld",
-        (double)first_start_commit_latency.get_idx(0) / BILLION,
-        (double)first_start_commit_latency.get_percentile(1) / BILLION,
-        (double)first_start_commit_latency.get_percentile(10) / BILLION,
-        (double)first_start_commit_latency.get_percentile(25) / BILLION,
-        (double)first_start_commit_latency.get_percentile(50) / BILLION,
-        (double)first_start_commit_latency.get_percentile(75) / BILLION,
-        (double)first_start_commit_latency.get_percentile(90) / BILLION,
-        (double)first_start_commit_latency.get_percentile(95) / BILLION,
-        (double)first_start_commit_latency.get_percentile(96) / BILLION,
-        (double)first_start_commit_latency.get_percentile(97) / BILLION,
-        (double)first_start_commit_latency.get_percentile(98) / BILLION,
-        (double)first_start_commit_latency.get_percentile(99) / BILLION,
-        (double)first_start_commit_latency.get_idx(first_start_commit_latency.cnt - 1) / BILLION,
-        (double)first_start_commit_latency.get_avg() / BILLION, first_start_commit_latency.cnt);
-
-  fprintf(outf,
-          ",lscl0=%f"
-          ",lscl1=%f"
-          ",lscl10=%f"
-          ",lscl25=%f"
-          ",lscl50=%f"
-          ",lscl75=%f"
-          ",lscl90=%f"
-          ",lscl95=%f"
-          ",lscl96=%f"
-          ",lscl97=%f"
-          ",lscl98=%f"
-          ",lscl99=%f"
-          ",lscl100=%f"
-          ",lscl_avg=%f"
-            ",lscl_cnt=%ld",
-            (double)last_start_commit_latency.get_idx(0) / BILLION,
-            (double)last_start_commit_latency.get_percentile(1) / BILLION,
-            (double)last_start_commit_latency.get_percentile(10) / BILLION,
-            (double)last_start_commit_latency.get_percentile(25) / BILLION,
-            (double)last_start_commit_latency.get_percentile(50) / BILLION,
-            (double)last_start_commit_latency.get_percentile(75) / BILLION,
-            (double)last_start_commit_latency.get_percentile(90) / BILLION,
-            (double)last_start_commit_latency.get_percentile(95) / BILLION,
-            (double)last_start_commit_latency.get_percentile(96) / BILLION,
-            (double)last_start_commit_latency.get_percentile(97) / BILLION,
-            (double)last_start_commit_latency.get_percentile(98) / BILLION,
-            (double)last_start_commit_latency.get_percentile(99) / BILLION,
-            (double)last_start_commit_latency.get_idx(last_start_commit_latency.cnt - 1) / BILLION,
-            (double)last_start_commit_latency.get_avg() / BILLION, last_start_commit_latency.cnt);
-
-    fprintf(
-        outf,
-          ",sacl0=%f"
-          ",sacl1=%f"
-          ",sacl10=%f"
-          ",sacl25=%f"
-          ",sacl50=%f"
-          ",sacl75=%f"
-          ",sacl90=%f"
-          ",sacl95=%f"
-          ",sacl96=%f"
-          ",sacl97=%f"
-          ",sacl98=%f"
-          ",sacl99=%f"
-          ",sacl100=%f"
-          ",sacl_avg=%f"
-        ",sacl_cnt=%ld",
-        (double)start_abort_commit_latency.get_idx(0) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(1) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(10) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(25) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(50) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(75) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(90) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(95) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(96) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(97) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(98) / BILLION,
-        (double)start_abort_commit_latency.get_percentile(99) / BILLION,
-        (double)start_abort_commit_latency.get_idx(start_abort_commit_latency.cnt - 1) / BILLION,
-        (double)start_abort_commit_latency.get_avg() / BILLION, start_abort_commit_latency.cnt);
+  // on progress lines these are the window since the previous one
+  first_start_commit_latency.print(outf, "fscl");
+  last_start_commit_latency.print(outf, "lscl");
+  start_abort_commit_latency.print(outf, "sacl");
+  // RtsCache::getRts, over the whole run
+  rts_cache_get_latency.print(outf, "rtsl");
 
+  if (!prog) {
     //migration
     fprintf(
       outf,
@@ -1435,15 +1417,30 @@ void Stats_thd::print(FILE * outf, bool prog) {
   //start_abort_commit_latency.print(outf);
 }
 
+// Keep only the latency samples recorded since the previous call. prev holds
+// the running totals of the LAT_HIST_CNT histograms between calls.
+void Stats_thd::window_latency(StatsHist * prev) {
+  StatsHist * hists[LAT_HIST_CNT] = {&client_client_latency, &first_start_commit_latency,
+                                     &last_start_commit_latency, &start_abort_commit_latency};
+  StatsHist * total = new StatsHist;
+  for (uint64_t i = 0; i < LAT_HIST_CNT; i++) {
+    *total = *hists[i];
+    hists[i]->subtract(prev[i]);
+    prev[i] = *total;
+  }
+  delete total;
+}
+
 void Stats_thd::combine(Stats_thd * stats) {
   if (stats->total_runtime > total_runtime) total_runtime = stats->total_runtime;
 
   for (uint i=0;i<TPS_LENGTH;i++) throughput[i]+=stats->throughput[i];  
 
-  last_start_commit_latency.append(stats->first_start_commit_latency);
-  first_start_commit_latency.append(stats->first_start_commit_latency);
-  start_abort_commit_latency.append(stats->start_abort_commit_latency);
-  client_client_latency.append(stats->client_client_latency);
+  last_start_commit_latency.merge(stats->last_start_commit_latency);
+  first_start_commit_latency.merge(stats->first_start_commit_latency);
+  start_abort_commit_latency.merge(stats->start_abort_commit_latency);
+  client_client_latency.merge(stats->client_client_latency);
+  rts_cache_get_latency.merge(stats->rts_cache_get_latency);
   // Execution
   txn_cnt+=stats->txn_cnt;
   remote_txn_cnt+=stats->remote_txn_cnt;
@@ -1634,6 +1631,9 @@ void Stats_thd::combine(Stats_thd * stats) {
   twopl_release_cnt+=stats->twopl_release_cnt;
   twopl_release_time+=stats->twopl_release_time;
   twopl_getlock_time+=stats->twopl_getlock_time;
+  clv_violate_cnt+=stats->clv_violate_cnt;
+  clv_wait_cnt+=stats->clv_wait_cnt;
+  clv_cascade_abort_cnt+=stats->clv_cascade_abort_cnt;
 
   // Calvin
   seq_txn_cnt+=stats->seq_txn_cnt;
@@ -1661,6 +1661,14 @@ void Stats_thd::combine(Stats_thd * stats) {
   sched_txn_table_time+=stats->sched_txn_table_time;
   sched_epoch_cnt+=stats->sched_epoch_cnt;
   sched_epoch_diff+=stats->sched_epoch_diff;
+  sched_shard_txn_cnt+=stats->sched_shard_txn_cnt;
+  sched_shard_lock_time+=stats->sched_shard_lock_time;
+  // TPCC
+  tpcc_payment_cnt+=stats->tpcc_payment_cnt;
+  tpcc_new_order_cnt+=stats->tpcc_new_order_cnt;
+  tpcc_order_status_cnt+=stats->tpcc_order_status_cnt;
+  tpcc_delivery_cnt+=stats->tpcc_delivery_cnt;
+  tpcc_stock_level_cnt+=stats->tpcc_stock_level_cnt;
   // DLI_MVCC_OCC
   dli_mvcc_occ_validate_time += stats->dli_mvcc_occ_validate_time;
   dli_mvcc_occ_check_cnt += stats->dli_mvcc_occ_check_cnt;
@@ -1721,6 +1729,32 @@ void Stats_thd::combine(Stats_thd * stats) {
   log_flush_cnt+=stats->log_flush_cnt;
   log_flush_time+=stats->log_flush_time;
   log_process_time+=stats->log_process_time;
+  log_write_bytes+=stats->log_write_bytes;
+  log_buf_full_cnt+=stats->log_buf_full_cnt;
+  log_buf_large_cnt+=stats->log_buf_large_cnt;
+  log_commit_cnt+=stats->log_commit_cnt;
+  log_commit_time+=stats->log_commit_time;
+  log_truncate_cnt+=stats->log_truncate_cnt;
+  log_truncate_bytes+=stats->log_truncate_bytes;
+  log_truncate_time+=stats->log_truncate_time;
+
+  // Checkpoint
+  ckpt_cnt+=stats->ckpt_cnt;
+  ckpt_time+=stats->ckpt_time;
+  ckpt_bytes+=stats->ckpt_bytes;
+  ckpt_row_cnt+=stats->ckpt_row_cnt;
+  ckpt_retry_cnt+=stats->ckpt_retry_cnt;
+  ckpt_throttle_time+=stats->ckpt_throttle_time;
+
+  // Admission control
+  admission_held_cnt+=stats->admission_held_cnt;
+  admission_adjust_cnt+=stats->admission_adjust_cnt;
+  admission_limit_sum+=stats->admission_limit_sum;
+
+  // Message trace
+  trace_batch_cnt+=stats->trace_batch_cnt;
+  trace_bytes+=stats->trace_bytes;
+  trace_time+=stats->trace_time;
 
   // Transaction Table
   txn_table_new_cnt+=stats->txn_table_new_cnt;
@@ -1810,6 +1844,8 @@ void Stats::init(uint64_t thread_cnt) {
 
   totals->init(0);
   totals->clear();
+  lat_window = new StatsHist[LAT_HIST_CNT];
+  for (uint64_t i = 0; i < LAT_HIST_CNT; i++) lat_window[i].init();
 }
 
 void Stats::clear(uint64_t tid) {}
@@ -1820,6 +1856,7 @@ void Stats::print_client(bool prog) {
 
   totals->clear();
   for (uint64_t i = 0; i < thd_cnt; i++) totals->combine(_stats[i]);
+  if (prog) totals->window_latency(lat_window);
 
 	FILE * outf;
 	if (output_file != NULL)
@@ -1904,6 +1941,7 @@ void Stats::print(bool prog) {
 
   totals->clear();
   for (uint64_t i = 0; i < thd_cnt; i++) totals->combine(_stats[i]);
+  if (prog) totals->window_latency(lat_window);
 	FILE * outf;
 	if (output_file != NULL)
 		outf = fopen(output_file, "w");
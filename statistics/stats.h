@@ -21,7 +21,7 @@
 #include <time.h>
 
 #include "../system/global.h"
-#include "stats_array.h"
+#include "stats_hist.h"
 class StatValue {
 public:
   StatValue() : value(0) {}
@@ -37,6 +37,7 @@ class Stats_thd {
 public:
 	void init(uint64_t thd_id);
 	void combine(Stats_thd * stats);
+	void window_latency(StatsHist * prev);
 	void print(FILE * outf, bool prog);
 	void print_client(FILE * outf, bool prog);
 	void clear();
@@ -251,6 +252,10 @@ public:
   uint64_t twopl_release_cnt;
   double twopl_getlock_time;
   double twopl_release_time;
+  // CLV: grants over a retired lock, votes/commits parked on a dependency, cascading aborts
+  uint64_t clv_violate_cnt;
+  uint64_t clv_wait_cnt;
+  uint64_t clv_cascade_abort_cnt;
 
   // Calvin
   uint64_t seq_txn_cnt;
@@ -278,6 +283,14 @@ public:
   double sched_txn_table_time;
   uint64_t sched_epoch_cnt;
   double sched_epoch_diff;
+  uint64_t sched_shard_txn_cnt;
+  double sched_shard_lock_time;
+  // TPCC: local commits per transaction type
+  uint64_t tpcc_payment_cnt;
+  uint64_t tpcc_new_order_cnt;
+  uint64_t tpcc_order_status_cnt;
+  uint64_t tpcc_delivery_cnt;
+  uint64_t tpcc_stock_level_cnt;
   // DLI_MVCC_OCC
   double dli_mvcc_occ_validate_time;
   uint64_t dli_mvcc_occ_check_cnt;
@@ -349,6 +362,33 @@ public:
   uint64_t log_flush_cnt;
   double log_flush_time;
   double log_process_time;
+  uint64_t log_write_bytes;
+  uint64_t log_buf_full_cnt;
+  uint64_t log_buf_large_cnt;
+  uint64_t log_commit_cnt;
+  double log_commit_time;
+  uint64_t log_truncate_cnt;
+  uint64_t log_truncate_bytes;
+  double log_truncate_time;
+
+  // Checkpoint
+  uint64_t ckpt_cnt;
+  double ckpt_time;
+  uint64_t ckpt_bytes;
+  uint64_t ckpt_row_cnt;
+  // rows found under a writer and copied again
+  uint64_t ckpt_retry_cnt;
+  double ckpt_throttle_time;
+
+  // Admission control
+  uint64_t admission_held_cnt;
+  uint64_t admission_adjust_cnt;
+  uint64_t admission_limit_sum;
+
+  // Message trace
+  uint64_t trace_batch_cnt;
+  uint64_t trace_bytes;
+  double trace_time;
 
   // Transaction Table
   uint64_t txn_table_new_cnt;
@@ -361,10 +401,12 @@ public:
   double txn_table_min_ts_time;
 
   // Latency
-  StatsArr client_client_latency;
-  StatsArr first_start_commit_latency;
-  StatsArr last_start_commit_latency;
-  StatsArr start_abort_commit_latency;
+#define LAT_HIST_CNT 4
+  StatsHist client_client_latency;
+  StatsHist first_start_commit_latency;
+  StatsHist last_start_commit_latency;
+  StatsHist start_abort_commit_latency;
+  StatsHist rts_cache_get_latency;
 
   // stats accumulated
   double lat_work_queue_time;
@@ -438,6 +480,8 @@ public:
 	// PER THREAD statistics
 	Stats_thd ** _stats;
 	Stats_thd * totals;
+	// latency totals at the previous progress print
+	StatsHist * lat_window;
 
 	void init(uint64_t thread_cnt);
 	void clear(uint64_t tid);
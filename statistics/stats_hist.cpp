@@ -0,0 +1,126 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "stats_hist.h"
+
+void StatsHist::init() { clear(); }
+
+void StatsHist::clear() {
+  seq = 0;
+  cnt = 0;
+  sum = 0;
+  min = UINT64_MAX;
+  max = 0;
+  memset(counts, 0, sizeof(counts));
+}
+
+uint64_t StatsHist::get_bucket(uint64_t value) {
+  if (value < HIST_SUB_CNT) return value;
+  uint64_t msb = 63 - __builtin_clzl(value);
+  if (msb >= HIST_MAX_BITS) return HIST_BUCKET_CNT - 1;
+  uint64_t shift = msb - HIST_SUB_BITS;
+  return HIST_SUB_CNT + shift * HIST_SUB_CNT + ((value >> shift) - HIST_SUB_CNT);
+}
+
+// midpoint of the values recorded in the bucket
+uint64_t StatsHist::get_value(uint64_t bucket) {
+  if (bucket < HIST_SUB_CNT) return bucket;
+  uint64_t shift = (bucket - HIST_SUB_CNT) / HIST_SUB_CNT;
+  uint64_t sub = (bucket - HIST_SUB_CNT) % HIST_SUB_CNT;
+  return ((HIST_SUB_CNT + sub) << shift) + ((1UL << shift) >> 1);
+}
+
+void StatsHist::insert(uint64_t value) {
+#if TS_ENABLE
+  seq++;
+  COMPILER_BARRIER
+#endif
+  counts[get_bucket(value)]++;
+  cnt++;
+  sum += value;
+  if (value < min) min = value;
+  if (value > max) max = value;
+#if TS_ENABLE
+  COMPILER_BARRIER
+  seq++;
+#endif
+}
+
+// an insert is a few stores, so the copy is retried until none overlapped it
+void StatsHist::snapshot(StatsHist &out) const {
+  assert(TS_ENABLE);
+  while (true) {
+    uint64_t start = seq;
+    COMPILER_BARRIER
+    if (start % 2 == 1) continue;
+    memcpy(&out, this, sizeof(StatsHist));
+    COMPILER_BARRIER
+    if (seq == start) return;
+  }
+}
+
+void StatsHist::merge(const StatsHist &hist) {
+  if (hist.cnt == 0) return;
+  for (uint64_t i = 0; i < HIST_BUCKET_CNT; i++) counts[i] += hist.counts[i];
+  cnt += hist.cnt;
+  sum += hist.sum;
+  if (hist.min < min) min = hist.min;
+  if (hist.max > max) max = hist.max;
+}
+
+void StatsHist::subtract(const StatsHist &hist) {
+  min = UINT64_MAX;
+  max = 0;
+  for (uint64_t i = 0; i < HIST_BUCKET_CNT; i++) {
+    counts[i] -= hist.counts[i];
+    if (counts[i] == 0) continue;
+    if (min == UINT64_MAX) min = get_value(i);
+    max = get_value(i);
+  }
+  cnt -= hist.cnt;
+  sum -= hist.sum;
+}
+
+uint64_t StatsHist::get_percentile(double ile) {
+  if (cnt == 0) return 0;
+  if (ile <= 0) return min;
+  if (ile >= 100) return max;
+  uint64_t target = (uint64_t)ceil(ile * cnt / 100);
+  if (target == 0) target = 1;
+  uint64_t seen = 0;
+  for (uint64_t i = 0; i < HIST_BUCKET_CNT; i++) {
+    seen += counts[i];
+    if (seen >= target) {
+      uint64_t value = get_value(i);
+      if (value < min) return min;
+      if (value > max) return max;
+      return value;
+    }
+  }
+  return max;
+}
+
+void StatsHist::print(FILE * f, const char * name) {
+  static const double iles[] = {1, 10, 25, 50, 75, 90, 95, 96, 97, 98, 99};
+  fprintf(f, ",%s0=%f", name, (double)get_min() / BILLION);
+  for (uint64_t i = 0; i < sizeof(iles) / sizeof(iles[0]); i++)
+    fprintf(f, ",%s%d=%f", name, (int)iles[i], (double)get_percentile(iles[i]) / BILLION);
+  fprintf(f, ",%s999=%f,%s100=%f,%s_avg=%f,%s_cnt=%ld", name,
+          (double)get_percentile(99.9) / BILLION, name, (double)get_max() / BILLION, name,
+          (double)get_avg() / BILLION, name, cnt);
+}
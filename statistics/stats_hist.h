@@ -0,0 +1,61 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _STATS_HIST_H_
+#define _STATS_HIST_H_
+
+// Log-linear latency histogram (HdrHistogram layout). Values below
+// 2^HIST_SUB_BITS get one bucket each; above that every power of two is split
+// into 2^HIST_SUB_BITS buckets, so a recorded value is off by less than
+// 1/2^HIST_SUB_BITS. The footprint is fixed whatever the run length.
+#define HIST_SUB_BITS 7
+#define HIST_SUB_CNT (1UL << HIST_SUB_BITS)
+// values up to 2^HIST_MAX_BITS ns (~4.9h); larger values land in the last bucket
+#define HIST_MAX_BITS 44
+#define HIST_BUCKET_CNT (HIST_SUB_CNT * (HIST_MAX_BITS - HIST_SUB_BITS + 1))
+
+// Each histogram has a single writer (the thread owning the Stats_thd), so
+// recording is a plain increment. Histograms are merged when printed; other
+// threads read a live histogram through snapshot(), which is guarded by a
+// seqlock bumped around every insert when TS_ENABLE.
+class StatsHist {
+public:
+  void init();
+  void clear();
+  void insert(uint64_t value);
+  void merge(const StatsHist &hist);
+  // remove the samples of an earlier copy of this histogram (time windows)
+  void subtract(const StatsHist &hist);
+  void snapshot(StatsHist &out) const;
+  uint64_t get_percentile(double ile);
+  uint64_t get_min() { return cnt > 0 ? min : 0; }
+  uint64_t get_max() { return max; }
+  uint64_t get_avg() { return cnt > 0 ? sum / cnt : 0; }
+  void print(FILE * f, const char * name);
+
+  uint64_t cnt;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+
+private:
+  volatile uint64_t seq;
+  static uint64_t get_bucket(uint64_t value);
+  static uint64_t get_value(uint64_t bucket);
+  uint64_t counts[HIST_BUCKET_CNT];
+};
+
+#endif
@@ -21,6 +21,22 @@
 
 class table_t;
 
+// one key of an index as returned by index_scan. items is the chain of items
+// stored under the key; nonunique marks keys inserted with index_insert_nonunique.
+struct index_entry_t {
+  idx_key_t key;
+  itemid_t * items;
+  bool nonunique;
+};
+
+// an entry of a bulk index build, see index_insert_bulk
+struct index_load_t {
+  idx_key_t key;
+  itemid_t * item;
+  int part_id;
+  bool nonunique;
+};
+
 class index_base {
 public:
   virtual RC init() {
@@ -41,11 +57,29 @@ public:
 
   virtual RC index_read(idx_key_t key, itemid_t *&item, int part_id = -1, int thd_id = 0) = 0;
 
-	// TODO implement index_remove
-  virtual RC index_remove(idx_key_t key) {
+  // like index_read, but a missing key returns a NULL item instead of asserting
+  virtual RC index_probe(idx_key_t key, itemid_t *&item, int part_id = -1) = 0;
+
+  // insert a batch of entries; entries of the same key keep their relative order
+  virtual RC index_insert_bulk(index_load_t * entries, uint64_t cnt) {
+    for (uint64_t i = 0; i < cnt; i++) {
+      if (entries[i].nonunique)
+        index_insert_nonunique(entries[i].key, entries[i].item, entries[i].part_id);
+      else
+        index_insert(entries[i].key, entries[i].item, entries[i].part_id);
+    }
     return RCOK;
   };
 
+  // fuzzy scan of one partition, no latches are taken
+  virtual RC index_scan(uint64_t part_id, std::vector<index_entry_t> &entries) {
+    return RCOK;
+  };
+
+  // unlink the item pointing to location from the chain of key; the key goes
+  // away with its last item. Readers do not latch, so unlinked items are not freed.
+  virtual RC index_remove(idx_key_t key, void * location, int part_id = -1) = 0;
+
 	// the index in on "table". The key is the merged key of "fields"
 	table_t * 			table;
 };
@@ -75,6 +75,23 @@ bool index_btree::index_exist(idx_key_t key) {
 	return false;
 }
 
+RC index_btree::index_scan(uint64_t part_id, std::vector<index_entry_t> &entries) {
+	if (part_id >= part_cnt) return RCOK;
+	bt_node * c = find_root(part_id)->next;
+	if (c == NULL) return RCOK;
+	while (!c->is_leaf) c = (bt_node *)c->pointers[0];
+	for (; c != NULL; c = c->next) {
+		for (UInt32 i = 0; i < c->num_keys; i++) {
+			index_entry_t entry;
+			entry.key = c->keys[i];
+			entry.items = (itemid_t *)c->pointers[i];
+			entry.nonunique = false;
+			entries.push_back(entry);
+		}
+	}
+	return RCOK;
+}
+
 RC index_btree::index_next(uint64_t thd_id, itemid_t * &item, bool samekey) {
 	int idx = *cur_idx_per_thd[thd_id];
 	bt_node * leaf = *cur_leaf_per_thd[thd_id];
@@ -137,6 +154,59 @@ RC index_btree::index_read(idx_key_t key, itemid_t *&item, int part_id, int thd_
 	return rc;
 }
 
+RC index_btree::index_probe(idx_key_t key, itemid_t *&item, int part_id) {
+	glob_param params;
+	assert(part_id != -1);
+	params.part_id = part_id;
+	bt_node * leaf;
+	find_leaf(params, key, INDEX_READ, leaf);
+	if (leaf == NULL) M_ASSERT(false, "the leaf does not exist!");
+	int idx = leaf_has_key(leaf, key);
+	item = idx >= 0 ? (itemid_t *)leaf->pointers[idx] : NULL;
+	release_latch(leaf);
+	return RCOK;
+}
+
+// Leaves are not merged: a key whose last item goes is shifted out of its leaf,
+// which may be left underfull or empty.
+RC index_btree::index_remove(idx_key_t key, void * location, int part_id) {
+	glob_param params;
+	assert(part_id != -1);
+	params.part_id = part_id;
+	bt_node * leaf = NULL;
+	RC rc;
+	do {
+		rc = find_leaf(params, key, INDEX_READ, leaf);
+		if (rc == RCOK && upgrade_latch(leaf) != RCOK) {
+			release_latch(leaf);
+			rc = Abort;
+		}
+	} while (rc != RCOK);
+
+	int idx = leaf_has_key(leaf, key);
+	itemid_t * prev = NULL;
+	for (itemid_t * it = idx >= 0 ? (itemid_t *)leaf->pointers[idx] : NULL; it != NULL; it = it->next) {
+		if (it->location != location) {
+			prev = it;
+			continue;
+		}
+		if (prev != NULL) {
+			prev->next = it->next;
+		} else if (it->next != NULL) {
+			leaf->pointers[idx] = it->next;
+		} else {
+			for (UInt32 i = idx; i + 1 < leaf->num_keys; i++) {
+				leaf->keys[i] = leaf->keys[i + 1];
+				leaf->pointers[i] = leaf->pointers[i + 1];
+			}
+			leaf->num_keys--;
+		}
+		break;
+	}
+	release_latch(leaf);
+	return RCOK;
+}
+
 RC index_btree::index_insert(idx_key_t key, itemid_t * item, int part_id) {
 	glob_param params;
 	if (WORKLOAD == TPCC) assert(part_id != -1);
@@ -46,11 +46,17 @@ public:
 	RC			init(uint64_t part_cnt, table_t * table);
 	bool 		index_exist(idx_key_t key); // check if the key exist.
 	RC 			index_insert(idx_key_t key, itemid_t * item, int part_id = -1);
-	RC 			index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id = -1) { return RCOK;}
+	// items of a key already in the tree are chained, see insert_into_leaf
+	RC 			index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id = -1) {
+		return index_insert(key, item, part_id);
+	}
  	RC 			index_read(idx_key_t key, itemid_t *&item, int part_id = -1, int thd_id = 0);
 	RC	 		index_read(idx_key_t key, itemid_t * &item, int part_id = -1);
 	RC	 		index_read(idx_key_t key, itemid_t * &item);
+	RC 			index_probe(idx_key_t key, itemid_t * &item, int part_id = -1);
 	RC 			index_next(uint64_t thd_id, itemid_t * &item, bool samekey = false);
+	RC 			index_remove(idx_key_t key, void * location, int part_id = -1);
+	RC 			index_scan(uint64_t part_id, std::vector<index_entry_t> &entries);
 
 private:
 	// index structures may have part_cnt = 1 or PART_CNT.
@@ -18,6 +18,7 @@
 #include "index_hash.h"
 #include "mem_alloc.h"
 #include "row.h"
+#include <algorithm>
 
 RC IndexHash::init(uint64_t bucket_cnt) {
 	_bucket_cnt = bucket_cnt;
@@ -104,6 +105,29 @@ RC IndexHash::index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id
 	return rc;
 }
 
+// The batch is ordered by bucket, so each bucket is latched once per batch.
+RC IndexHash::index_insert_bulk(index_load_t * entries, uint64_t cnt) {
+	std::vector<std::pair<uint64_t, uint64_t> > order(cnt); // (bucket, position in batch)
+	for (uint64_t i = 0; i < cnt; i++) order[i] = std::make_pair(hash(entries[i].key), i);
+	std::sort(order.begin(), order.end());
+	uint64_t i = 0;
+	while (i < cnt) {
+		uint64_t bkt_idx = order[i].first;
+		assert(bkt_idx < _bucket_cnt_per_part);
+		BucketHeader * cur_bkt = &_buckets[0][bkt_idx];
+		get_latch(cur_bkt);
+		for (; i < cnt && order[i].first == bkt_idx; i++) {
+			index_load_t * entry = &entries[order[i].second];
+			if (entry->nonunique)
+				cur_bkt->insert_item_nonunique(entry->key, entry->item, entry->part_id);
+			else
+				cur_bkt->insert_item(entry->key, entry->item, entry->part_id);
+		}
+		release_latch(cur_bkt);
+	}
+	return RCOK;
+}
+
 RC IndexHash::index_read(idx_key_t key, itemid_t * &item, int part_id) {
 	uint64_t bkt_idx = hash(key);
 	assert(bkt_idx < _bucket_cnt_per_part);
@@ -157,6 +181,48 @@ RC IndexHash::index_read(idx_key_t key, itemid_t * &item,
 	return rc;
 }
 
+RC IndexHash::index_probe(idx_key_t key, itemid_t * &item, int part_id) {
+	uint64_t bkt_idx = hash(key);
+	assert(bkt_idx < _bucket_cnt_per_part);
+	BucketHeader * cur_bkt = &_buckets[0][bkt_idx];
+	cur_bkt->probe_item(key, item);
+	return RCOK;
+}
+
+RC IndexHash::index_remove(idx_key_t key, void * location, int part_id) {
+	uint64_t bkt_idx = hash(key);
+	assert(bkt_idx < _bucket_cnt_per_part);
+	BucketHeader * cur_bkt = &_buckets[0][bkt_idx];
+	get_latch(cur_bkt);
+	cur_bkt->remove_item(key, location);
+	release_latch(cur_bkt);
+	return RCOK;
+}
+
+// the buckets are not partitioned, so a partition is the set of rows with that part_id
+RC IndexHash::index_scan(uint64_t part_id, std::vector<index_entry_t> &entries) {
+	for (UInt32 n = 0; n < _bucket_cnt_per_part; n ++) {
+		BucketNode * first = _buckets[0][n].first_node;
+		for (BucketNode * cur_node = first; cur_node != NULL; cur_node = cur_node->next) {
+			if (cur_node->items == NULL ||
+					((row_t *)cur_node->items->location)->get_part_id() % g_part_cnt != part_id)
+				continue;
+			index_entry_t entry;
+			entry.key = cur_node->key;
+			entry.items = cur_node->items;
+			entry.nonunique = false;
+			for (BucketNode * other = first; other != NULL; other = other->next) {
+				if (other != cur_node && other->key == cur_node->key) {
+					entry.nonunique = true;
+					break;
+				}
+			}
+			entries.push_back(entry);
+		}
+	}
+	return RCOK;
+}
+
 /************** BucketHeader Operations ******************/
 
 void BucketHeader::init() {
@@ -254,3 +320,37 @@ void BucketHeader::read_item(idx_key_t key, uint32_t count, itemid_t *&item) {
     assert(cur_node->key == key);
 	item = cur_node->items;
 }
+
+void BucketHeader::probe_item(idx_key_t key, itemid_t *&item) {
+	BucketNode * cur_node = first_node;
+	while (cur_node != NULL && cur_node->key != key) cur_node = cur_node->next;
+	item = cur_node == NULL ? NULL : cur_node->items;
+}
+
+// Only the bucket's writers latch, so the unlinked item and node stay valid for a
+// concurrent reader that already holds them.
+void BucketHeader::remove_item(idx_key_t key, void * location) {
+	BucketNode * prev_node = NULL;
+	for (BucketNode * cur_node = first_node; cur_node != NULL; cur_node = cur_node->next) {
+		if (cur_node->key == key) {
+			itemid_t * prev = NULL;
+			for (itemid_t * it = cur_node->items; it != NULL; it = it->next) {
+				if (it->location != location) {
+					prev = it;
+					continue;
+				}
+				if (prev != NULL) {
+					prev->next = it->next;
+				} else if (it->next != NULL) {
+					cur_node->items = it->next;
+				} else if (prev_node != NULL) {
+					prev_node->next = cur_node->next;
+				} else {
+					first_node = cur_node->next;
+				}
+				return;
+			}
+		}
+		prev_node = cur_node;
+	}
+}
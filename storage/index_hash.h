@@ -48,6 +48,8 @@ public:
 	void insert_item_nonunique(idx_key_t key, itemid_t * item, int part_id);
 	void read_item(idx_key_t key, itemid_t * &item);
 	void read_item(idx_key_t key, uint32_t count, itemid_t * &item);
+	void probe_item(idx_key_t key, itemid_t * &item);
+	void remove_item(idx_key_t key, void * location);
 	BucketNode * 	first_node;
 	uint64_t 		node_cnt;
 	bool 			locked;
@@ -68,17 +70,19 @@ public:
 	bool 		index_exist(idx_key_t key); // check if the key exist.
 	RC 			index_insert(idx_key_t key, itemid_t * item, int part_id=-1);
 	RC 			index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id=-1);
+	RC 			index_insert_bulk(index_load_t * entries, uint64_t cnt);
 	// the following call returns a single item
 	RC	 		index_read(idx_key_t key, itemid_t * &item, int part_id=-1);
 	RC	 		index_read(idx_key_t key, int count, itemid_t * &item, int part_id=-1);
 	RC	 		index_read(idx_key_t key, itemid_t * &item,
 							int part_id=-1, int thd_id=0);
+	RC	 		index_probe(idx_key_t key, itemid_t * &item, int part_id=-1);
+	RC 			index_scan(uint64_t part_id, std::vector<index_entry_t> &entries);
 
 	// the following call returns a list of items
 //	RC 			index_read(idx_key_t key, Link_Item * &li, uint64_t &item_cnt);
 
-	// TODO implement index_remove
-//	RC 			index_remove(idx_key_t key);
+	RC 			index_remove(idx_key_t key, void * location, int part_id=-1);
 
 private:
 //	bool get_latch(BucketHeader * bucket, latch_t latch_type);
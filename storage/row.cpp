@@ -68,7 +68,10 @@ void row_t::init_manager(row_t * row) {
 	return;
 #endif
 	DEBUG_M("row_t::init_manager alloc \n");
-#if CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN
+#if ROW_LOCK_WORD_CC
+	// lock word plus row pointer, not worth a cache line per row
+	manager = (Row_lock *) mem_allocator.alloc(sizeof(Row_lock));
+#elif CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN
 	manager = (Row_lock *) mem_allocator.align_alloc(sizeof(Row_lock));
 #elif CC_ALG == TIMESTAMP
 	manager = (Row_ts *) mem_allocator.align_alloc(sizeof(Row_ts));
@@ -95,7 +98,8 @@ void row_t::init_manager(row_t * row) {
 #elif CC_ALG == CNULL
 	manager = (Row_null *) mem_allocator.align_alloc(sizeof(Row_null));
 #elif CC_ALG == SILO
-    manager = (Row_silo *) mem_allocator.align_alloc(sizeof(Row_silo));
+	// a tid word and the row pointer
+	manager = (Row_silo *) mem_allocator.alloc(sizeof(Row_silo));
 #endif
 
 #if CC_ALG != HSTORE && CC_ALG != HSTORE_SPEC && CC_ALG != TICTOC
@@ -358,7 +362,7 @@ RC row_t::get_row(access_t type, TxnManager *txn, Access *access) {
 		access->data = this;
 	} else if (rc == Abort) {
 	} else if (rc == WAIT) {
-		ASSERT(CC_ALG == WAIT_DIE);
+		ASSERT(g_cc_alg == WAIT_DIE);
 	}
   INC_STATS(txn->get_thd_id(), trans_cur_row_copy_time, get_sys_clock() - copy_time);
 	goto end;
@@ -529,9 +533,9 @@ RC row_t::get_row(access_t type, TxnManager * txn, row_t *& row, uint64_t &orig_
 RC row_t::get_row_post_wait(access_t type, TxnManager * txn, row_t *& row) {
 	RC rc = RCOK;
   uint64_t init_time = get_sys_clock();
-	assert(CC_ALG == WAIT_DIE || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == TIMESTAMP || CC_ALG == TICTOC || CC_ALG == SSI || CC_ALG == WSI || CC_ALG == DTA || CC_ALG == DLI_DTA || CC_ALG == DLI_DTA2 || CC_ALG == DLI_DTA3 ||
+	assert(WAIT_DIE_CC || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == TIMESTAMP || CC_ALG == TICTOC || CC_ALG == SSI || CC_ALG == WSI || CC_ALG == DTA || CC_ALG == DLI_DTA || CC_ALG == DLI_DTA2 || CC_ALG == DLI_DTA3 ||
 				 CC_ALG == TIMESTAMP);
-#if CC_ALG == WAIT_DIE
+#if WAIT_DIE_CC
 	assert(txn->lock_ready);
 	rc = RCOK;
 	//ts_t endtime = get_sys_clock();
@@ -592,11 +596,16 @@ uint64_t row_t::return_row(RC rc, access_t type, TxnManager *txn, row_t *row) {
 */
 #if CC_ALG == WAIT_DIE || CC_ALG == NO_WAIT || CC_ALG == CALVIN
 	assert (row == NULL || row == this || type == XP);
+#if CLV_CC
+	// the rollback is ordered against the txns granted the row over a retired lock
+	this->manager->lock_release(txn, (ROLL_BACK && type == XP) ? row : NULL);
+#else
 	if (CC_ALG != CALVIN && ROLL_BACK &&
 			type == XP) {  // recover from previous writes. should not happen w/ Calvin
 		this->copy(row);
 	}
 	this->manager->lock_release(txn);
+#endif
 	return 0;
 #elif CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == SSI || CC_ALG == WSI
 	// for RD or SCAN or XP, the row should be deleted.
@@ -31,6 +31,22 @@ void table_t::init(Catalog * schema) {
 	// sharing problems
 	char * ptr = new char[CL_SIZE*2 + sizeof(uint64_t)];
 	cur_tab_size = (uint64_t *) &ptr[CL_SIZE];
+	part_rows = NULL;
+	part_latch = NULL;
+}
+
+void table_t::keep_rows() {
+	if (part_rows) return;
+	part_rows = new std::vector<row_t *>[g_part_cnt];
+	part_latch = new pthread_mutex_t[g_part_cnt];
+	for (uint64_t i = 0; i < g_part_cnt; i++) pthread_mutex_init(&part_latch[i], NULL);
+}
+
+void table_t::scan_rows(uint64_t part_id, std::vector<row_t *> &rows) {
+	assert(part_rows && part_id < g_part_cnt);
+	pthread_mutex_lock(&part_latch[part_id]);
+	rows.insert(rows.end(), part_rows[part_id].begin(), part_rows[part_id].end());
+	pthread_mutex_unlock(&part_latch[part_id]);
 }
 
 RC table_t::get_new_row(row_t *& row) {
@@ -57,6 +73,11 @@ RC table_t::get_new_row(row_t *& row, uint64_t part_id, uint64_t &row_id) {
 	row = (row_t *) ptr;
 	rc = row->init(this, part_id, row_id);
 	row->init_manager(row);
+	if (part_rows) {
+		pthread_mutex_lock(&part_latch[part_id]);
+		part_rows[part_id].push_back(row);
+		pthread_mutex_unlock(&part_latch[part_id]);
+	}
 
 	return rc;
 }
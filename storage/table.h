@@ -37,6 +37,13 @@ public:
 
 	void delete_row(); // TODO delete_row is not supportet yet
 
+	// A table no index refers to keeps the rows get_new_row hands out, per
+	// partition, so that checkpoints can copy them. Rows are never dropped.
+	void keep_rows();
+	bool keeps_rows() { return part_rows != NULL; }
+	// appends the rows kept for part_id
+	void scan_rows(uint64_t part_id, std::vector<row_t *> &rows);
+
 	uint64_t get_table_size() { return *cur_tab_size; };
 	Catalog * get_schema() { return schema; };
 	const char * get_table_name() { return table_name; };
@@ -47,7 +54,9 @@ private:
 	const char * 	table_name;
   uint32_t table_id;
 	uint64_t * 		cur_tab_size;
-	char 			pad[CL_SIZE - sizeof(void *)*3 - sizeof(uint32_t)];
+	std::vector<row_t *> * part_rows;
+	pthread_mutex_t * part_latch;
+	char 			pad[CL_SIZE - sizeof(void *)*5 - sizeof(uint32_t)];
 };
 
 #endif
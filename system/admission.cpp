@@ -0,0 +1,104 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "admission.h"
+#include "helper.h"
+#include "mem_alloc.h"
+
+void AdmissionControl::init() {
+  active = 0;
+  // no more than the clients may have in flight here
+  max_limit = std::max((uint64_t)g_inflight_max * g_client_node_cnt, (uint64_t)ADMISSION_MIN);
+  limit = std::min(std::max((uint64_t)g_thread_cnt * 2, (uint64_t)ADMISSION_MIN), max_limit);
+  next_epoch = get_sys_clock() + ADMISSION_EPOCH;
+  held_back = false;
+  cnt = (AdmissionCnt *)mem_allocator.align_alloc(sizeof(AdmissionCnt) * g_thread_cnt);
+  memset(cnt, 0, sizeof(AdmissionCnt) * g_thread_cnt);
+  last_commit_cnt = 0;
+  last_abort_cnt = 0;
+  last_delay_cnt = 0;
+  last_delay_time = 0;
+  last_tput = 0;
+  last_raised = false;
+}
+
+bool AdmissionControl::admit(uint64_t thd_id) {
+  uint64_t cur = active;
+  while (cur < limit) {
+    if (ATOM_CAS(active, cur, cur + 1)) return true;
+    cur = active;
+  }
+  if (!held_back) held_back = true;
+  INC_STATS(thd_id,admission_held_cnt,1);
+  return false;
+}
+
+void AdmissionControl::record_commit(uint64_t thd_id) {
+  if (thd_id < g_thread_cnt) cnt[thd_id].commit_cnt++;
+}
+
+void AdmissionControl::record_abort(uint64_t thd_id) {
+  if (thd_id < g_thread_cnt) cnt[thd_id].abort_cnt++;
+}
+
+void AdmissionControl::record_delay(uint64_t thd_id, uint64_t delay) {
+  if (thd_id >= g_thread_cnt) return;
+  cnt[thd_id].delay_cnt++;
+  cnt[thd_id].delay_time += delay;
+}
+
+void AdmissionControl::adjust(uint64_t thd_id, uint64_t now) {
+  uint64_t epoch_end = next_epoch;
+  if (now < epoch_end || !ATOM_CAS(next_epoch, epoch_end, now + ADMISSION_EPOCH)) return;
+  uint64_t commit_cnt = 0;
+  uint64_t abort_cnt = 0;
+  uint64_t delay_cnt = 0;
+  uint64_t delay_time = 0;
+  for (uint64_t i = 0; i < g_thread_cnt; i++) {
+    commit_cnt += cnt[i].commit_cnt;
+    abort_cnt += cnt[i].abort_cnt;
+    delay_cnt += cnt[i].delay_cnt;
+    delay_time += cnt[i].delay_time;
+  }
+  uint64_t commits = commit_cnt - last_commit_cnt;
+  uint64_t aborts = abort_cnt - last_abort_cnt;
+  uint64_t delays = delay_cnt - last_delay_cnt;
+  double delay = delays > 0 ? (double)(delay_time - last_delay_time) / delays : 0;
+  double abort_rate = commits + aborts > 0 ? (double)aborts / (commits + aborts) : 0;
+  // epochs are ADMISSION_EPOCH long give or take the tick that ends them
+  double tput = (double)commits * BILLION / (now - epoch_end + ADMISSION_EPOCH);
+  last_commit_cnt = commit_cnt;
+  last_abort_cnt = abort_cnt;
+  last_delay_cnt = delay_cnt;
+  last_delay_time = delay_time;
+
+  uint64_t cur = limit;
+  uint64_t next = cur;
+  if (abort_rate > ADMISSION_ABORT_RATE || delay > ADMISSION_QUEUE_DELAY ||
+      (last_raised && tput < last_tput * (1 - ADMISSION_TOLERANCE))) {
+    next = std::max(cur / 2, (uint64_t)ADMISSION_MIN);
+  } else if (held_back) {
+    next = std::min(cur + g_thread_cnt, max_limit);
+  }
+  last_raised = next > cur;
+  last_tput = tput;
+  held_back = false;
+  limit = next;
+  INC_STATS(thd_id,admission_adjust_cnt,1);
+  INC_STATS(thd_id,admission_limit_sum,next);
+  DEBUG("Admission limit %ld -> %ld: tput %f abort rate %f delay %f\n", cur, next, tput,
+        abort_rate, delay);
+}
@@ -0,0 +1,81 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _ADMISSION_H_
+#define _ADMISSION_H_
+
+#include "global.h"
+
+// counters of one worker, summed up by whoever adjusts the limit
+struct AdmissionCnt {
+  volatile uint64_t commit_cnt;
+  volatile uint64_t abort_cnt;
+  volatile uint64_t delay_cnt;
+  volatile uint64_t delay_time;
+  char _pad[CL_SIZE - sizeof(uint64_t) * 4];
+};
+
+/*
+   Admission control of new local transactions. A CL_QRY is only taken out of
+   new_txn_queue while fewer than limit transactions started here are still
+   running; the rest wait in the queue. Every ADMISSION_EPOCH the worker that
+   notices the epoch is over moves the limit, AIMD style:
+   - divided by 2 when the abort rate is above ADMISSION_ABORT_RATE, when the
+     work queue delay of running transactions is above ADMISSION_QUEUE_DELAY,
+     or when the last increase cost more than ADMISSION_TOLERANCE of the
+     throughput (past the knee);
+   - raised by one per worker when transactions were held back during the
+     epoch, i.e. the limit is what keeps throughput down.
+*/
+class AdmissionControl {
+public:
+  void init();
+  // try to start one more transaction; false if it has to stay queued
+  bool admit(uint64_t thd_id);
+  // a transaction admitted by admit ended, or the queue turned out to be empty;
+  // once per admit
+  void release() {
+    assert(active > 0);
+    ATOM_SUB(active, 1);
+  }
+  void record_commit(uint64_t thd_id);
+  void record_abort(uint64_t thd_id);
+  void record_delay(uint64_t thd_id, uint64_t delay);
+  // adjust the limit if the epoch is over
+  void tick(uint64_t thd_id, uint64_t now) {
+    if (now >= next_epoch) adjust(thd_id, now);
+  }
+  uint64_t get_limit() { return limit; }
+
+private:
+  void adjust(uint64_t thd_id, uint64_t now);
+
+  volatile uint64_t active;
+  volatile uint64_t limit;
+  volatile uint64_t next_epoch;
+  volatile bool held_back; // a transaction was kept queued this epoch
+  uint64_t max_limit;
+  AdmissionCnt * cnt;
+  // totals at the end of the last epoch
+  uint64_t last_commit_cnt;
+  uint64_t last_abort_cnt;
+  uint64_t last_delay_cnt;
+  uint64_t last_delay_time;
+  double last_tput;
+  bool last_raised;
+};
+
+#endif
@@ -0,0 +1,515 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+/*
+   Microbenchmarks of the engine building blocks, in one process on one node:
+
+     ./runbench [--bench=a,b,...] [--threads=1,2,4,8] [--ops=N] [--csv=FILE] [rundb flags]
+
+   Every benchmark runs once per thread count; each thread does ops operations
+   on its own keys, so the numbers show the uncontended path plus whatever the
+   structure shares internally. One CSV line per run goes to stdout, or is
+   appended to FILE. Benchmarks that touch rows or transactions use the
+   compiled CC_ALG and WORKLOAD; the row benchmarks read and write the YCSB
+   table or the TPC-C item table. Run them with -n1 so every key is local.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "manager.h"
+#include "mem_alloc.h"
+#include "message.h"
+#include "msg_queue.h"
+#include "query.h"
+#include "sim_manager.h"
+#include "txn.h"
+#include "txn_table.h"
+#include "work_queue.h"
+#include "index_btree.h"
+#include "index_hash.h"
+#include "ycsb.h"
+#include "tpcc.h"
+#include "pps.h"
+#include "da.h"
+#include "client_query.h"
+#include "maat.h"
+#include "ssi.h"
+#include "wsi.h"
+#include "wkdb.h"
+#include "tictoc.h"
+#include "dta.h"
+#include "dli.h"
+#include "occ.h"
+#include "focc.h"
+#include "bocc.h"
+#include "admission.h"
+#include "rts_cache.h"
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+
+void parser(int argc, char * argv[]);
+
+struct Bench {
+  const char * name;
+  // single threaded, before the timed part
+  void (*setup)(uint64_t thd_cnt, uint64_t ops);
+  // ops operations by thread thd_id of thd_cnt
+  void (*run)(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops);
+  bool needs_engine;
+};
+
+static Workload * bench_wl = NULL;
+static pthread_barrier_t bench_bar;
+
+// The database, pools, queues and CC managers, as main sets them up.
+static void init_engine() {
+  if (bench_wl) return;
+  glob_manager.init();
+  simulation = new SimManager;
+  simulation->init();
+  switch (WORKLOAD) {
+    case YCSB:
+      bench_wl = new YCSBWorkload;
+      break;
+    case TPCC:
+      bench_wl = new TPCCWorkload;
+      break;
+    case PPS:
+      bench_wl = new PPSWorkload;
+      break;
+    case DA:
+      bench_wl = new DAWorkload;
+      break;
+    default:
+      assert(false);
+  }
+  bench_wl->init();
+  work_queue.init();
+#if ADMISSION_CC
+  admission.init();
+#endif
+  msg_queue.init();
+  txn_man_pool.init(bench_wl, 0);
+  txn_pool.init(bench_wl, 0);
+  row_pool.init(bench_wl, 0);
+  access_pool.init(bench_wl, 0);
+  txn_table_pool.init(bench_wl, 0);
+  qry_pool.init(bench_wl, 0);
+  msg_pool.init(bench_wl, 0);
+  txn_table.init();
+#if CC_ALG == MAAT
+  time_table.init();
+  maat_man.init();
+#elif CC_ALG == SSI
+  inout_table.init();
+  ssi_man.init();
+#elif CC_ALG == WSI
+  wsi_man.init();
+#elif CC_ALG == WOOKONG
+  wkdb_time_table.init();
+#if RTS_CACHE_ENABLE
+  wkdb_rts_cache.init();
+#endif
+  wkdb_man.init();
+#elif CC_ALG == TICTOC
+  tictoc_man.init();
+#elif CC_ALG == DTA || CC_ALG == DLI_DTA || CC_ALG == DLI_DTA2 || CC_ALG == DLI_DTA3
+  dta_time_table.init();
+#if RTS_CACHE_ENABLE
+  dta_rts_cache.init();
+#endif
+  dta_man.init();
+#elif CC_ALG == OCC
+  occ_man.init();
+#elif CC_ALG == BOCC
+  bocc_man.init();
+#elif CC_ALG == FOCC
+  focc_man.init();
+#endif
+#if CC_ALG == DLI_BASE || CC_ALG == DLI_OCC || CC_ALG == DLI_MVCC_OCC || CC_ALG == DLI_DTA || \
+    CC_ALG == DLI_DTA2 || CC_ALG == DLI_DTA3 || CC_ALG == DLI_MVCC
+  dli_man.init();
+#endif
+}
+
+// i-th key of thread thd_id; keys of different threads never collide
+static inline uint64_t bench_key(uint64_t thd_id, uint64_t thd_cnt, uint64_t i) {
+  return i * thd_cnt + thd_id;
+}
+
+/**************************************/
+// Indexes
+/**************************************/
+static IndexHash * bench_hash = NULL;
+static itemid_t * bench_items = NULL;
+
+static void alloc_items(uint64_t cnt) {
+  if (bench_items) free(bench_items);
+  bench_items = (itemid_t *)calloc(cnt, sizeof(itemid_t));
+}
+
+static void hash_setup(uint64_t thd_cnt, uint64_t ops) {
+  if (bench_hash)
+    bench_hash->index_delete();
+  else
+    bench_hash = new IndexHash;
+  bench_hash->init(thd_cnt * ops);
+  alloc_items(thd_cnt * ops);
+}
+
+static void hash_insert(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    uint64_t key = bench_key(thd_id, thd_cnt, i);
+    bench_hash->index_insert(key, &bench_items[key], 0);
+  }
+}
+
+static void hash_read_setup(uint64_t thd_cnt, uint64_t ops) {
+  hash_setup(thd_cnt, ops);
+  for (uint64_t t = 0; t < thd_cnt; t++) hash_insert(t, thd_cnt, ops);
+}
+
+static void hash_read(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  itemid_t * item;
+  for (uint64_t i = 0; i < ops; i++) {
+    RC rc = bench_hash->index_read(bench_key(thd_id, thd_cnt, i), item, 0, thd_id);
+    assert(rc == RCOK);
+    (void)rc;
+  }
+}
+
+static index_btree * bench_btree = NULL;
+static itemid_t * btree_items = NULL;
+static uint64_t btree_keys = 0;
+static uint64_t btree_thd_cnt = 1;
+
+// One tree serves every run, with a partition per thread: btree inserts latch
+// the path from the root. There is no index_btree teardown, so a run first
+// removes the keys of the one before.
+static void btree_setup(uint64_t thd_cnt, uint64_t ops) {
+  if (!bench_btree) {
+    bench_btree = new index_btree;
+    bench_btree->init(g_thread_cnt);
+  }
+  for (uint64_t key = 0; key < btree_keys; key++)
+    bench_btree->index_remove(key, btree_items[key].location, key % btree_thd_cnt);
+  if (btree_items) free(btree_items);
+  btree_items = (itemid_t *)calloc(thd_cnt * ops, sizeof(itemid_t));
+  btree_keys = thd_cnt * ops;
+  btree_thd_cnt = thd_cnt;
+}
+
+static void btree_insert(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    uint64_t key = bench_key(thd_id, thd_cnt, i);
+    bench_btree->index_insert(key, &btree_items[key], thd_id);
+  }
+}
+
+static void btree_read_setup(uint64_t thd_cnt, uint64_t ops) {
+  btree_setup(thd_cnt, ops);
+  for (uint64_t t = 0; t < thd_cnt; t++) btree_insert(t, thd_cnt, ops);
+}
+
+static void btree_read(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  itemid_t * item;
+  for (uint64_t i = 0; i < ops; i++) {
+    RC rc = bench_btree->index_read(bench_key(thd_id, thd_cnt, i), item, thd_id, thd_id);
+    assert(rc == RCOK);
+    (void)rc;
+  }
+}
+
+/**************************************/
+// Queues
+/**************************************/
+static void no_setup(uint64_t thd_cnt, uint64_t ops) {}
+
+// One message per thread. A thread may dequeue another thread's message, so
+// they live until the next run.
+static std::vector<Message *> bench_msgs;
+
+static void queue_setup(uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < bench_msgs.size(); i++) Message::release_message(bench_msgs[i]);
+  bench_msgs.clear();
+  for (uint64_t i = 0; i < thd_cnt; i++) {
+    Message * msg = Message::create_message(RTXN_CONT);
+    msg->txn_id = i;
+    bench_msgs.push_back(msg);
+  }
+}
+
+// enqueue + dequeue pairs
+static void work_queue_run(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    work_queue.enqueue(thd_id, bench_msgs[thd_id], false);
+    while (!work_queue.dequeue(thd_id)) {
+    }
+  }
+}
+
+// Every thread enqueues, then the send queues are drained, each by the thread
+// with its index modulo thd_cnt.
+static void msg_queue_run(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) msg_queue.enqueue(thd_id, bench_msgs[thd_id], g_node_id);
+  pthread_barrier_wait(&bench_bar);
+  Message * msg;
+  for (uint64_t q = thd_id; q < g_this_send_thread_cnt; q += thd_cnt) {
+    while (msg_queue.dequeue(q, msg) != UINT64_MAX) {
+    }
+  }
+  pthread_barrier_wait(&bench_bar);
+}
+
+/**************************************/
+// Transactions and rows
+/**************************************/
+static void txn_table_run(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    uint64_t txn_id = bench_key(thd_id, thd_cnt, i) * g_node_cnt + g_node_id;
+    TxnManager * txn_man = txn_table.get_transaction_manager(thd_id, txn_id, 0);
+    assert(txn_man);
+    (void)txn_man;
+    txn_table.release_transaction_manager(thd_id, txn_id, 0);
+  }
+}
+
+// One single-row transaction per op through the CC access and cleanup paths.
+static void row_access(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops, access_t type) {
+#if WORKLOAD == YCSB
+  INDEX * index = ((YCSBWorkload *)bench_wl)->the_index;
+  uint64_t key_cnt = g_synth_table_size / thd_cnt;
+#elif WORKLOAD == TPCC
+  // items are keyed from 1 and all loaded into partition 0
+  INDEX * index = ((TPCCWorkload *)bench_wl)->i_item;
+  uint64_t key_cnt = g_max_items / thd_cnt;
+#else
+  M_ASSERT_V(false, "the row benchmarks run on YCSB or TPCC\n");
+  INDEX * index = NULL;
+  uint64_t key_cnt = 0;
+#endif
+  uint64_t aborts = 0;
+  for (uint64_t i = 0; i < ops; i++) {
+    uint64_t key = bench_key(thd_id, thd_cnt, i % key_cnt);
+    itemid_t * item;
+#if WORKLOAD == TPCC
+    key += 1;
+    RC rc = index->index_read(key, item, 0, thd_id);
+#else
+    RC rc = index->index_read(key, item, key_to_part(key), thd_id);
+#endif
+    M_ASSERT_V(rc == RCOK, "key %ld is not local, run with -n1\n", key);
+    uint64_t txn_id = bench_key(thd_id, thd_cnt, i) * g_node_cnt + g_node_id;
+    TxnManager * txn_man = txn_table.get_transaction_manager(thd_id, txn_id, 0);
+    txn_man->set_timestamp(glob_manager.get_ts(thd_id));
+    row_t * row;
+    rc = txn_man->get_row((row_t *)item->location, type, row);
+    if (rc != RCOK) aborts++;
+    txn_man->release_locks(rc == RCOK ? RCOK : Abort);
+    txn_table.release_transaction_manager(thd_id, txn_id, 0);
+  }
+  if (aborts > 0) printf("thd %ld: %ld of %ld accesses did not get the row\n", thd_id, aborts, ops);
+}
+
+static void row_read(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  row_access(thd_id, thd_cnt, ops, RD);
+}
+
+static void row_write(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  row_access(thd_id, thd_cnt, ops, WR);
+}
+
+/**************************************/
+// Read timestamp cache
+/**************************************/
+static RtsCache * bench_rts = NULL;
+
+// The shards stay bounded, so one cache serves every run. getRts records its
+// latency in the stats (rtsl), which needs the engine's SimManager.
+static void rts_setup(uint64_t thd_cnt, uint64_t ops) {
+  if (bench_rts) return;
+  bench_rts = new RtsCache;
+  bench_rts->init();
+}
+
+// single-key ranges with growing timestamps, as DTA and WOOKONG commits add them
+static void rts_add(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) bench_rts->add(bench_key(thd_id, thd_cnt, i), 0, i + 1);
+}
+
+static void rts_get_setup(uint64_t thd_cnt, uint64_t ops) {
+  rts_setup(thd_cnt, ops);
+  for (uint64_t i = 0; i < thd_cnt * ops; i++) bench_rts->add(i, 0, i + 1);
+}
+
+static void rts_get(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) bench_rts->getRts(bench_key(thd_id, thd_cnt, i), 0, thd_id);
+}
+
+/**************************************/
+// Messages
+/**************************************/
+// size, serialize and parse back a client query
+static void msg_serialize(uint64_t thd_id, uint64_t thd_cnt, uint64_t ops) {
+  QueryGenerator * gen = client_query_queue.create_generator(thd_id);
+  BaseQuery * query = gen->create_query(bench_wl, g_node_id);
+  Message * msg = Message::create_message(query, CL_QRY);
+  std::vector<char> buf(msg->get_size());
+  for (uint64_t i = 0; i < ops; i++) {
+    uint64_t size = msg->get_size();
+    if (size > buf.size()) buf.resize(size);
+    msg->copy_to_buf(buf.data());
+    Message * copy = Message::create_message(buf.data());
+    Message::release_message(copy);
+  }
+  Message::release_message(msg);
+  delete gen;
+}
+
+static Bench benches[] = {
+    {"index_hash_insert", hash_setup, hash_insert, false},
+    {"index_hash_read", hash_read_setup, hash_read, false},
+    {"index_btree_insert", btree_setup, btree_insert, false},
+    {"index_btree_read", btree_read_setup, btree_read, false},
+    {"work_queue", queue_setup, work_queue_run, true},
+    {"msg_queue", queue_setup, msg_queue_run, true},
+    {"txn_table", no_setup, txn_table_run, true},
+    {"row_read", no_setup, row_read, true},
+    {"row_write", no_setup, row_write, true},
+    {"rts_cache_add", rts_setup, rts_add, true},
+    {"rts_cache_get", rts_get_setup, rts_get, true},
+    {"msg_serialize", no_setup, msg_serialize, true},
+    {NULL, NULL, NULL, false}};
+
+struct bench_args {
+  Bench * bench;
+  uint64_t thd_id;
+  uint64_t thd_cnt;
+  uint64_t ops;
+};
+
+static void * run_bench(void * a) {
+  bench_args * args = (bench_args *)a;
+  pthread_barrier_wait(&bench_bar);
+  args->bench->run(args->thd_id, args->thd_cnt, args->ops);
+  return NULL;
+}
+
+// wall time of ops operations on each of thd_cnt threads
+static double time_bench(Bench * bench, uint64_t thd_cnt, uint64_t ops) {
+  bench->setup(thd_cnt, ops);
+  std::vector<pthread_t> thds(thd_cnt);
+  std::vector<bench_args> args(thd_cnt);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_barrier_init(&bench_bar, NULL, thd_cnt + 1);
+  for (uint64_t i = 0; i < thd_cnt; i++) {
+#if SET_AFFINITY
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(i, &cpus);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+#endif
+    args[i].bench = bench;
+    args[i].thd_id = i;
+    args[i].thd_cnt = thd_cnt;
+    args[i].ops = ops;
+    pthread_create(&thds[i], &attr, run_bench, &args[i]);
+  }
+  pthread_barrier_wait(&bench_bar);
+  uint64_t starttime = get_sys_clock();
+  // msg_queue has two more phases
+  if (bench->run == msg_queue_run) {
+    pthread_barrier_wait(&bench_bar);
+    pthread_barrier_wait(&bench_bar);
+  }
+  for (uint64_t i = 0; i < thd_cnt; i++) pthread_join(thds[i], NULL);
+  uint64_t endtime = get_sys_clock();
+  pthread_barrier_destroy(&bench_bar);
+  pthread_attr_destroy(&attr);
+  return (double)(endtime - starttime) / BILLION;
+}
+
+static void parse_list(const char * list, std::vector<std::string> &out) {
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    if (!item.empty()) out.push_back(item);
+}
+
+int main(int argc, char * argv[]) {
+  std::vector<std::string> names;
+  std::vector<std::string> thd_list;
+  uint64_t ops = 200000;
+  const char * csv_file = NULL;
+  // strip our flags, the rest goes to the usual parser
+  std::vector<char *> rest;
+  rest.push_back(argv[0]);
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--bench=", 8) == 0)
+      parse_list(&argv[i][8], names);
+    else if (strncmp(argv[i], "--threads=", 10) == 0)
+      parse_list(&argv[i][10], thd_list);
+    else if (strncmp(argv[i], "--ops=", 6) == 0)
+      ops = strtoull(&argv[i][6], NULL, 10);
+    else if (strncmp(argv[i], "--csv=", 6) == 0)
+      csv_file = &argv[i][6];
+    else
+      rest.push_back(argv[i]);
+  }
+  rest.push_back(NULL);
+  parser(rest.size() - 1, rest.data());
+  if (thd_list.empty()) parse_list("1,2,4,8", thd_list);
+  std::vector<uint64_t> thd_cnts;
+  for (uint64_t i = 0; i < thd_list.size(); i++) {
+    uint64_t cnt = strtoull(thd_list[i].c_str(), NULL, 10);
+    M_ASSERT_V(cnt > 0 && cnt <= g_thread_cnt, "%ld threads, THREAD_CNT is %d (raise it with -t)\n",
+               cnt, g_thread_cnt);
+    thd_cnts.push_back(cnt);
+  }
+
+  std::vector<Bench *> selected;
+  for (Bench * b = benches; b->name; b++) {
+    if (names.empty() || std::find(names.begin(), names.end(), b->name) != names.end())
+      selected.push_back(b);
+  }
+  M_ASSERT_V(!selected.empty(), "no benchmark matches --bench\n");
+
+  stats.init(g_total_thread_cnt);
+  for (uint64_t i = 0; i < selected.size(); i++)
+    if (selected[i]->needs_engine) init_engine();
+
+  FILE * out = stdout;
+  bool header = true;
+  if (csv_file) {
+    header = access(csv_file, F_OK) != 0;
+    out = fopen(csv_file, "a");
+    M_ASSERT_V(out, "cannot open %s\n", csv_file);
+  }
+  if (header) fprintf(out, "bench,cc_alg,workload,threads,ops,seconds,mops,ns_per_op\n");
+  for (uint64_t b = 0; b < selected.size(); b++) {
+    for (uint64_t t = 0; t < thd_cnts.size(); t++) {
+      double sec = time_bench(selected[b], thd_cnts[t], ops);
+      double total = (double)ops * thd_cnts[t];
+      fprintf(out, "%s,%d,%d,%ld,%ld,%f,%f,%f\n", selected[b]->name, CC_ALG, WORKLOAD, thd_cnts[t],
+              ops, sec, total / sec / 1000000, sec * BILLION * thd_cnts[t] / total);
+      fflush(out);
+    }
+  }
+  if (out != stdout) fclose(out);
+  return 0;
+}
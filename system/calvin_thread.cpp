@@ -33,23 +33,46 @@
 #include "logger.h"
 #include "message.h"
 #include "work_queue.h"
+#include "row.h"
+
+void CalvinLockThread::setup() {
+	assert(g_calvin_lock_thread_cnt <= 64); // shard sets are 64-bit masks
+	sched_seq = 0;
+	last_seq = 0;
+	shard_txn_cnt = 0;
+	shard_lock_cnt = 0;
+	shard_lock_time = 0;
+}
 
-void CalvinLockThread::setup() {}
+uint64_t CalvinLockThread::get_shard(row_t * row) {
+	uint64_t key = row->get_primary_key() * 0x9E3779B97F4A7C15UL + row->get_part_id();
+	return (key >> 32) % g_calvin_lock_thread_cnt;
+}
 
 RC CalvinLockThread::run() {
 	tsetup();
 
-	RC rc = RCOK;
-	TxnManager * txn_man;
-	uint64_t prof_starttime = get_sys_clock();
 	uint64_t idle_starttime = 0;
 
 	while(!simulation->is_done()) {
-		txn_man = NULL;
-
-		Message * msg = work_queue.sched_dequeue(_thd_id);
+		bool busy = false;
+
+		if (shard_id == 0) {
+			Message * msg = work_queue.sched_dequeue(_thd_id);
+			if (msg) {
+				schedule(msg);
+				busy = true;
+			}
+		}
+		if (g_calvin_lock_thread_cnt > 1) {
+			TxnManager * txn_man = work_queue.lock_shard_dequeue(_thd_id, shard_id);
+			if (txn_man) {
+				acquire_shard(txn_man);
+				busy = true;
+			}
+		}
 
-		if(!msg) {
+		if(!busy) {
 			if (idle_starttime == 0) idle_starttime = get_sys_clock();
 			continue;
 		}
@@ -57,29 +80,40 @@ RC CalvinLockThread::run() {
 				INC_STATS(_thd_id,sched_idle_time,get_sys_clock() - idle_starttime);
 				idle_starttime = 0;
 		}
+	}
+	if (g_calvin_lock_thread_cnt > 1) {
+		printf("Lock shard %ld: txn_cnt=%ld, lock_cnt=%ld, lock_time=%f\n", shard_id, shard_txn_cnt,
+					 shard_lock_cnt, (double)shard_lock_time / BILLION);
+	}
+	printf("FINISH %ld:%ld\n",_node_id,_thd_id);
+	fflush(stdout);
+	return FINISH;
+}
 
-		prof_starttime = get_sys_clock();
-		assert(msg->get_rtype() == CL_QRY || msg->get_rtype() == CL_QRY_O);
-		assert(msg->get_txn_id() != UINT64_MAX);
+void CalvinLockThread::schedule(Message * msg) {
+	uint64_t prof_starttime = get_sys_clock();
+	assert(msg->get_rtype() == CL_QRY || msg->get_rtype() == CL_QRY_O);
+	assert(msg->get_txn_id() != UINT64_MAX);
 
-		txn_man =
-				txn_table.get_transaction_manager(get_thd_id(), msg->get_txn_id(), msg->get_batch_id());
-		while (!txn_man->unset_ready()) {
-		}
-		assert(ISSERVERN(msg->get_return_id()));
-		txn_man->txn_stats.starttime = get_sys_clock();
+	TxnManager * txn_man =
+			txn_table.get_transaction_manager(get_thd_id(), msg->get_txn_id(), msg->get_batch_id());
+	while (!txn_man->unset_ready()) {
+	}
+	assert(ISSERVERN(msg->get_return_id()));
+	txn_man->txn_stats.starttime = get_sys_clock();
 
-		txn_man->txn_stats.lat_network_time_start = msg->lat_network_time;
-		txn_man->txn_stats.lat_other_time_start = msg->lat_other_time;
+	txn_man->txn_stats.lat_network_time_start = msg->lat_network_time;
+	txn_man->txn_stats.lat_other_time_start = msg->lat_other_time;
 
-		msg->copy_to_txn(txn_man);
-		txn_man->register_thread(this);
-		assert(ISSERVERN(txn_man->return_id));
+	msg->copy_to_txn(txn_man);
+	txn_man->register_thread(this);
+	assert(ISSERVERN(txn_man->return_id));
 
-		INC_STATS(get_thd_id(),sched_txn_table_time,get_sys_clock() - prof_starttime);
-		prof_starttime = get_sys_clock();
+	INC_STATS(get_thd_id(),sched_txn_table_time,get_sys_clock() - prof_starttime);
+	prof_starttime = get_sys_clock();
 
-		rc = RCOK;
+	RC rc = RCOK;
+	if (g_calvin_lock_thread_cnt == 1) {
 		// Acquire locks
 		if (!txn_man->isRecon()) {
 				rc = txn_man->acquire_locks();
@@ -89,19 +123,64 @@ RC CalvinLockThread::run() {
 				work_queue.enqueue(_thd_id,msg,false);
 		}
 		txn_man->set_ready();
+	} else {
+		// One lock_ready_cnt reference per shard keeps the txn from becoming
+		// runnable before every shard has queued its lock requests.
+		txn_man->incr_lr();
+		uint64_t shards = 0;
+		if (!txn_man->isRecon()) {
+			txn_man->calvin_collect = true;
+			txn_man->acquire_locks();
+			txn_man->calvin_collect = false;
+			for (uint64_t i = 0; i < txn_man->calvin_locked_rows.size(); i++)
+				shards |= 1UL << get_shard(txn_man->calvin_locked_rows[i]);
+		}
+		uint64_t shard_cnt = __builtin_popcountl(shards);
+		for (uint64_t i = 1; i < shard_cnt; i++) txn_man->incr_lr();
+		txn_man->calvin_seq = ++sched_seq;
+		txn_man->calvin_msg = msg;
+		txn_man->set_ready();
 
-		INC_STATS(_thd_id,mtx[33],get_sys_clock() - prof_starttime);
-		prof_starttime = get_sys_clock();
+		if (shard_cnt == 0) {
+			if (txn_man->decr_lr() == 0 && ATOM_CAS(txn_man->lock_ready, false, true))
+				work_queue.enqueue(_thd_id,msg,false);
+		}
+		for (uint64_t s = 0; s < g_calvin_lock_thread_cnt; s++) {
+			if (shards & (1UL << s)) work_queue.lock_shard_enqueue(_thd_id, s, txn_man);
+		}
 	}
-	printf("FINISH %ld:%ld\n",_node_id,_thd_id);
-	fflush(stdout);
-	return FINISH;
+
+	INC_STATS(_thd_id,mtx[33],get_sys_clock() - prof_starttime);
+}
+
+void CalvinLockThread::acquire_shard(TxnManager * txn_man) {
+	uint64_t starttime = get_sys_clock();
+	assert(txn_man->calvin_seq > last_seq);
+	last_seq = txn_man->calvin_seq;
+	Message * msg = txn_man->calvin_msg;
+
+	for (uint64_t i = 0; i < txn_man->calvin_locked_rows.size(); i++) {
+		row_t * row = txn_man->calvin_locked_rows[i];
+		if (get_shard(row) != shard_id) continue;
+		RC rc = row->get_lock(txn_man->calvin_lock_types[i], txn_man);
+		if (rc == WAIT) INC_STATS(_thd_id, txn_wait_cnt, 1);
+		shard_lock_cnt++;
+	}
+	shard_txn_cnt++;
+	// the last shard to hand off (or the last lock grant) makes the txn runnable
+	if (txn_man->decr_lr() == 0 && ATOM_CAS(txn_man->lock_ready, false, true))
+		work_queue.enqueue(_thd_id,msg,false);
+
+	uint64_t timespan = get_sys_clock() - starttime;
+	shard_lock_time += timespan;
+	INC_STATS(_thd_id,sched_shard_txn_cnt,1);
+	INC_STATS(_thd_id,sched_shard_lock_time,timespan);
 }
 
 void CalvinSequencerThread::setup() {}
 
 bool CalvinSequencerThread::is_batch_ready() {
-	bool ready = get_wall_clock() - simulation->last_seq_epoch_time >= g_seq_batch_time_limit;
+	bool ready = get_wall_clock() - simulation->last_seq_epoch_time >= seq_man.get_batch_timer();
 	return ready;
 }
 
@@ -117,10 +196,11 @@ RC CalvinSequencerThread::run() {
 		prof_starttime = get_sys_clock();
 
 		if(is_batch_ready()) {
-			simulation->advance_seq_epoch();
+			simulation->advance_seq_epoch(seq_man.get_batch_timer());
 			//last_batchtime = get_wall_clock();
 			seq_man.send_next_batch(_thd_id);
 		}
+		seq_man.dispatch(_thd_id);
 
 		INC_STATS(_thd_id,mtx[30],get_sys_clock() - prof_starttime);
 		prof_starttime = get_sys_clock();
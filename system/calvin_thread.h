@@ -20,6 +20,8 @@
 #include "global.h"
 
 class Workload;
+class row_t;
+class Message;
 
 /*
 class CalvinThread : public Thread {
@@ -32,12 +34,29 @@ private:
 };
 */
 
+/*
+   With CALVIN_LOCK_THREAD_CNT > 1, lock thread 0 dequeues the schedule,
+   collects each txn's lock set and hands the txn to every shard owning one
+   of its rows. Shard queues are FIFO in schedule order, so each shard grants
+   its row locks in the same deterministic order a single lock thread would.
+   The txn becomes runnable once every shard has handed it off and all of
+   its locks are granted.
+*/
 class CalvinLockThread : public Thread {
 public:
     RC run();
     void setup();
+    static uint64_t get_shard(row_t * row);
+    uint64_t shard_id;
 private:
+    void schedule(Message * msg);
+    void acquire_shard(TxnManager * txn_man);
     TxnManager * m_txn;
+    uint64_t sched_seq; // schedule order, assigned by shard 0
+    uint64_t last_seq; // last txn seen by this shard
+    uint64_t shard_txn_cnt;
+    uint64_t shard_lock_cnt;
+    uint64_t shard_lock_time;
 };
 
 class CalvinSequencerThread : public Thread {
@@ -0,0 +1,491 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "checkpoint.h"
+#include "helper.h"
+#include "logger.h"
+#include "wl.h"
+#include "table.h"
+#include "row.h"
+#include "row_lock.h"
+#include "catalog.h"
+#include "index_base.h"
+#include "index_hash.h"
+#include "index_btree.h"
+#include "sim_manager.h"
+#include "mem_alloc.h"
+#include <algorithm>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CKPT_MAX_DELAY 100 * 1000000UL // 100ms
+#define CKPT_MIN_DELAY 100 * 1000UL // 100us
+
+// false on a write error other than an interrupt
+static bool write_all(int fd, const char * buf, uint64_t size) {
+  uint64_t written = 0;
+  while (written < size) {
+    ssize_t rc = write(fd, buf + written, size - written);
+    if (rc < 0 && errno == EINTR) continue;
+    if (rc <= 0) return false;
+    written += rc;
+  }
+  return true;
+}
+
+// Unlike a log failure this is not fatal: the checkpoint is dropped, and the log
+// it would have truncated is kept whole.
+static RC ckpt_failed(const char * op, const std::string & name, int fd) {
+  printf("Checkpoint %s of %s failed (%s)\n", op, name.c_str(), strerror(errno));
+  fflush(stdout);
+  if (fd >= 0) close(fd);
+  unlink(name.c_str());
+  return Abort;
+}
+
+// write the manifest under a temporary name, then rename it in place
+static RC write_manifest(const CkptManifest & manifest, const std::string & name) {
+  std::string tmp_name = name + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return ckpt_failed("open", tmp_name, fd);
+  if (!write_all(fd, (char *)&manifest, sizeof(manifest))) return ckpt_failed("write", tmp_name, fd);
+  if (fdatasync(fd) != 0) return ckpt_failed("fdatasync", tmp_name, fd);
+  close(fd);
+  if (rename(tmp_name.c_str(), name.c_str()) != 0) return ckpt_failed("rename", tmp_name, -1);
+  return RCOK;
+}
+
+// Writes under the locking CCs go into the row before commit and are rolled back in
+// place on abort: copy the tuple only while no writer holds it.
+static bool copy_tuple(row_t * row, char * dst, uint64_t thd_id) {
+#if CC_ALG == DL_DETECT || CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN
+  return row->manager->copy_clean(dst, thd_id);
+#else
+  memcpy(dst, row->get_data(), row->get_tuple_size());
+  return true;
+#endif
+}
+
+void Checkpointer::init(Workload * wl) {
+  this->wl = wl;
+  dir = CKPT_DIR;
+  snapshot = false;
+  index_list.clear();
+  tables.clear();
+  for (auto it = wl->indexes.begin(); it != wl->indexes.end(); it++) index_list.push_back(it->second);
+  for (auto it = wl->tables.begin(); it != wl->tables.end(); it++)
+    tables[it->second->get_table_id()] = it->second;
+  init_heap_tables();
+  if (latency == NULL) {
+    latency = (CkptLatency *)mem_allocator.align_alloc(sizeof(CkptLatency) * g_thread_cnt);
+    memset(latency, 0, sizeof(CkptLatency) * g_thread_cnt);
+  }
+  last_txn_cnt = 0;
+  last_slow_cnt = 0;
+  delay = 0;
+}
+
+void Checkpointer::init_snapshot(Workload * wl, const std::string & dir) {
+  this->wl = wl;
+  this->dir = dir;
+  snapshot = true;
+  index_list.clear();
+  tables.clear();
+  for (auto it = wl->indexes.begin(); it != wl->indexes.end(); it++) index_list.push_back(it->second);
+  for (auto it = wl->tables.begin(); it != wl->tables.end(); it++)
+    tables[it->second->get_table_id()] = it->second;
+  init_heap_tables();
+  latency = NULL;
+  ckpt_id = 0;
+  load_epoch = 0;
+  delay = 0;
+}
+
+// Tables no index refers to are copied from the rows they keep (table_t::keep_rows).
+void Checkpointer::init_heap_tables() {
+  heap_tables.clear();
+  for (auto it = tables.begin(); it != tables.end(); it++) {
+    bool indexed = false;
+    for (uint64_t i = 0; i < index_list.size(); i++) indexed = indexed || index_list[i]->table == it->second;
+    if (indexed) continue;
+    if (!it->second->keeps_rows()) {
+      printf("Table %s has no index and keeps no rows: it cannot be checkpointed\n",
+             it->second->get_table_name());
+      fflush(stdout);
+      assert(false);
+    }
+    heap_tables.push_back(it->second);
+  }
+}
+
+std::string Checkpointer::file_name(uint64_t part_id) {
+  return dir + "/ckpt_" + std::to_string(g_node_id) + "_" +
+         std::to_string(part_id) + ".dat";
+}
+
+std::string Checkpointer::manifest_name() {
+  return dir + "/ckpt_" + std::to_string(g_node_id) + ".manifest";
+}
+
+uint32_t Checkpointer::computeChecksum(const char * data, uint64_t size) {
+  uint32_t hash = 2166136261u;
+  for (uint64_t i = 0; i < size; i++) {
+    hash ^= (uint8_t)data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void Checkpointer::record_latency(uint64_t thd_id, uint64_t latency_ns) {
+  if (thd_id >= g_thread_cnt) return;
+  latency[thd_id].txn_cnt++;
+  if (latency_ns > g_ckpt_latency_bound) latency[thd_id].slow_cnt++;
+}
+
+// Back off while more than 1% of the commits since the last chunk were slower
+// than the bound, speed up again once they are not.
+void Checkpointer::throttle(uint64_t thd_id) {
+  uint64_t txn_cnt = 0;
+  uint64_t slow_cnt = 0;
+  for (uint64_t i = 0; i < g_thread_cnt; i++) {
+    txn_cnt += latency[i].txn_cnt;
+    slow_cnt += latency[i].slow_cnt;
+  }
+  uint64_t txns = txn_cnt - last_txn_cnt;
+  uint64_t slow = slow_cnt - last_slow_cnt;
+  last_txn_cnt = txn_cnt;
+  last_slow_cnt = slow_cnt;
+  if (txns > 0 && slow * 100 > txns)
+    delay = std::min(std::max(delay * 2, (uint64_t)CKPT_MIN_DELAY), (uint64_t)CKPT_MAX_DELAY);
+  else
+    delay = delay / 2 < CKPT_MIN_DELAY ? 0 : delay / 2;
+  if (delay > 0) {
+    usleep(delay / 1000);
+    INC_STATS(thd_id,ckpt_throttle_time,delay);
+  }
+}
+
+void * Checkpointer::threadDump(void * args) {
+  Checkpointer * ckpt = ((ckpt_args *)args)->ckpt;
+  ((ckpt_args *)args)->rc = ckpt->checkpoint_part(0, ((ckpt_args *)args)->id, ckpt->ckpt_id, 0);
+  return NULL;
+}
+
+RC Checkpointer::dump_snapshot() {
+  uint64_t starttime = get_server_clock();
+  mkdir(dir.c_str(), 0755);
+  // a stale manifest must not vouch for partitions being rewritten
+  unlink(manifest_name().c_str());
+  ckpt_id = 1;
+  pthread_t * p_thds = new pthread_t[g_part_cnt];
+  ckpt_args * args = new ckpt_args[g_part_cnt];
+  for (uint64_t i = 0; i < g_part_cnt; i++) {
+    args[i].ckpt = this;
+    args[i].id = i;
+    pthread_create(&p_thds[i], NULL, threadDump, &args[i]);
+  }
+  RC rc = RCOK;
+  for (uint64_t i = 0; i < g_part_cnt; i++) {
+    pthread_join(p_thds[i], NULL);
+    if (args[i].rc != RCOK) rc = ERROR;
+  }
+  delete[] p_thds;
+  delete[] args;
+  if (rc != RCOK) return rc;
+
+  CkptManifest manifest;
+  manifest.magic = CKPT_MAGIC;
+  manifest.part_cnt = g_part_cnt;
+  manifest.node_id = g_node_id;
+  manifest.ckpt_id = ckpt_id;
+  manifest.epoch = 0;
+  if (write_manifest(manifest, manifest_name()) != RCOK) return ERROR;
+  printf("wrote snapshot %s in %f s, ", dir.c_str(),
+         (double)(get_server_clock() - starttime) / BILLION);
+  return RCOK;
+}
+
+RC Checkpointer::checkpoint(uint64_t thd_id) {
+  uint64_t starttime = get_sys_clock();
+  ckpt_id++;
+  // Replay starts early enough for every commit the copy may miss: those appended
+  // from now on and those appended earlier whose writes are still being installed.
+#if LOGGING
+  uint64_t epoch = logger.get_install_epoch();
+#else
+  uint64_t epoch = 0;
+#endif
+  for (uint64_t part_id = 0; part_id < g_part_cnt; part_id++) {
+    if (checkpoint_part(thd_id, part_id, ckpt_id, epoch) != RCOK) return Abort;
+  }
+
+  CkptManifest manifest;
+  manifest.magic = CKPT_MAGIC;
+  manifest.part_cnt = g_part_cnt;
+  manifest.node_id = g_node_id;
+  manifest.ckpt_id = ckpt_id;
+  manifest.epoch = epoch;
+  // the log stays whole unless the manifest vouches for the checkpoint
+  if (write_manifest(manifest, manifest_name()) != RCOK) return Abort;
+#if LOGGING
+  logger.truncate(epoch);
+#endif
+  INC_STATS(thd_id,ckpt_cnt,1);
+  INC_STATS(thd_id,ckpt_time,get_sys_clock() - starttime);
+  return RCOK;
+}
+
+RC Checkpointer::checkpoint_part(uint64_t thd_id, uint64_t part_id, uint64_t ckpt_id,
+                                 uint64_t epoch) {
+  std::vector<std::vector<index_entry_t> > entries(index_list.size());
+  for (uint64_t i = 0; i < index_list.size(); i++) index_list[i]->index_scan(part_id, entries[i]);
+  // every row once, in the order of its first index entry, then the unindexed ones
+  std::unordered_map<row_t *, uint64_t> row_pos;
+  std::vector<row_t *> rows;
+  std::vector<CkptIndexEntry> index_entries;
+  for (uint64_t i = 0; i < index_list.size(); i++) {
+    for (auto it = entries[i].begin(); it != entries[i].end(); it++) {
+      for (itemid_t * item = it->items; item != NULL; item = item->next) {
+        row_t * row = (row_t *)item->location;
+        auto r = row_pos.find(row);
+        if (r == row_pos.end()) {
+          r = row_pos.insert(std::make_pair(row, rows.size())).first;
+          rows.push_back(row);
+        }
+        CkptIndexEntry entry;
+        entry.index_id = i;
+        entry.nonunique = it->nonunique;
+        entry.part_id = part_id;
+        entry.key = it->key;
+        entry.row = r->second;
+        index_entries.push_back(entry);
+      }
+    }
+  }
+  for (uint64_t i = 0; i < heap_tables.size(); i++) heap_tables[i]->scan_rows(part_id, rows);
+  if (rows.empty()) {
+    unlink(file_name(part_id).c_str());
+    return RCOK;
+  }
+
+  std::string tmp_name = file_name(part_id) + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return ckpt_failed("open", tmp_name, fd);
+  CkptFileHeader header;
+  memset(&header, 0, sizeof(header));
+  if (!write_all(fd, (char *)&header, sizeof(header))) return ckpt_failed("write", tmp_name, fd);
+  uint64_t offset = sizeof(header);
+
+  std::vector<char> chunk;
+  chunk.reserve(g_ckpt_chunk_size);
+  for (uint64_t i = 0; i < rows.size(); i++) {
+    row_t * row = rows[i];
+    CkptRowHeader rh;
+    rh.table_id = row->get_table()->get_table_id();
+    rh.part_id = row->get_part_id();
+    rh.row_id = row->get_row_id();
+    rh.primary_key = row->get_primary_key();
+    rh.size = row->get_tuple_size();
+    uint64_t pos = chunk.size();
+    chunk.resize(pos + sizeof(rh) + rh.size);
+    // fuzzy copy, later updates are redone from the log
+    while (!copy_tuple(row, &chunk[pos + sizeof(rh)], thd_id)) {
+      if (!snapshot && simulation->is_done()) {
+        close(fd);
+        unlink(tmp_name.c_str());
+        return Abort;
+      }
+      INC_STATS(thd_id,ckpt_retry_cnt,1);
+    }
+    rh.checksum = computeChecksum(&chunk[pos + sizeof(rh)], rh.size);
+    memcpy(&chunk[pos], &rh, sizeof(rh));
+    if (chunk.size() < g_ckpt_chunk_size) continue;
+    if (!write_all(fd, chunk.data(), chunk.size())) return ckpt_failed("write", tmp_name, fd);
+    offset += chunk.size();
+    if (!snapshot) INC_STATS(thd_id,ckpt_bytes,chunk.size());
+    chunk.clear();
+    if (!snapshot) {
+      if (simulation->is_done()) {
+        close(fd);
+        unlink(tmp_name.c_str());
+        return Abort;
+      }
+      throttle(thd_id);
+    }
+  }
+  if (!write_all(fd, chunk.data(), chunk.size()) ||
+      !write_all(fd, (char *)index_entries.data(), sizeof(CkptIndexEntry) * index_entries.size()))
+    return ckpt_failed("write", tmp_name, fd);
+  offset += chunk.size();
+
+  header.magic = CKPT_MAGIC;
+  header.part_id = part_id;
+  header.node_id = g_node_id;
+  header.ckpt_id = ckpt_id;
+  header.epoch = epoch;
+  header.row_cnt = rows.size();
+  header.entry_cnt = index_entries.size();
+  header.entry_offset = offset;
+  if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) return ckpt_failed("write", tmp_name, fd);
+  if (fdatasync(fd) != 0) return ckpt_failed("fdatasync", tmp_name, fd);
+  close(fd);
+  if (rename(tmp_name.c_str(), file_name(part_id).c_str()) != 0)
+    return ckpt_failed("rename", tmp_name, -1);
+  if (snapshot) return RCOK;
+  INC_STATS(thd_id,ckpt_bytes,chunk.size() + sizeof(CkptIndexEntry) * index_entries.size());
+  INC_STATS(thd_id,ckpt_row_cnt,rows.size());
+  return RCOK;
+}
+
+// Map the partition file and check it belongs to the manifest and every tuple
+// matches its checksum. The mapping is kept for load_part.
+bool Checkpointer::verify_part(uint64_t part_id, const CkptManifest &manifest) {
+  int fd = open(file_name(part_id).c_str(), O_RDONLY);
+  if (fd < 0) return true;
+  struct stat st;
+  fstat(fd, &st);
+  uint64_t size = st.st_size;
+  if (size < sizeof(CkptFileHeader)) {
+    close(fd);
+    return false;
+  }
+  char * data = (char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  assert(data != MAP_FAILED);
+  CkptFileHeader * header = (CkptFileHeader *)data;
+  if (header->magic != CKPT_MAGIC || header->ckpt_id != manifest.ckpt_id ||
+      header->part_id != part_id ||
+      header->entry_offset + header->entry_cnt * sizeof(CkptIndexEntry) != size) {
+    // a partition left over from an older checkpoint is no longer part of it
+    munmap(data, size);
+    return header->ckpt_id != manifest.ckpt_id && header->magic == CKPT_MAGIC;
+  }
+  uint64_t ptr = sizeof(CkptFileHeader);
+  for (uint64_t i = 0; i < header->row_cnt; i++) {
+    CkptRowHeader * rh = (CkptRowHeader *)&data[ptr];
+    if (ptr + sizeof(CkptRowHeader) > header->entry_offset ||
+        ptr + sizeof(CkptRowHeader) + rh->size > header->entry_offset ||
+        tables.find(rh->table_id) == tables.end() ||
+        rh->size != tables[rh->table_id]->get_schema()->get_tuple_size() ||
+        computeChecksum(&data[ptr + sizeof(CkptRowHeader)], rh->size) != rh->checksum) {
+      munmap(data, size);
+      return false;
+    }
+    ptr += sizeof(CkptRowHeader) + rh->size;
+  }
+  load_files[part_id] = std::make_pair(data, size);
+  return true;
+}
+
+void Checkpointer::load_part(uint64_t part_id) {
+  char * data = load_files[part_id].first;
+  CkptFileHeader * header = (CkptFileHeader *)data;
+  std::vector<row_t *> rows(header->row_cnt);
+  uint64_t ptr = sizeof(CkptFileHeader);
+  for (uint64_t i = 0; i < header->row_cnt; i++) {
+    CkptRowHeader * rh = (CkptRowHeader *)&data[ptr];
+    table_t * table = tables[rh->table_id];
+    row_t * row;
+    uint64_t row_id = rh->row_id;
+    RC rc = table->get_new_row(row, rh->part_id, row_id);
+    assert(rc == RCOK);
+    assert(rh->size == row->get_tuple_size());
+    row->set_primary_key(rh->primary_key);
+    memcpy(row->get_data(), &data[ptr + sizeof(CkptRowHeader)], rh->size);
+    rows[i] = row;
+    ptr += sizeof(CkptRowHeader) + rh->size;
+  }
+  // inserts prepend to the item chains, so insert in reverse scan order
+  CkptIndexEntry * entries = (CkptIndexEntry *)&data[header->entry_offset];
+  for (uint64_t i = header->entry_cnt; i > 0; i--) {
+    CkptIndexEntry * entry = &entries[i - 1];
+    INDEX * index = index_list[entry->index_id];
+    if (entry->nonunique)
+      wl->index_insert_nonunique(index, entry->key, rows[entry->row], entry->part_id);
+    else
+      wl->index_insert(index, entry->key, rows[entry->row], entry->part_id);
+  }
+}
+
+void * Checkpointer::threadLoad(void * args) {
+  Checkpointer * ckpt = ((ckpt_args *)args)->ckpt;
+  ckpt->load_part(((ckpt_args *)args)->id);
+  return NULL;
+}
+
+RC Checkpointer::load(Workload * wl) {
+  uint64_t starttime = get_server_clock();
+  if (!snapshot) init(wl);
+  int fd = open(manifest_name().c_str(), O_RDONLY);
+  if (fd < 0) {
+    printf("no checkpoint found, ");
+    return ERROR;
+  }
+  CkptManifest manifest;
+  ssize_t rc = read(fd, &manifest, sizeof(manifest));
+  close(fd);
+  if (rc != sizeof(manifest) || manifest.magic != CKPT_MAGIC || manifest.part_cnt != g_part_cnt ||
+      manifest.node_id != g_node_id) {
+    printf("invalid checkpoint manifest, ");
+    return ERROR;
+  }
+
+  // verify every partition before building anything, so a bad checkpoint
+  // leaves the tables empty for init_table
+  load_files.assign(g_part_cnt, std::make_pair((char *)NULL, (uint64_t)0));
+  bool valid = true;
+  for (uint64_t part_id = 0; part_id < g_part_cnt && valid; part_id++)
+    valid = verify_part(part_id, manifest);
+  std::vector<uint64_t> parts;
+  uint64_t bytes = 0;
+  for (uint64_t part_id = 0; part_id < g_part_cnt; part_id++) {
+    if (load_files[part_id].first == NULL) continue;
+    if (!valid) {
+      munmap(load_files[part_id].first, load_files[part_id].second);
+      continue;
+    }
+    parts.push_back(part_id);
+    bytes += load_files[part_id].second;
+  }
+  if (!valid) {
+    printf("corrupt checkpoint %ld, ", manifest.ckpt_id);
+    return ERROR;
+  }
+
+  pthread_t * p_thds = new pthread_t[parts.size()];
+  ckpt_args * args = new ckpt_args[parts.size()];
+  for (uint64_t i = 0; i < parts.size(); i++) {
+    args[i].ckpt = this;
+    args[i].id = parts[i];
+    pthread_create(&p_thds[i], NULL, threadLoad, &args[i]);
+  }
+  for (uint64_t i = 0; i < parts.size(); i++) pthread_join(p_thds[i], NULL);
+  delete[] p_thds;
+  delete[] args;
+  for (uint64_t i = 0; i < parts.size(); i++)
+    munmap(load_files[parts[i]].first, load_files[parts[i]].second);
+  load_files.clear();
+
+  ckpt_id = manifest.ckpt_id;
+  load_epoch = manifest.epoch;
+  double sec = (double)(get_server_clock() - starttime) / BILLION;
+  printf("loaded %s %ld (epoch %ld, %ld partitions, %ld bytes) in %f s, ",
+         snapshot ? "snapshot" : "checkpoint", ckpt_id, load_epoch, parts.size(), bytes, sec);
+  return RCOK;
+}
@@ -0,0 +1,137 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include "global.h"
+
+class Workload;
+class table_t;
+class row_t;
+class IndexHash;
+class index_btree;
+
+#define CKPT_MAGIC 0x434b5054
+
+/*
+   Partition file layout:
+   CkptFileHeader | rows (CkptRowHeader + tuple) ... | CkptIndexEntry ...
+   The index entries refer to rows by their position in the file. Rows of tables
+   without an index have no entry.
+*/
+struct CkptFileHeader {
+  uint32_t magic;
+  uint32_t part_id;
+  uint64_t node_id;
+  uint64_t ckpt_id;
+  uint64_t epoch;
+  uint64_t row_cnt;
+  uint64_t entry_cnt;
+  uint64_t entry_offset;
+};
+
+struct CkptRowHeader {
+  uint32_t table_id;
+  uint32_t checksum; // over the tuple
+  uint64_t part_id;
+  uint64_t row_id;
+  uint64_t primary_key;
+  uint64_t size;
+};
+
+struct CkptIndexEntry {
+  uint32_t index_id; // position of the index in Workload::indexes
+  uint32_t nonunique;
+  uint64_t part_id;
+  uint64_t key;
+  uint64_t row;
+};
+
+// Written last: a checkpoint exists only once its manifest is renamed in place.
+struct CkptManifest {
+  uint32_t magic;
+  uint32_t part_cnt;
+  uint64_t node_id;
+  uint64_t ckpt_id;
+  uint64_t epoch; // log epoch at the start of the checkpoint
+};
+
+// commit latency counters of one worker, sampled by the checkpointer
+struct CkptLatency {
+  volatile uint64_t txn_cnt;
+  volatile uint64_t slow_cnt;
+  char _pad[CL_SIZE - sizeof(uint64_t) * 2];
+};
+
+/*
+   Fuzzy checkpointer. Tuples are copied without latches while transactions
+   keep running, so a checkpoint is only transaction consistent together with
+   the log from the epoch it started in: recovery replays the blocks of that
+   epoch and later over the loaded checkpoint, and the log before it is
+   truncated once the checkpoint is complete.
+*/
+class Checkpointer {
+public:
+  void init(Workload * wl);
+  RC checkpoint(uint64_t thd_id);
+  // rebuild tables and indexes from the last complete checkpoint; tables must be empty
+  RC load(Workload * wl);
+  uint64_t get_load_epoch() { return load_epoch; }
+  void record_latency(uint64_t thd_id, uint64_t latency);
+  // Snapshot of a freshly generated database in its own directory, in the
+  // checkpoint format. Written once after loading, without throttling, by one
+  // thread per partition.
+  void init_snapshot(Workload * wl, const std::string & dir);
+  RC dump_snapshot();
+
+private:
+  RC checkpoint_part(uint64_t thd_id, uint64_t part_id, uint64_t ckpt_id, uint64_t epoch);
+  void init_heap_tables();
+  bool verify_part(uint64_t part_id, const CkptManifest &manifest);
+  void load_part(uint64_t part_id);
+  void throttle(uint64_t thd_id);
+  std::string file_name(uint64_t part_id);
+  std::string manifest_name();
+  static uint32_t computeChecksum(const char * data, uint64_t size);
+  static void * threadLoad(void * args);
+  static void * threadDump(void * args);
+
+  Workload * wl;
+  std::string dir;
+  bool snapshot;
+  std::vector<INDEX *> index_list;
+  std::map<uint32_t, table_t *> tables;
+  // tables without an index, copied from the rows they keep
+  std::vector<table_t *> heap_tables;
+  uint64_t ckpt_id;
+  uint64_t load_epoch;
+  // partitions found by verify_part, loaded by load_part
+  std::vector<std::pair<char *, uint64_t> > load_files;
+
+  CkptLatency * latency;
+  uint64_t last_txn_cnt;
+  uint64_t last_slow_cnt;
+  uint64_t delay; // ns slept after each chunk
+};
+
+struct ckpt_args {
+  Checkpointer * ckpt;
+  uint64_t id;
+  RC rc;
+};
+
+#endif
@@ -39,10 +39,58 @@ void ClientThread::setup() {
 	// send ~twice as frequently due to delays in context switching
 	send_interval = (g_client_thread_cnt * BILLION) / g_load_per_server / 1.8;
 	printf("Client interval: %ld\n",send_interval);
+#elif LOAD_METHOD == LOAD_OPEN
+	rate_schedule.push_back(std::make_pair(0UL, (double)g_load_per_server));
+	std::stringstream schedule(ARRIVAL_RATE_SCHEDULE);
+	std::string phase;
+	while (std::getline(schedule, phase, ',')) {
+		size_t sep = phase.find(':');
+		if (sep == std::string::npos) continue;
+		uint64_t start = (uint64_t)(atof(phase.substr(0, sep).c_str()) * BILLION);
+		rate_schedule.push_back(std::make_pair(start, atof(phase.substr(sep + 1).c_str())));
+	}
+	std::stable_sort(rate_schedule.begin(), rate_schedule.end(),
+									 [](const std::pair<uint64_t, double> &a, const std::pair<uint64_t, double> &b) {
+										 return a.first < b.first;
+									 });
 #endif
 
 }
 
+double ClientThread::arrival_rate(uint64_t time) {
+	double rate = 0;
+	for (auto it = rate_schedule.begin(); it != rate_schedule.end() && it->first <= time; it++)
+		rate = it->second;
+	return rate;
+}
+
+// Gap to the next arrival of this thread. The thread's share of the node's load
+// is rate * servers / client threads; a bursty client sends ARRIVAL_BURST_LEN at
+// once and keeps the same mean rate.
+uint64_t ClientThread::next_arrival_gap() {
+	uint64_t time = next_arrival - run_starttime;
+	double rate = arrival_rate(time) * g_servers_per_client / g_client_thread_cnt;
+	if (rate <= 0) {
+		// idle until the next phase of the schedule
+		for (auto it = rate_schedule.begin(); it != rate_schedule.end(); it++)
+			if (it->first > time) return it->first - time;
+		return UINT64_MAX / 2;
+	}
+#if ARRIVAL_DIST == ARRIVAL_POISSON
+	double u = (double)(mrand->next() % 1000000 + 1) / 1000001;
+	return (uint64_t)(-log(u) / rate * BILLION);
+#elif ARRIVAL_DIST == ARRIVAL_BURSTY
+	if (burst_left > 0) {
+		burst_left--;
+		return 0;
+	}
+	burst_left = ARRIVAL_BURST_LEN - 1;
+	return (uint64_t)(ARRIVAL_BURST_LEN / rate * BILLION);
+#else
+	return (uint64_t)(BILLION / rate);
+#endif
+}
+
 struct MigrationPlan {
 	vector<int> order;
   uint64_t src, dest;
@@ -128,6 +176,11 @@ RC ClientThread::run() {
 	assert(!ismigrate);
 	
 	run_starttime = get_sys_clock();
+#if LOAD_METHOD == LOAD_OPEN
+	next_arrival = run_starttime;
+	burst_left = 0;
+	uint64_t arrival_time = 0;
+#endif
 	#if MIGRATION
 		bool ismigrate=false;
 		uint64_t node_id_src = MIGRATION_SRC_NODE, node_id_des = MIGRATION_DES_NODE;
@@ -580,11 +633,19 @@ RC ClientThread::run() {
 			if (iters == UINT64_MAX)
 				iters = 0;		
 
+		#if LOAD_METHOD == LOAD_OPEN
+			if (get_sys_clock() < next_arrival)
+				continue;
+		#endif
 			if ((inf_cnt = client_man.inc_inflight(next_node)) < 0) {
 				//std::cout<<next_node<<' ';
 				//std::cout<<g_node_inflight_max[next_node]<<" ";
 				continue;
 			}
+		#if LOAD_METHOD == LOAD_OPEN
+			arrival_time = next_arrival;
+			next_arrival += next_arrival_gap();
+		#endif
 				
 			if (partition_id % g_node_cnt == next_node) //not migrated 
 				m_query = client_query_queue.get_next_query_partition(next_node,partition_id, _thd_id);
@@ -619,6 +680,15 @@ RC ClientThread::run() {
 					}
 					last_send_time = gate_time;
 					m_query = client_query_queue.get_next_query(next_node,_thd_id);
+			#elif LOAD_METHOD == LOAD_OPEN
+					// an arrival not sent yet stays due, so a full in-flight window only delays it
+					if (get_sys_clock() < next_arrival)
+						continue;
+					if ((inf_cnt = client_man.inc_inflight(next_node)) < 0)
+						continue;
+					arrival_time = next_arrival;
+					next_arrival += next_arrival_gap();
+					m_query = client_query_queue.get_next_query(next_node,_thd_id);
 			#else
 					assert(false);
 			#endif
@@ -659,6 +729,14 @@ RC ClientThread::run() {
 		}
 		last_send_time = gate_time;
 		m_query = client_query_queue.get_next_query(next_node,_thd_id);
+#elif LOAD_METHOD == LOAD_OPEN
+		if (get_sys_clock() < next_arrival)
+			continue;
+		if ((inf_cnt = client_man.inc_inflight(next_node)) < 0)
+			continue;
+		arrival_time = next_arrival;
+		next_arrival += next_arrival_gap();
+		m_query = client_query_queue.get_next_query(next_node,_thd_id);
 #else
 		assert(false);
 #endif
@@ -676,7 +754,11 @@ RC ClientThread::run() {
 #else
 		Message * msg = Message::create_message((BaseQuery*)m_query,CL_QRY);
 #endif
+#if LOAD_METHOD == LOAD_OPEN
+		((ClientQueryMessage*)msg)->client_startts = arrival_time;
+#else
 		((ClientQueryMessage*)msg)->client_startts = get_sys_clock();
+#endif
 		msg_queue.enqueue(get_thd_id(),msg,next_node_id);
 		num_txns_sent++;
 		txns_sent[next_node]++;
@@ -32,9 +32,15 @@ public:
   void assign(std::vector<std::vector<int> > plans, double theta);
   void assign1(std::vector<int64_t> vset, double theta);
 private:
+  // LOAD_OPEN: per-server rate in effect at time (ns since the run start)
+  double arrival_rate(uint64_t time);
+  uint64_t next_arrival_gap();
   myrand* mrand;
   uint64_t last_send_time;
   uint64_t send_interval;
+  uint64_t next_arrival;
+  uint64_t burst_left;
+  std::vector<std::pair<uint64_t, double> > rate_schedule;
 };
 
 #endif
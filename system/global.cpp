@@ -29,6 +29,7 @@
 #include "transport.h"
 #include "work_queue.h"
 #include "abort_queue.h"
+#include "checkpoint.h"
 #include "client_query.h"
 #include "client_txn.h"
 #include "logger.h"
@@ -55,6 +56,9 @@
 #include "key_xid.h"
 #include "rts_cache.h"
 #include "migmsg_queue.h"
+#include "placement.h"
+#include "admission.h"
+#include "msg_trace.h"
 
 #include <boost/lockfree/queue.hpp>
 #include "da_block_queue.h"
@@ -92,6 +96,7 @@ MigrateMessageQueue migmsg_queue;
 Client_txn client_man;
 Sequencer seq_man;
 Logger logger;
+Checkpointer checkpointer;
 TimeTable time_table;
 DtaTimeTable dta_time_table;
 KeyXidCache dta_key_xid_cache;
@@ -100,6 +105,9 @@ InOutTable inout_table;
 WkdbTimeTable wkdb_time_table;
 KeyXidCache wkdb_key_xid_cache;
 RtsCache wkdb_rts_cache;
+Placement placement;
+AdmissionControl admission;
+MsgTrace msg_trace;
 // QTcpQueue tcp_queue;
 
 boost::lockfree::queue<DAQuery*, boost::lockfree::fixed_sized<true>> da_query_queue{100};
@@ -126,6 +134,7 @@ bool g_key_order = KEY_ORDER;
 bool g_ts_batch_alloc = TS_BATCH_ALLOC;
 UInt32 g_ts_batch_num = TS_BATCH_NUM;
 int32_t g_inflight_max = MAX_TXN_IN_FLIGHT;
+UInt32 g_client_query_ring = CLIENT_QUERY_RING;
 //int32_t g_inflight_max = MAX_TXN_IN_FLIGHT/NODE_CNT;
 
 std::vector<int32_t> g_node_inflight_max(g_node_cnt);
@@ -164,10 +173,14 @@ double g_txn_write_perc = TXN_WRITE_PERC;
 double g_tup_read_perc = 1.0 - TUP_WRITE_PERC;
 double g_tup_write_perc = TUP_WRITE_PERC;
 double g_zipf_theta = ZIPF_THETA;
+uint64_t g_shift_interval = SHIFT_INTERVAL;
+uint64_t g_shift_drift_rate = SHIFT_DRIFT_RATE;
+uint64_t g_shift_jump_keys = SHIFT_JUMP_KEYS;
 double g_data_perc = DATA_PERC;
 double g_access_perc = ACCESS_PERC;
 bool g_prt_lat_distr = PRT_LAT_DISTR;
 UInt32 g_node_id = 0;
+uint64_t g_seed = SEED;
 UInt32 g_node_cnt = NODE_CNT;
 UInt32 g_part_cnt = PART_CNT;
 UInt32 g_part_split_cnt = PART_SPLIT_CNT;
@@ -186,6 +199,11 @@ UInt32 g_logger_thread_cnt = 1;
 #else
 UInt32 g_logger_thread_cnt = 0;
 #endif
+#if CHECKPOINT
+UInt32 g_checkpoint_thread_cnt = 1;
+#else
+UInt32 g_checkpoint_thread_cnt = 0;
+#endif
 UInt32 g_send_thread_cnt = SEND_THREAD_CNT;
 #if MIGRATION
 UInt32 g_migrate_thread_cnt = MIG_THREAD_CNT;
@@ -194,13 +212,13 @@ UInt32 g_migrate_thread_cnt = 0;
 #endif
 UInt32 g_stat_thread_cnt = 1;
 #if CC_ALG == CALVIN
-// sequencer + scheduler thread
-UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + 3;
+// sequencer + scheduler threads
+UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_checkpoint_thread_cnt + g_calvin_lock_thread_cnt + 2;
 #else
     #if MIGRATION
-        UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_migrate_thread_cnt + g_stat_thread_cnt + 1;
+        UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_checkpoint_thread_cnt + g_migrate_thread_cnt + g_stat_thread_cnt + 1;
     #else
-        UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_stat_thread_cnt + 1;
+        UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_checkpoint_thread_cnt + g_stat_thread_cnt + 1;
     #endif
 #endif
 
@@ -211,6 +229,8 @@ UInt32 g_req_per_query = REQ_PER_QUERY;
 bool g_strict_ppt = STRICT_PPT == 1;
 UInt32 g_field_per_tuple = FIELD_PER_TUPLE;
 UInt32 g_init_parallelism = INIT_PARALLELISM;
+UInt32 g_load_thread_cnt = LOAD_THREAD_CNT;
+UInt32 g_load_index_batch = LOAD_INDEX_BATCH;
 UInt32 g_client_node_cnt = CLIENT_NODE_CNT;
 UInt32 g_client_thread_cnt = CLIENT_THREAD_CNT;
 UInt32 g_client_rem_thread_cnt = CLIENT_REM_THREAD_CNT;
@@ -241,13 +261,21 @@ UInt32 g_network_delay = NETWORK_DELAY;
 UInt64 g_done_timer = DONE_TIMER;
 UInt64 g_batch_time_limit = BATCH_TIMER;
 UInt64 g_seq_batch_time_limit = SEQ_BATCH_TIMER;
+UInt64 g_seq_batch_time_min = SEQ_BATCH_TIMER_MIN;
 UInt64 g_prog_timer = PROG_TIMER;
 UInt64 g_warmup_timer = WARMUP_TIMER;
 UInt64 g_msg_time_limit = MSG_TIME_LIMIT;
+UInt64 g_msg_fin_piggyback = MSG_FIN_PIGGYBACK;
 UInt64 g_starttime=0;
 
 UInt64 g_log_buf_max = LOG_BUF_MAX;
 UInt64 g_log_flush_timeout = LOG_BUF_TIMEOUT;
+UInt64 g_log_buf_size = LOG_BUF_SIZE;
+UInt64 g_log_recover_thread_cnt = LOG_RECOVER_THREAD_CNT;
+UInt64 g_ckpt_interval = CKPT_INTERVAL;
+UInt64 g_ckpt_latency_bound = CKPT_LATENCY_BOUND;
+UInt64 g_ckpt_chunk_size = CKPT_CHUNK_SIZE;
+UInt64 g_ts_interval = TS_INTERVAL;
 
 // MVCC
 UInt64 g_max_read_req = MAX_READ_REQ;
@@ -256,6 +284,7 @@ UInt64 g_his_recycle_len = HIS_RECYCLE_LEN;
 
 // CALVIN
 UInt32 g_seq_thread_cnt = SEQ_THREAD_CNT;
+UInt32 g_calvin_lock_thread_cnt = CALVIN_LOCK_THREAD_CNT;
 
 // TICTOC
 uint32_t g_max_num_waits = MAX_NUM_WAITS;
@@ -268,6 +297,8 @@ UInt32 g_max_parts_per = MAX_PPS_PARTS_PER;
 UInt32 g_max_part_key = MAX_PPS_PART_KEY;
 UInt32 g_max_product_key = MAX_PPS_PRODUCT_KEY;
 UInt32 g_max_supplier_key = MAX_PPS_SUPPLIER_KEY;
+double g_pps_zipf_theta = PPS_ZIPF_THETA;
+double g_pps_part_affinity = PPS_PART_AFFINITY;
 double g_perc_getparts = PERC_PPS_GETPART;
 double g_perc_getproducts = PERC_PPS_GETPRODUCT;
 double g_perc_getsuppliers = PERC_PPS_GETSUPPLIER;
@@ -279,7 +310,17 @@ double g_perc_updatepart = PERC_PPS_UPDATEPART;
 
 // TPCC
 UInt32 g_num_wh = NUM_WH;
+#if TPCC_STD_MIX
+double g_perc_payment = 0.43;
+double g_perc_order_status = 0.04;
+double g_perc_delivery = 0.04;
+double g_perc_stock_level = 0.04;
+#else
 double g_perc_payment = PERC_PAYMENT;
+double g_perc_order_status = PERC_ORDER_STATUS;
+double g_perc_delivery = PERC_DELIVERY;
+double g_perc_stock_level = PERC_STOCK_LEVEL;
+#endif
 bool g_wh_update = WH_UPDATE;
 char * output_file = NULL;
 char * input_file = NULL;
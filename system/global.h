@@ -73,6 +73,7 @@ class ssi;
 class wsi;
 class Maat;
 class Dta;
+class Checkpointer;
 class Wkdb;
 class Tictoc;
 class Transport;
@@ -100,6 +101,9 @@ class DABlockQueue;
 class DtaTimeTable;
 class KeyXidCache;
 class RtsCache;
+class Placement;
+class AdmissionControl;
+class MsgTrace;
 class MigrateMessageQueue;
 // class QTcpQueue;
 
@@ -145,6 +149,7 @@ extern MigrateMessageQueue migmsg_queue;
 extern Client_txn client_man;
 extern Sequencer seq_man;
 extern Logger logger;
+extern Checkpointer checkpointer;
 extern TimeTable time_table;
 extern DtaTimeTable dta_time_table;
 extern KeyXidCache dta_key_xid_cache;
@@ -153,6 +158,9 @@ extern InOutTable inout_table;
 extern WkdbTimeTable wkdb_time_table;
 extern KeyXidCache wkdb_key_xid_cache;
 extern RtsCache wkdb_rts_cache;
+extern Placement placement;
+extern AdmissionControl admission;
+extern MsgTrace msg_trace;
 // extern QTcpQueue tcp_queue;
 
 extern map<string, string> g_params;
@@ -191,6 +199,8 @@ extern bool g_part_alloc;
 extern bool g_mem_pad;
 extern bool g_prt_lat_distr;
 extern UInt32 g_node_id;
+// seed of the node's generators, the recorded one when replaying a trace
+extern uint64_t g_seed;
 extern UInt32 g_node_cnt;
 extern UInt32 g_part_cnt;
 extern UInt32 g_virtual_part_cnt;
@@ -219,6 +229,7 @@ extern bool g_key_order;
 extern bool g_ts_batch_alloc;
 extern UInt32 g_ts_batch_num;
 extern int32_t g_inflight_max;
+extern UInt32 g_client_query_ring;
 
 extern std::vector<int32_t> g_node_inflight_max;
 extern void g_node_inflight_max_init();
@@ -227,6 +238,13 @@ extern void g_node_inflight_max_update(uint64_t node_id, int delta);
 extern uint64_t g_msg_size;
 extern uint64_t g_log_buf_max;
 extern uint64_t g_log_flush_timeout;
+extern uint64_t g_log_buf_size;
+extern uint64_t g_log_recover_thread_cnt;
+extern UInt32 g_checkpoint_thread_cnt;
+extern uint64_t g_ckpt_interval;
+extern uint64_t g_ckpt_latency_bound;
+extern uint64_t g_ckpt_chunk_size;
+extern uint64_t g_ts_interval;
 
 extern UInt32 g_max_txn_per_part;
 extern int32_t g_load_per_server;
@@ -236,9 +254,11 @@ extern UInt32 g_network_delay;
 extern UInt64 g_done_timer;
 extern UInt64 g_batch_time_limit;
 extern UInt64 g_seq_batch_time_limit;
+extern UInt64 g_seq_batch_time_min;
 extern UInt64 g_prog_timer;
 extern UInt64 g_warmup_timer;
 extern UInt64 g_msg_time_limit;
+extern UInt64 g_msg_fin_piggyback;
 extern UInt64 g_starttime;
 
 // MVCC
@@ -256,6 +276,9 @@ extern double g_txn_write_perc;
 extern double g_tup_read_perc;
 extern double g_tup_write_perc;
 extern double g_zipf_theta;
+extern uint64_t g_shift_interval;
+extern uint64_t g_shift_drift_rate;
+extern uint64_t g_shift_jump_keys;
 extern double g_data_perc;
 extern double g_access_perc;
 extern UInt64 g_synth_table_size;
@@ -263,12 +286,17 @@ extern UInt32 g_req_per_query;
 extern bool g_strict_ppt;
 extern UInt32 g_field_per_tuple;
 extern UInt32 g_init_parallelism;
+extern UInt32 g_load_thread_cnt;
+extern UInt32 g_load_index_batch;
 extern double g_mpr;
 extern double g_mpitem;
 
 // TPCC
 extern UInt32 g_num_wh;
 extern double g_perc_payment;
+extern double g_perc_order_status;
+extern double g_perc_delivery;
+extern double g_perc_stock_level;
 extern bool g_wh_update;
 extern char * output_file;
 extern char * input_file;
@@ -284,6 +312,8 @@ extern UInt32 g_max_parts_per;
 extern UInt32 g_max_part_key;
 extern UInt32 g_max_product_key;
 extern UInt32 g_max_supplier_key;
+extern double g_pps_zipf_theta;
+extern double g_pps_part_affinity;
 extern double g_perc_getparts;
 extern double g_perc_getproducts;
 extern double g_perc_getsuppliers;
@@ -306,6 +336,7 @@ extern ofstream commit_file;
 extern ofstream abort_file;
 // CALVIN
 extern UInt32 g_seq_thread_cnt;
+extern UInt32 g_calvin_lock_thread_cnt;
 
 // TICTOC
 extern uint32_t g_max_num_waits;
@@ -547,6 +578,39 @@ extern int synctime;
 #define IS_LOCAL(tid) (tid % g_node_cnt == g_node_id || CC_ALG == CALVIN)
 #define IS_REMOTE(tid) (tid % g_node_cnt != g_node_id || CC_ALG == CALVIN)
 #define IS_LOCAL_KEY(key) (GET_NODE_ID(key_to_part(key)) == g_node_id)
+// a participant that only read has nothing left to validate once the txn holds all its locks
+#define TWOPC_OPT_CC \
+  (TWOPC_OPT && (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT))
+#define CLV_CC (CLV && (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE))
+// the lock-based algorithms the build can run, g_cc_alg picks one of them
+#define NO_WAIT_CC (CC_ALG == NO_WAIT || CC_ALG_RUNTIME)
+#define WAIT_DIE_CC (CC_ALG == WAIT_DIE || CC_ALG_RUNTIME)
+#define ROW_LOCK_WORD_CC \
+  (ROW_LOCK_WORD && !CENTRAL_MAN && !CLV_CC && (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE))
+// [TPCC] share of payment and order-status customers selected by last name, in percent
+#define PERC_BY_LAST_NAME (TPCC_STD_MIX ? 60 : 0)
+// Calvin and DA txns do not start from the work queue
+#if ADMISSION_CONTROL && !defined(NEW_WORK_QUEUE) && !SERVER_GENERATE_QUERIES && \
+    CC_ALG != CALVIN && WORKLOAD != DA
+#define ADMISSION_CC true
+#else
+#define ADMISSION_CC false
+#endif
+// the log only holds what changed since the last checkpoint
+#if LOG_RECOVER && !CKPT_LOAD
+#error "LOG_RECOVER replays the log over a checkpoint and needs CKPT_LOAD"
+#endif
+// H-Store writes in place under partition locks the checkpointer cannot see
+#if CHECKPOINT && (CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC)
+#error "CHECKPOINT does not support HSTORE and HSTORE_SPEC"
+#endif
+// only Row_lock is built for both, the rest of the engine follows CC_ALG
+#if CC_ALG_RUNTIME && CC_ALG != NO_WAIT && CC_ALG != WAIT_DIE
+#error "CC_ALG_RUNTIME switches between NO_WAIT and WAIT_DIE, CC_ALG must be one of them"
+#endif
+#if CC_ALG_RUNTIME && CLV_CC
+#error "CC_ALG_RUNTIME does not support CLV"
+#endif
 
 /*
 #define GET_THREAD_ID(id)	(id % g_thread_cnt)
@@ -20,6 +20,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <stdint.h>
+#include <sched.h>
 #include "global.h"
 
 /************************************************/
@@ -67,6 +68,17 @@
 #define COMPILER_BARRIER asm volatile("" ::: "memory");
 #define PAUSE_SILO { __asm__ ( "pause;" ); }
 
+// Backoff between two failed tries on a row latch word: spin a few pauses
+// more each time, then give the cpu away once LATCH_SPIN_CNT tries are spent.
+inline void latch_backoff(uint32_t &tries) {
+  if (tries < LATCH_SPIN_CNT) {
+    for (uint32_t i = 0; i < (1U << (tries / 2)); i++) PAUSE_SILO
+    tries++;
+  } else {
+    sched_yield();
+  }
+}
+
 /************************************************/
 // ASSERT Helper
 /************************************************/
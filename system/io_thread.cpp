@@ -32,6 +32,7 @@
 #include "work_queue.h"
 #include "txn.h"
 #include "ycsb.h"
+#include "client_query.h"
 
 void InputThread::setup() {
 
@@ -306,6 +307,9 @@ RC InputThread::client_recv_loop() {
 				INC_STATS_ARR(get_thd_id(),client_client_latency, timespan);
 			}
 			//INC_STATS_ARR(get_thd_id(),all_lat,timespan);
+#if STREAM_QUERIES
+			client_query_queue.query_done(((ClientResponseMessage*)msg)->client_qid);
+#endif
 			inf = client_man.dec_inflight(return_node_offset);
 			DEBUG("Recv %ld from %ld, %ld -- %f\n", ((ClientResponseMessage *)msg)->txn_id,
 						msg->return_node_id, inf, float(timespan) / BILLION);
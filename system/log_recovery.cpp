@@ -0,0 +1,237 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "log_recovery.h"
+#include "logger.h"
+#include "helper.h"
+#include "wl.h"
+#include "table.h"
+#include "catalog.h"
+#include "row.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void LogRecovery::init(Workload * wl, const char * log_file) {
+  this->wl = wl;
+  this->log_file = log_file;
+  log_data = NULL;
+  log_size = 0;
+  start_epoch = 0;
+  next_lsn = 0;
+  next_epoch = 0;
+  record_cnt = 0;
+  apply_cnt = 0;
+  skip_cnt = 0;
+  torn_cnt = 0;
+  torn_block = UINT64_MAX;
+  scan_cnt = g_log_recover_thread_cnt;
+  for (auto it = wl->tables.begin(); it != wl->tables.end(); it++) {
+    tables[it->second->get_table_id()] = it->second;
+  }
+}
+
+RC LogRecovery::recover() {
+  uint64_t starttime = get_server_clock();
+  int fd = open(log_file, O_RDONLY);
+  if (fd < 0) {
+    printf("Recovery: no log file %s\n", log_file);
+    return RCOK;
+  }
+  struct stat st;
+  fstat(fd, &st);
+  log_size = st.st_size;
+  if (log_size == 0) {
+    close(fd);
+    printf("Recovery: empty log\n");
+    return RCOK;
+  }
+  log_data = (char *)mmap(NULL, log_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  assert(log_data != MAP_FAILED);
+  madvise(log_data, log_size, MADV_SEQUENTIAL);
+
+  // 1. block index; a block cut short by the crash ends the log
+  uint64_t offset = 0;
+  while (offset + sizeof(LogBlockHeader) <= log_size) {
+    LogBlockHeader header;
+    memcpy(&header, &log_data[offset], sizeof(header));
+    if (header.magic != LOG_BLOCK_MAGIC ||
+        offset + sizeof(header) + header.size > log_size) {
+      torn_cnt++;
+      break;
+    }
+    if (header.epoch >= start_epoch)
+      blocks.push_back(std::make_pair(offset + sizeof(header), header.size));
+    next_epoch = std::max(next_epoch, header.epoch + 1);
+    offset += sizeof(header) + header.size;
+  }
+  uint64_t index_time = get_server_clock();
+
+  // 2. parallel scan
+  scanned.resize(scan_cnt);
+  scan_next_lsn.resize(scan_cnt, 0);
+  for (uint64_t i = 0; i < scan_cnt; i++) scanned[i].resize(g_part_cnt);
+  pthread_t * p_thds = new pthread_t[std::max(scan_cnt, (uint64_t)g_part_cnt)];
+  recovery_args * args = new recovery_args[std::max(scan_cnt, (uint64_t)g_part_cnt)];
+  for (uint64_t i = 0; i < scan_cnt; i++) {
+    args[i].rcv = this;
+    args[i].id = i;
+    pthread_create(&p_thds[i], NULL, threadScan, &args[i]);
+  }
+  for (uint64_t i = 0; i < scan_cnt; i++) pthread_join(p_thds[i], NULL);
+  for (uint64_t i = 0; i < scan_cnt; i++) next_lsn = std::max(next_lsn, scan_next_lsn[i]);
+  uint64_t scan_time = get_server_clock();
+
+  // 3. one apply thread per partition that has records
+  std::vector<uint64_t> parts;
+  for (uint64_t p = 0; p < g_part_cnt; p++) {
+    for (uint64_t i = 0; i < scan_cnt; i++) {
+      if (!scanned[i][p].empty()) {
+        parts.push_back(p);
+        break;
+      }
+    }
+  }
+  for (uint64_t i = 0; i < parts.size(); i++) {
+    args[i].rcv = this;
+    args[i].id = parts[i];
+    pthread_create(&p_thds[i], NULL, threadApply, &args[i]);
+  }
+  for (uint64_t i = 0; i < parts.size(); i++) pthread_join(p_thds[i], NULL);
+  uint64_t endtime = get_server_clock();
+
+  delete[] p_thds;
+  delete[] args;
+  scanned.clear();
+  munmap(log_data, log_size);
+  close(fd);
+
+  double total_sec = (double)(endtime - starttime) / BILLION;
+  printf("Recovery: log_bytes=%ld, blocks=%ld, records=%ld, applied=%ld, skipped=%ld, torn=%ld, "
+         "partitions=%ld, next_lsn=%ld, next_epoch=%ld\n",
+         log_size, blocks.size(), record_cnt, apply_cnt, skip_cnt, torn_cnt, parts.size(), next_lsn,
+         next_epoch);
+  printf("Recovery: index_time=%f, scan_time=%f, apply_time=%f, total_time=%f, "
+         "throughput=%f MB/s\n",
+         (double)(index_time - starttime) / BILLION, (double)(scan_time - index_time) / BILLION,
+         (double)(endtime - scan_time) / BILLION, total_sec,
+         total_sec > 0 ? (double)log_size / 1024 / 1024 / total_sec : 0);
+  fflush(stdout);
+  return RCOK;
+}
+
+// Records of a transaction are contiguous and end with its commit record; an
+// incomplete transaction ends the block, a record failing its checksum ends the log.
+void LogRecovery::scan_block(uint64_t scan_id, uint64_t block_id) {
+  uint64_t ptr = blocks[block_id].first;
+  uint64_t end = ptr + blocks[block_id].second;
+  std::vector<std::pair<uint64_t, RecoveryEntry> > pending;
+  uint64_t pending_txn = UINT64_MAX;
+  uint64_t cnt = 0;
+  while (ptr + sizeof(AriesLogRecord) <= end) {
+    LogRecord record;
+    memcpy(&record.rcd, &log_data[ptr], sizeof(AriesLogRecord));
+    uint64_t rec_size = Logger::getRecordSize(record.rcd.before_image_size,
+                                              record.rcd.after_image_size);
+    if (ptr + rec_size > end) break;
+    const char * before = &log_data[ptr + sizeof(AriesLogRecord)];
+    const char * after = before + record.rcd.before_image_size;
+    if (record.computeChecksum(before, after) != record.rcd.checksum) {
+      ATOM_ADD(torn_cnt, 1);
+      uint64_t torn = torn_block;
+      while (block_id < torn && !ATOM_CAS(torn_block, torn, block_id)) torn = torn_block;
+      break;
+    }
+    cnt++;
+    if (record.rcd.lsn + 1 > scan_next_lsn[scan_id]) scan_next_lsn[scan_id] = record.rcd.lsn + 1;
+
+    if (record.rcd.iud == L_NOTIFY) {
+      if (record.rcd.txn_id == pending_txn) {
+        for (auto it = pending.begin(); it != pending.end(); it++)
+          scanned[scan_id][it->first].push_back(it->second);
+      }
+      pending.clear();
+      pending_txn = UINT64_MAX;
+    } else {
+      if (record.rcd.txn_id != pending_txn) pending.clear();
+      pending_txn = record.rcd.txn_id;
+      RecoveryEntry entry;
+      entry.lsn = record.rcd.lsn;
+      entry.block = block_id;
+      entry.rec = &log_data[ptr];
+      pending.push_back(std::make_pair(record.rcd.part_id % g_part_cnt, entry));
+    }
+    ptr += rec_size;
+  }
+  ATOM_ADD(record_cnt, cnt);
+}
+
+void LogRecovery::apply_part(uint64_t part_id) {
+  std::vector<RecoveryEntry> entries;
+  for (uint64_t i = 0; i < scan_cnt; i++)
+    entries.insert(entries.end(), scanned[i][part_id].begin(), scanned[i][part_id].end());
+  std::sort(entries.begin(), entries.end(),
+            [](const RecoveryEntry &a, const RecoveryEntry &b) { return a.lsn < b.lsn; });
+
+  uint64_t applied = 0;
+  uint64_t skipped = 0;
+  for (auto it = entries.begin(); it != entries.end(); it++) {
+    AriesLogRecord rcd;
+    memcpy(&rcd, it->rec, sizeof(rcd));
+    const char * before = it->rec + sizeof(rcd);
+    const char * after = before + rcd.before_image_size;
+    auto tab = tables.find(rcd.table_id);
+    if (it->block > torn_block || tab == tables.end()) {
+      skipped++;
+      continue;
+    }
+    table_t * table = tab->second;
+    uint64_t tuple_size = table->get_schema()->get_tuple_size();
+    RC rc = ERROR;
+    if (rcd.iud == L_INSERT && rcd.after_image_size == tuple_size) {
+      rc = wl->recovery_insert(table, rcd.key, rcd.part_id, after);
+    } else if (rcd.iud == L_DELETE && rcd.before_image_size == tuple_size) {
+      rc = wl->recovery_delete(table, rcd.key, rcd.part_id, before);
+    } else if (rcd.iud == L_UPDATE && rcd.after_image_size == tuple_size) {
+      row_t * row = wl->get_recovery_row(table, rcd.key, rcd.part_id, after);
+      if (row != NULL) {
+        memcpy(row->get_data(), after, tuple_size);
+        rc = RCOK;
+      }
+    }
+    if (rc == RCOK)
+      applied++;
+    else
+      skipped++;
+  }
+  ATOM_ADD(apply_cnt, applied);
+  ATOM_ADD(skip_cnt, skipped);
+}
+
+void * LogRecovery::threadScan(void * args) {
+  LogRecovery * rcv = ((recovery_args *)args)->rcv;
+  uint64_t id = ((recovery_args *)args)->id;
+  for (uint64_t b = id; b < rcv->blocks.size(); b += rcv->scan_cnt) rcv->scan_block(id, b);
+  return NULL;
+}
+
+void * LogRecovery::threadApply(void * args) {
+  LogRecovery * rcv = ((recovery_args *)args)->rcv;
+  rcv->apply_part(((recovery_args *)args)->id);
+  return NULL;
+}
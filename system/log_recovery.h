@@ -0,0 +1,86 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _LOG_RECOVERY_H_
+#define _LOG_RECOVERY_H_
+
+#include "global.h"
+
+class Workload;
+class table_t;
+
+// A redo record located in the mapped log file
+struct RecoveryEntry {
+  uint64_t lsn;
+  uint64_t block;
+  const char * rec;
+};
+
+/*
+   Parallel redo of the log written by Logger.
+   1. index the log blocks (headers only)
+   2. scan blocks in parallel, keep only records of committed transactions and
+      partition them by part_id
+   3. apply each partition in lsn order with one thread per partition
+   The first block cut short or holding a record that fails its checksum ends
+   the log: nothing written after it is replayed.
+*/
+class LogRecovery {
+public:
+  void init(Workload * wl, const char * log_file);
+  RC recover();
+  // only blocks of epoch >= start_epoch are replayed (set by a checkpoint load)
+  void set_start_epoch(uint64_t epoch) { start_epoch = epoch; }
+  // first lsn and epoch not used by the replayed log
+  uint64_t get_next_lsn() { return next_lsn; }
+  uint64_t get_next_epoch() { return next_epoch; }
+
+private:
+  void scan_block(uint64_t scan_id, uint64_t block_id);
+  void apply_part(uint64_t part_id);
+  static void * threadScan(void * args);
+  static void * threadApply(void * args);
+
+  Workload * wl;
+  const char * log_file;
+  char * log_data;
+  uint64_t log_size;
+  uint64_t start_epoch;
+  uint64_t next_lsn;
+  uint64_t next_epoch;
+
+  std::map<uint32_t, table_t *> tables;
+  // (offset, size) of the records of each block
+  std::vector<std::pair<uint64_t, uint64_t> > blocks;
+  uint64_t scan_cnt;
+  // [scan thread][part] -> committed records
+  std::vector<std::vector<std::vector<RecoveryEntry> > > scanned;
+  std::vector<uint64_t> scan_next_lsn;
+
+  volatile uint64_t record_cnt;
+  volatile uint64_t apply_cnt;
+  volatile uint64_t skip_cnt;
+  volatile uint64_t torn_cnt;
+  // first block with a bad record; later blocks are not replayed
+  volatile uint64_t torn_block;
+};
+
+struct recovery_args {
+  LogRecovery * rcv;
+  uint64_t id;
+};
+
+#endif
@@ -26,8 +26,11 @@ RC LogThread::run() {
   tsetup();
 	while (!simulation->is_done()) {
     logger.processRecord(get_thd_id());
-    //logger.flushBufferCheck();
+    logger.flushBufferCheck(get_thd_id());
+    logger.truncateCheck(get_thd_id());
   }
+  // make the last open epoch durable before shutting down
+  logger.flushBuffer(get_thd_id());
   return FINISH;
 
 }
@@ -2,17 +2,79 @@
 #include "work_queue.h"
 #include "message.h"
 #include "mem_alloc.h"
+#include "placement.h"
 #include <fstream>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
+void LogBuffer::init(uint64_t size) {
+  this->size = size;
+  for (uint32_t i = 0; i < 2; i++) {
+    data[i] = (char *)mem_allocator.align_alloc(size);
+    offset[i] = 0;
+    waiters[i] = new std::vector<std::pair<uint64_t, uint64_t> >();
+    large[i] = new std::vector<std::pair<char *, uint64_t> >();
+  }
+  large_buf = NULL;
+  active = 0;
+  pthread_mutex_init(&latch, NULL);
+}
+
+void LogBuffer::release() {
+  for (uint32_t i = 0; i < 2; i++) {
+    mem_allocator.free(data[i], size);
+    delete waiters[i];
+    for (auto it = large[i]->begin(); it != large[i]->end(); it++) free(it->first);
+    delete large[i];
+  }
+  pthread_mutex_destroy(&latch);
+}
+
 void Logger::init(const char * log_file_name) {
   this->log_file_name = log_file_name;
-  log_file.open(log_file_name, ios::out | ios::app | ios::binary);
-  assert(log_file.is_open());
+  log_fd = open(log_file_name, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  assert(log_fd >= 0);
   pthread_mutex_init(&mtx,NULL);
+  lsn = 0;
+  epoch = 0;
+  durable_lsn = 0;
+  pending_commit_cnt = 0;
+  truncate_epoch = 0;
+  install_epoch = new uint64_t[g_total_thread_cnt];
+  for (uint64_t i = 0; i < g_total_thread_cnt; i++) install_epoch[i] = UINT64_MAX;
+  last_flush = get_sys_clock();
+  // one buffer per worker; replica records are staged by the log thread in buffer 0
+  buffer_cnt = g_thread_cnt;
+  buffers = new LogBuffer[buffer_cnt];
+  for (uint64_t i = 0; i < buffer_cnt; i++) buffers[i].init(g_log_buf_size);
 }
 
-void Logger::release() { log_file.close(); }
+void Logger::bindBuffer(uint64_t thd_id) {
+  if (thd_id >= buffer_cnt) return;
+  LogBuffer &buf = buffers[thd_id];
+  placement.bind_memory(buf.data[0], buf.size, thd_id);
+  placement.bind_memory(buf.data[1], buf.size, thd_id);
+}
+
+void Logger::release() {
+  for (uint64_t i = 0; i < buffer_cnt; i++) buffers[i].release();
+  delete[] buffers;
+  delete[] install_epoch;
+  close(log_fd);
+}
+
+// Records appended during epoch e go into blocks of epoch e + 1 or later.
+uint64_t Logger::get_install_epoch() {
+  uint64_t min_epoch = epoch;
+  for (uint64_t i = 0; i < g_total_thread_cnt; i++) {
+    uint64_t e = install_epoch[i];
+    if (e < min_epoch) min_epoch = e;
+  }
+  return min_epoch;
+}
 
 LogRecord* Logger::createRecord(uint64_t txn_id, LogIUD iud, uint64_t table_id, uint64_t key) {
   LogRecord * record = (LogRecord*)mem_allocator.alloc(sizeof(LogRecord));
@@ -38,10 +100,25 @@ void LogRecord::copyRecord(LogRecord* record) {
   rcd.iud = record->rcd.iud;
   rcd.type = record->rcd.type;
   rcd.txn_id = record->rcd.txn_id;
+  rcd.part_id = record->rcd.part_id;
   rcd.table_id = record->rcd.table_id;
   rcd.key = record->rcd.key;
+  rcd.checksum = record->rcd.checksum;
 }
 
+// FNV-1a over the header fields and both images
+uint32_t LogRecord::computeChecksum(const char * before, const char * after) {
+  uint32_t hash = 2166136261U;
+  uint64_t fields[4] = {rcd.lsn, rcd.txn_id, rcd.key,
+                        ((uint64_t)rcd.table_id << 32) | rcd.part_id};
+  const char * f = (const char *)fields;
+  for (uint64_t i = 0; i < sizeof(fields); i++) hash = (hash ^ (uint8_t)f[i]) * 16777619U;
+  for (uint64_t i = 0; i < rcd.before_image_size; i++)
+    hash = (hash ^ (uint8_t)before[i]) * 16777619U;
+  for (uint64_t i = 0; i < rcd.after_image_size; i++)
+    hash = (hash ^ (uint8_t)after[i]) * 16777619U;
+  return hash;
+}
 
 void Logger::enqueueRecord(LogRecord* record) {
   DEBUG("Enqueue Log Record %ld\n",record->rcd.txn_id);
@@ -50,6 +127,8 @@ void Logger::enqueueRecord(LogRecord* record) {
   pthread_mutex_unlock(&mtx);
 }
 
+// Records shipped from a primary (replication). They carry no images; the
+// commit record is acknowledged once the epoch holding it is durable.
 void Logger::processRecord(uint64_t thd_id) {
   if (log_queue.empty()) return;
   LogRecord * record = NULL;
@@ -63,93 +142,229 @@ void Logger::processRecord(uint64_t thd_id) {
   if(record) {
     uint64_t starttime = get_sys_clock();
     DEBUG("Dequeue Log Record %ld\n",record->rcd.txn_id);
-    if(record->rcd.iud == L_NOTIFY) {
-      flushBuffer(thd_id);
-      work_queue.enqueue(thd_id,Message::create_message(record->rcd.txn_id,LOG_FLUSHED),false);
-
-    }
-    writeToBuffer(thd_id,record);
-    //writeToBuffer((char*)(&record->rcd),sizeof(record->rcd));
-    log_buf_cnt++;
+    uint64_t size = getRecordSize(0, 0);
+    char * buf = reserveBuffer(0, size);
+    uint64_t ptr = 0;
+    writeRecord(buf, ptr, record->rcd.txn_id, record->rcd.iud, record->rcd.part_id,
+                record->rcd.table_id, record->rcd.key, NULL, 0, NULL, 0);
+    releaseBuffer(0, size, record->rcd.iud == L_NOTIFY ? record->rcd.txn_id : UINT64_MAX);
     mem_allocator.free(record,sizeof(LogRecord));
     INC_STATS(thd_id,log_process_time,get_sys_clock() - starttime);
   }
 
 }
 
-uint64_t Logger::reserveBuffer(uint64_t size) { return ATOM_FETCH_ADD(aries_write_offset, size); }
-
-//void Logger::writeToBuffer(char * data, uint64_t offset, uint64_t size) {
-void Logger::writeToBuffer(uint64_t thd_id, char * data, uint64_t size) {
-  //memcpy(aries_log_buffer + offset, data, size);
-  //aries_write_offset += size;
-  uint64_t starttime = get_sys_clock();
-  log_file.write(data,size);
-  INC_STATS(thd_id,log_write_time,get_sys_clock() - starttime);
-  INC_STATS(thd_id,log_write_cnt,1);
-
+uint64_t Logger::getRecordSize(uint64_t before_size, uint64_t after_size) {
+  return sizeof(AriesLogRecord) + before_size + after_size;
 }
 
-void Logger::notify_on_sync(uint64_t txn_id) {
-  LogRecord * record = (LogRecord*)mem_allocator.alloc(sizeof(LogRecord));
-  record->rcd.init();
-  record->rcd.txn_id = txn_id;
-  record->rcd.iud = L_NOTIFY;
-  enqueueRecord(record);
+char * Logger::reserveBuffer(uint64_t thd_id, uint64_t size) {
+  LogBuffer * lbuf = &buffers[thd_id % buffer_cnt];
+  if (size > lbuf->size) {
+    // never fits: the transaction becomes a block of its own
+    pthread_mutex_lock(&lbuf->latch);
+    assert(lbuf->large_buf == NULL);
+    lbuf->large_buf = (char *)malloc(size);
+    INC_STATS(thd_id,log_buf_large_cnt,1);
+    return lbuf->large_buf;
+  }
+  while (true) {
+    pthread_mutex_lock(&lbuf->latch);
+    uint32_t cur = lbuf->active;
+    if (lbuf->offset[cur] + size <= lbuf->size) {
+      return lbuf->data[cur] + lbuf->offset[cur];
+    }
+    // active half is full: wait for the log thread to close the epoch
+    pthread_mutex_unlock(&lbuf->latch);
+    INC_STATS(thd_id,log_buf_full_cnt,1);
+    usleep(10);
+  }
 }
 
-void Logger::writeToBuffer(uint64_t thd_id, LogRecord * record) {
-  DEBUG("Buffer Write\n");
-  //memcpy(aries_log_buffer + offset, data, size);
-  //aries_write_offset += size;
-  uint64_t starttime = get_sys_clock();
-#if LOG_COMMAND
-
-  WRITE_VAL(log_file,record->rcd.checksum);
-  WRITE_VAL(log_file,record->rcd.lsn);
-  WRITE_VAL(log_file,record->rcd.type);
-  WRITE_VAL(log_file,record->rcd.txn_id);
-  //WRITE_VAL(log_file,record->rcd.partid);
-#if WORKLOAD == TPCC
-  WRITE_VAL(log_file,record->rcd.txntype);
-#endif
-  WRITE_VAL_SIZE(log_file,record->rcd.params,record->rcd.params_size);
-
-#else
-
-  WRITE_VAL(log_file,record->rcd.checksum);
-  WRITE_VAL(log_file,record->rcd.lsn);
-  WRITE_VAL(log_file,record->rcd.type);
-  WRITE_VAL(log_file,record->rcd.iud);
-  WRITE_VAL(log_file,record->rcd.txn_id);
-  //WRITE_VAL(log_file,record->rcd.partid);
-  WRITE_VAL(log_file,record->rcd.table_id);
-  WRITE_VAL(log_file,record->rcd.key);
-  /*
-  WRITE_VAL(log_file,record->rcd.n_cols);
-  WRITE_VAL(log_file,record->rcd.cols);
-  WRITE_VAL_SIZE(log_file,record->rcd.before_image,record->rcd.before_image_size);
-  WRITE_VAL_SIZE(log_file,record->rcd.after_image,record->rcd.after_image_size);
-  */
-
-#endif
-  INC_STATS(thd_id,log_write_time,get_sys_clock() - starttime);
+void Logger::writeRecord(char * buf, uint64_t &ptr, uint64_t txn_id, LogIUD iud, uint64_t part_id,
+                         uint64_t table_id, uint64_t key, const char * before,
+                         uint64_t before_size, const char * after, uint64_t after_size) {
+  LogRecord record;
+  record.rcd.init();
+  record.rcd.lsn = ATOM_FETCH_ADD(lsn,1);
+  record.rcd.type = iud == L_INSERT ? LRT_INSERT : (iud == L_DELETE ? LRT_DELETE : LRT_UPDATE);
+  record.rcd.iud = iud;
+  record.rcd.txn_id = txn_id;
+  record.rcd.part_id = part_id;
+  record.rcd.table_id = table_id;
+  record.rcd.key = key;
+  record.rcd.before_image_size = before_size;
+  record.rcd.after_image_size = after_size;
+  record.rcd.checksum = record.computeChecksum(before, after);
+  COPY_BUF(buf,record.rcd,ptr);
+  if (before_size > 0) {
+    memcpy(&buf[ptr], before, before_size);
+    ptr += before_size;
+  }
+  if (after_size > 0) {
+    memcpy(&buf[ptr], after, after_size);
+    ptr += after_size;
+  }
+}
 
+void Logger::releaseBuffer(uint64_t thd_id, uint64_t size, uint64_t txn_id) {
+  LogBuffer * lbuf = &buffers[thd_id % buffer_cnt];
+  uint32_t cur = lbuf->active;
+  if (lbuf->large_buf) {
+    lbuf->large[cur]->push_back(std::make_pair(lbuf->large_buf, size));
+    lbuf->large_buf = NULL;
+  } else {
+    lbuf->offset[cur] += size;
+  }
+  if (txn_id != UINT64_MAX) {
+    lbuf->waiters[cur]->push_back(std::make_pair(txn_id, get_sys_clock()));
+    ATOM_ADD(pending_commit_cnt, 1);
+  }
+  pthread_mutex_unlock(&lbuf->latch);
+  INC_STATS(thd_id,log_write_cnt,1);
+  INC_STATS(thd_id,log_write_bytes,size);
 }
 
 void Logger::flushBufferCheck(uint64_t thd_id) {
-  if(log_buf_cnt >= g_log_buf_max || get_sys_clock() - last_flush > g_log_flush_timeout) {
+  if(pending_commit_cnt >= g_log_buf_max || get_sys_clock() - last_flush > g_log_flush_timeout) {
     flushBuffer(thd_id);
   }
 }
 
+// Close the current epoch: swap every worker buffer, write the closed halves,
+// make them durable with a single fdatasync, then acknowledge their commits.
 void Logger::flushBuffer(uint64_t thd_id) {
   DEBUG("Flush Buffer\n");
   uint64_t starttime = get_sys_clock();
-  log_file.flush();
-  INC_STATS(thd_id,log_flush_time,get_sys_clock() - starttime);
+  uint64_t flush_lsn = lsn;
+  std::vector<uint32_t> closed(buffer_cnt);
+  for (uint64_t i = 0; i < buffer_cnt; i++) {
+    pthread_mutex_lock(&buffers[i].latch);
+    closed[i] = buffers[i].active;
+    buffers[i].active = 1 - buffers[i].active;
+    pthread_mutex_unlock(&buffers[i].latch);
+  }
+  ATOM_ADD(epoch, 1);
+
+  uint64_t bytes = 0;
+  for (uint64_t i = 0; i < buffer_cnt; i++) {
+    LogBuffer * lbuf = &buffers[i];
+    uint64_t size = lbuf->offset[closed[i]];
+    if (size > 0) {
+      if (!writeBlock(i, lbuf->data[closed[i]], size)) logFailed("write");
+      bytes += sizeof(LogBlockHeader) + size;
+    }
+    std::vector<std::pair<char *, uint64_t> > * large = lbuf->large[closed[i]];
+    for (auto it = large->begin(); it != large->end(); it++) {
+      if (!writeBlock(i, it->first, it->second)) logFailed("write");
+      bytes += sizeof(LogBlockHeader) + it->second;
+    }
+  }
+  INC_STATS(thd_id,log_write_time,get_sys_clock() - starttime);
+
+  uint64_t synctime = get_sys_clock();
+  // after a failed fdatasync the dirty pages may be gone, so it is not retried:
+  // a retry could report success for writes that were lost
+  if (bytes > 0 && fdatasync(log_fd) != 0) logFailed("fdatasync");
+  uint64_t now = get_sys_clock();
+  durable_lsn = flush_lsn;
+  INC_STATS(thd_id,log_flush_time,now - synctime);
   INC_STATS(thd_id,log_flush_cnt,1);
 
+  for (uint64_t i = 0; i < buffer_cnt; i++) {
+    LogBuffer * lbuf = &buffers[i];
+    std::vector<std::pair<uint64_t, uint64_t> > * waiters = lbuf->waiters[closed[i]];
+    for (auto it = waiters->begin(); it != waiters->end(); it++) {
+      work_queue.enqueue(thd_id,Message::create_message(it->first,LOG_FLUSHED),false);
+      INC_STATS(thd_id,log_commit_cnt,1);
+      INC_STATS(thd_id,log_commit_time,now - it->second);
+    }
+    ATOM_SUB(pending_commit_cnt, waiters->size());
+    waiters->clear();
+    lbuf->offset[closed[i]] = 0;
+    std::vector<std::pair<char *, uint64_t> > * large = lbuf->large[closed[i]];
+    for (auto it = large->begin(); it != large->end(); it++) free(it->first);
+    large->clear();
+  }
+
   last_flush = get_sys_clock();
-  log_buf_cnt = 0;
+}
+
+// The closed epoch cannot be made durable: stop before any of its commits is
+// acknowledged.
+void Logger::logFailed(const char * op) {
+  printf("Log %s failed (%s), epoch %ld is not durable\n", op, strerror(errno), epoch);
+  fflush(stdout);
+  exit(1);
+}
+
+// Append one block; false on a write error other than an interrupt.
+bool Logger::writeBlock(uint32_t buffer_id, const char * data, uint64_t size) {
+  LogBlockHeader header;
+  header.magic = LOG_BLOCK_MAGIC;
+  header.buffer_id = buffer_id;
+  header.epoch = epoch;
+  header.size = size;
+  const char * parts[2] = {(const char *)&header, data};
+  uint64_t sizes[2] = {sizeof(header), size};
+  for (uint32_t p = 0; p < 2; p++) {
+    uint64_t written = 0;
+    while (written < sizes[p]) {
+      ssize_t rc = write(log_fd, parts[p] + written, sizes[p] - written);
+      if (rc < 0 && errno == EINTR) continue;
+      if (rc <= 0) return false;
+      written += rc;
+    }
+  }
+  return true;
+}
+
+void Logger::truncateCheck(uint64_t thd_id) {
+  uint64_t trunc = truncate_epoch;
+  if (trunc == 0 || !ATOM_CAS(truncate_epoch, trunc, 0)) return;
+  uint64_t starttime = get_sys_clock();
+  int fd = open(log_file_name, O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  fstat(fd, &st);
+  uint64_t size = st.st_size;
+  // blocks are appended in epoch order
+  uint64_t offset = 0;
+  LogBlockHeader header;
+  while (offset + sizeof(header) <= size) {
+    ssize_t rc = pread(fd, &header, sizeof(header), offset);
+    if (rc != sizeof(header) || header.magic != LOG_BLOCK_MAGIC || header.epoch >= trunc) break;
+    offset += sizeof(header) + header.size;
+  }
+  if (offset == 0) {
+    close(fd);
+    return;
+  }
+  offset = offset > size ? size : offset;
+
+  std::string tmp_name = std::string(log_file_name) + ".tmp";
+  int tmp_fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  // on any error the log is kept whole and truncated by a later checkpoint
+  bool ok = tmp_fd >= 0;
+  std::vector<char> buf(g_log_buf_size);
+  for (uint64_t pos = offset; ok && pos < size;) {
+    ssize_t rc = pread(fd, buf.data(), std::min((uint64_t)buf.size(), size - pos), pos);
+    ok = rc > 0 && write(tmp_fd, buf.data(), rc) == rc;
+    pos += rc;
+  }
+  ok = ok && fdatasync(tmp_fd) == 0;
+  if (tmp_fd >= 0) close(tmp_fd);
+  close(fd);
+  if (!ok || rename(tmp_name.c_str(), log_file_name) != 0) {
+    printf("Log truncation failed (%s), keeping %s\n", strerror(errno), log_file_name);
+    fflush(stdout);
+    unlink(tmp_name.c_str());
+    return;
+  }
+  close(log_fd);
+  log_fd = open(log_file_name, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (log_fd < 0) logFailed("open");
+  INC_STATS(thd_id,log_truncate_cnt,1);
+  INC_STATS(thd_id,log_truncate_bytes,offset);
+  INC_STATS(thd_id,log_truncate_time,get_sys_clock() - starttime);
 }
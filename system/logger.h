@@ -6,6 +6,7 @@
 #include "concurrentqueue.h"
 #include <set>
 #include <queue>
+#include <vector>
 #include <fstream>
 
 enum LogRecType {
@@ -39,6 +40,9 @@ struct CmdLogRecord {
 };
 
 // ARIES-style log record (physiological logging)
+// On disk the header is followed by before_image_size bytes of undo image
+// and after_image_size bytes of redo image. A record with iud == L_NOTIFY
+// is the commit record of txn_id and carries no images.
 struct AriesLogRecord {
   void init() {
     checksum = 0;
@@ -46,8 +50,11 @@ struct AriesLogRecord {
     type = LRT_UPDATE;
     iud = L_UPDATE;
     txn_id = UINT64_MAX;
+    part_id = 0;
     table_id = 0;
     key = UINT64_MAX;
+    before_image_size = 0;
+    after_image_size = 0;
   }
 
   uint32_t checksum;
@@ -55,20 +62,11 @@ struct AriesLogRecord {
   LogRecType type;
   LogIUD iud;
   uint64_t txn_id; // transaction id
-  //uint32_t partid; // partition id
+  uint32_t part_id; // partition id
   uint32_t table_id; // table being updated
   uint64_t key; // primary key (determines the partition ID)
-  // TODO: column list
-
-  /*lsn
-  uint32_t n_cols; //how many columns are being updated
-  uint32_t* cols; //ids of modified columns
   uint32_t before_image_size;
-  char * before_image; // data buffer for before image
   uint32_t after_image_size;
-  char * after_image; // data buffer for after image
-  */
-
 };
 
 class LogRecord {
@@ -76,10 +74,7 @@ public:
   //LogRecord();
   LogRecType getType() { return rcd.type; }
   void copyRecord( LogRecord * record);
-  // TODO: compute a reasonable checksum
-  uint64_t computeChecksum() {
-    return (uint64_t)rcd.txn_id;
-  };
+  uint32_t computeChecksum(const char * before, const char * after);
 #if LOG_COMMAND
   CmdLogRecord rcd;
 #else
@@ -90,11 +85,45 @@ private:
 
 };
 
+// Every flushed buffer half is written as one block. A block only holds
+// whole transactions, so blocks can be replayed independently.
+#define LOG_BLOCK_MAGIC 0x4c4f4742
+struct LogBlockHeader {
+  uint32_t magic;
+  uint32_t buffer_id;
+  uint64_t epoch;
+  uint64_t size; // bytes of records following the header
+};
+
+// Per-worker log buffer. The owning worker appends to the active half while
+// the log thread drains the other one; the latch only covers the append and
+// the half swap at the end of each group-commit epoch. A transaction whose
+// records do not fit in a half gets a buffer of its own, written as a block
+// of its own in the same epoch.
+class LogBuffer {
+public:
+  void init(uint64_t size);
+  void release();
+
+  char * data[2];
+  uint64_t offset[2];
+  // txn_id and append time of every commit record in the half
+  std::vector<std::pair<uint64_t, uint64_t> > * waiters[2];
+  // (buffer, size) of the oversized transactions of the half
+  std::vector<std::pair<char *, uint64_t> > * large[2];
+  char * large_buf; // reserved and not yet released
+  uint32_t active;
+  uint64_t size;
+  pthread_mutex_t latch;
+  char _pad[CL_SIZE];
+};
+
 class Logger {
 public:
   void init(const char * log_file);
   void release();
   void flushBufferCheck(uint64_t thd_id);
+  void flushBuffer(uint64_t thd_id);
   LogRecord * createRecord(LogRecord* record);
 
   LogRecord * createRecord(
@@ -104,22 +133,53 @@ public:
       uint64_t table_id, uint64_t key);
   void enqueueRecord(LogRecord* record);
   void processRecord(uint64_t thd_id);
-  void writeToBuffer(uint64_t thd_id,char * data, uint64_t size);
-  void writeToBuffer(uint64_t thd_id,LogRecord* record);
-  uint64_t reserveBuffer(uint64_t size);
-  void notify_on_sync(uint64_t txn_id);
+
+  // Group commit interface. reserveBuffer returns space for size bytes in the
+  // caller's log buffer and keeps it latched until releaseBuffer, so all records
+  // of a transaction are contiguous in the log. If txn_id is given, a
+  // LOG_FLUSHED message is sent for it once the epoch is durable.
+  static uint64_t getRecordSize(uint64_t before_size, uint64_t after_size);
+  char * reserveBuffer(uint64_t thd_id, uint64_t size);
+  void writeRecord(char * buf, uint64_t &ptr, uint64_t txn_id, LogIUD iud, uint64_t part_id,
+                   uint64_t table_id, uint64_t key, const char * before, uint64_t before_size,
+                   const char * after, uint64_t after_size);
+  void releaseBuffer(uint64_t thd_id, uint64_t size, uint64_t txn_id);
+  // Called by worker thd_id once it runs: moves its buffer to the worker's node.
+  void bindBuffer(uint64_t thd_id);
+
+  // Drop the blocks of epochs before epoch once a checkpoint covers them. The
+  // log thread rewrites the file between two flushes (truncateCheck).
+  void truncate(uint64_t epoch) { truncate_epoch = epoch; }
+  void truncateCheck(uint64_t thd_id);
+  // A committing thread installs its writes after appending its records (between
+  // reserveBuffer and the end of TxnManager::commit): a checkpoint copy may miss them.
+  void beginInstall(uint64_t thd_id) { install_epoch[thd_id] = epoch; }
+  void endInstall(uint64_t thd_id) { install_epoch[thd_id] = UINT64_MAX; }
+  // Blocks of this epoch and later hold every commit not yet installed in the tables.
+  uint64_t get_install_epoch();
+
+  void set_lsn(uint64_t lsn) { this->lsn = lsn; }
+  void set_epoch(uint64_t epoch) { this->epoch = epoch; }
+  uint64_t get_epoch() { return epoch; }
+  uint64_t get_durable_lsn() { return durable_lsn; }
 private:
   pthread_mutex_t mtx;
-  uint64_t lsn;
+  volatile uint64_t lsn;
+  volatile uint64_t epoch;
+  volatile uint64_t durable_lsn;
+  volatile uint64_t pending_commit_cnt;
+  volatile uint64_t truncate_epoch;
+  volatile uint64_t * install_epoch; // per thread, UINT64_MAX while not installing
 
-  void flushBuffer(uint64_t thd_id);
   std::queue<LogRecord*> log_queue;
   const char * log_file_name;
-  std::ofstream log_file;
-  uint64_t aries_write_offset;
-  std::set<uint64_t> txns_to_notify;
+  int log_fd;
+  LogBuffer * buffers;
+  uint64_t buffer_cnt;
   uint64_t last_flush;
-  uint64_t log_buf_cnt;
+
+  bool writeBlock(uint32_t buffer_id, const char * data, uint64_t size);
+  void logFailed(const char * op);
 };
 
 
@@ -16,18 +16,22 @@
 //*******************
 #include "abort_thread.h"
 #include "calvin_thread.h"
+#include "checkpoint.h"
+#include "checkpoint_thread.h"
 #include "client_query.h"
 #include "dli.h"
 #include "dta.h"
 #include "global.h"
 #include "io_thread.h"
 #include "key_xid.h"
+#include "log_recovery.h"
 #include "log_thread.h"
 #include "logger.h"
 #include "maat.h"
 #include "manager.h"
 #include "math.h"
 #include "msg_queue.h"
+#include "msg_trace.h"
 #include "occ.h"
 #include "pps.h"
 #include "query.h"
@@ -58,6 +62,8 @@
 #include "stat_thread.h"
 #include "migmsg_queue.h"
 #include "partition.h"
+#include "placement.h"
+#include "admission.h"
 #include <algorithm>
 #include <iostream>
 #include <vector>
@@ -74,6 +80,7 @@ InputThread * input_thds;
 OutputThread * output_thds;
 AbortThread * abort_thds;
 LogThread * log_thds;
+CheckpointThread * ckpt_thds;
 MigrateThread * migrate_thds;
 StatThread * stat_thds;
 #if CC_ALG == CALVIN
@@ -124,12 +131,20 @@ int main(int argc, char *argv[]) {
 #else
 	uint64_t seed = get_sys_clock();
 #endif
+#if TRACE_RECORD || TRACE_REPLAY
+	msg_trace.init(seed);
+#endif
+	g_seed = seed;
 	srand(seed);
 	printf("Random seed: %ld\n",seed);
 
 	int64_t starttime;
 	int64_t endtime;
 	starttime = get_server_clock();
+	printf("Initializing placement... ");
+	fflush(stdout);
+	placement.init(PLACEMENT_FILE);
+	printf("Done\n");
 	printf("Initializing stats... ");
 	fflush(stdout);
 	stats.init(g_total_thread_cnt);
@@ -200,6 +215,12 @@ int main(int argc, char *argv[]) {
 	fflush(stdout);
 	abort_queue.init();
 	printf("Done\n");
+#if ADMISSION_CC
+	printf("Initializing admission control... ");
+	fflush(stdout);
+	admission.init();
+	printf("Done\n");
+#endif
 	printf("Initializing message queue... ");
 	fflush(stdout);
 	msg_queue.init();
@@ -280,8 +301,13 @@ int main(int argc, char *argv[]) {
 	// printf("Initializing WKDB KeyxidCache and RtsCache... ");
 	// fflush(stdout);
 	// wkdb_key_xid_cache.init();
-	// wkdb_rts_cache.init();
 	// printf("Done\n");
+#if RTS_CACHE_ENABLE
+	printf("Initializing WKDB RtsCache... ");
+	fflush(stdout);
+	wkdb_rts_cache.init();
+	printf("Done\n");
+#endif
 	printf("Initializing WKDB manager... ");
 	fflush(stdout);
 	wkdb_man.init();
@@ -302,19 +328,41 @@ int main(int argc, char *argv[]) {
 	// printf("Initializing DTA KeyxidCache and RtsCache... ");
 	// fflush(stdout);
 	// dta_key_xid_cache.init();
-	// dta_rts_cache.init();
 	// printf("Done\n");
+#if RTS_CACHE_ENABLE
+	printf("Initializing DTA RtsCache... ");
+	fflush(stdout);
+	dta_rts_cache.init();
+	printf("Done\n");
+#endif
 	printf("Initializing DTA manager... ");
 	fflush(stdout);
 	dta_man.init();
 	printf("Done\n");
 #endif
 #if LOGGING
+#if LOG_RECOVER
+	printf("Recovering from log...\n");
+	fflush(stdout);
+	LogRecovery recovery;
+	recovery.init(m_wl, LOG_FILE);
+#if CKPT_LOAD
+	recovery.set_start_epoch(checkpointer.get_load_epoch());
+#endif
+	recovery.recover();
+#endif
 	printf("Initializing logger... ");
 	fflush(stdout);
-	logger.init("logfile.log");
+	logger.init(LOG_FILE);
+#if LOG_RECOVER
+	logger.set_lsn(recovery.get_next_lsn());
+	logger.set_epoch(recovery.get_next_epoch());
+#endif
 	printf("Done\n");
 #endif
+#if CHECKPOINT
+	checkpointer.init(m_wl);
+#endif
 
 #if SERVER_GENERATE_QUERIES
 	printf("Initializing client query queue... ");
@@ -340,8 +388,11 @@ int main(int argc, char *argv[]) {
 #if LOGGING
 		all_thd_cnt += 1; // logger thread
 #endif
+#if CHECKPOINT
+		all_thd_cnt += 1; // checkpoint thread
+#endif
 #if CC_ALG == CALVIN
-		all_thd_cnt += 2; // sequencer + scheduler thread
+		all_thd_cnt += 1 + g_calvin_lock_thread_cnt; // sequencer + scheduler threads
 #endif
 
 
@@ -362,10 +413,11 @@ int main(int argc, char *argv[]) {
 	output_thds = new OutputThread[sthd_cnt];
 	abort_thds = new AbortThread[1];
 	log_thds = new LogThread[1];
+	ckpt_thds = new CheckpointThread[1];
 	migrate_thds = new MigrateThread[g_migrate_thread_cnt];
 	stat_thds = new StatThread[g_stat_thread_cnt];
 #if CC_ALG == CALVIN
-	calvin_lock_thds = new CalvinLockThread[1];
+	calvin_lock_thds = new CalvinLockThread[g_calvin_lock_thread_cnt];
 	calvin_seq_thds = new CalvinSequencerThread[1];
 #endif
 	// query_queue should be the last one to be initialized!!!
@@ -412,10 +464,6 @@ int main(int argc, char *argv[]) {
 	warmup_done = true;
 	pthread_barrier_init( &warmup_bar, NULL, all_thd_cnt);
 
-#if SET_AFFINITY
-	uint64_t cpu_cnt = 0;
-	cpu_set_t cpus;
-#endif
 	// spawn and run txns again.
 	starttime = get_sys_clock();
 	simulation->run_starttime = starttime;
@@ -429,12 +477,7 @@ int main(int argc, char *argv[]) {
 
 	uint64_t id = 0;
 	for (uint64_t i = 0; i < wthd_cnt; i++) {
-#if SET_AFFINITY
-		CPU_ZERO(&cpus);
-		CPU_SET(cpu_cnt, &cpus);
-		pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-		cpu_cnt++;
-#endif
+		placement.place(&attr, WORKER_THD, id);
 		assert(id >= 0 && id < wthd_cnt);
 		worker_thds[i].init(id,g_node_id,m_wl);
 		pthread_create(&p_thds[id++], &attr, run_thread, (void *)&worker_thds[i]);
@@ -468,59 +511,63 @@ int main(int argc, char *argv[]) {
 	for (uint64_t j = 0; j < rthd_cnt ; j++) {
 		assert(id >= wthd_cnt && id < wthd_cnt + rthd_cnt);
 		input_thds[j].init(id,g_node_id,m_wl);
-		pthread_create(&p_thds[id++], NULL, run_thread, (void *)&input_thds[j]);
+		placement.place(&attr, INPUT_THD, id);
+		pthread_create(&p_thds[id++], &attr, run_thread, (void *)&input_thds[j]);
 	}
 
 	for (uint64_t j = 0; j < sthd_cnt; j++) {
 		assert(id >= wthd_cnt + rthd_cnt && id < wthd_cnt + rthd_cnt + sthd_cnt);
 		output_thds[j].init(id,g_node_id,m_wl);
-		pthread_create(&p_thds[id++], NULL, run_thread, (void *)&output_thds[j]);
+		placement.place(&attr, OUTPUT_THD, id);
+		pthread_create(&p_thds[id++], &attr, run_thread, (void *)&output_thds[j]);
 	}
 #if LOGGING
 	log_thds[0].init(id,g_node_id,m_wl);
-	pthread_create(&p_thds[id++], NULL, run_thread, (void *)&log_thds[0]);
+	placement.place(&attr, LOG_THD, id);
+	pthread_create(&p_thds[id++], &attr, run_thread, (void *)&log_thds[0]);
+#endif
+#if CHECKPOINT
+	ckpt_thds[0].init(id,g_node_id,m_wl);
+	placement.place(&attr, CKPT_THD, id);
+	pthread_create(&p_thds[id++], &attr, run_thread, (void *)&ckpt_thds[0]);
 #endif
 
 #if CC_ALG != CALVIN
 	abort_thds[0].init(id,g_node_id,m_wl);
-	pthread_create(&p_thds[id++], NULL, run_thread, (void *)&abort_thds[0]);
+	placement.place(&attr, ABORT_THD, id);
+	pthread_create(&p_thds[id++], &attr, run_thread, (void *)&abort_thds[0]);
 #endif
 
 	#if MIGRATION
 	for (uint64_t i = 0; i < migthd_cnt; i++){ //创建迁移线程
 		migrate_thds[i].init(id, g_node_id, m_wl);
-		pthread_create(&p_thds[id++], NULL, run_thread, (void *)&migrate_thds[i]);
+		placement.place(&attr, MIGRATE_THD, id);
+		pthread_create(&p_thds[id++], &attr, run_thread, (void *)&migrate_thds[i]);
 	}
 	#endif
 
 	for (uint64_t i = 0; i < g_stat_thread_cnt; i++){
 		stat_thds[i].init(id, g_node_id, m_wl);
-		pthread_create(&p_thds[id++], NULL, run_thread, (void *)&stat_thds[i]);
+		placement.place(&attr, STAT_THD, id);
+		pthread_create(&p_thds[id++], &attr, run_thread, (void *)&stat_thds[i]);
 	}
 
 #if CC_ALG == CALVIN
-#if SET_AFFINITY
-	CPU_ZERO(&cpus);
-	CPU_SET(cpu_cnt, &cpus);
-	pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-	cpu_cnt++;
-#endif
-
-	calvin_lock_thds[0].init(id,g_node_id,m_wl);
-	pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_lock_thds[0]);
-#if SET_AFFINITY
-	CPU_ZERO(&cpus);
-	CPU_SET(cpu_cnt, &cpus);
-	pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-	cpu_cnt++;
-#endif
-
+	for (uint64_t i = 0; i < g_calvin_lock_thread_cnt; i++) {
+		placement.place(&attr, CALVIN_LOCK_THD, id);
+		calvin_lock_thds[i].init(id,g_node_id,m_wl);
+		calvin_lock_thds[i].shard_id = i;
+		pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_lock_thds[i]);
+	}
+	placement.place(&attr, CALVIN_SEQ_THD, id);
 	calvin_seq_thds[0].init(id,g_node_id,m_wl);
 	pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_seq_thds[0]);
 #endif
 
 	worker_num_thds[0].init(id,g_node_id,m_wl);
+	placement.place(&attr, WORKER_NUM_THD, id);
 	pthread_create(&p_thds[id++], &attr, run_thread, (void *)&worker_num_thds[0]);
+	placement.print();
 <<<<<<< HEAD
 =======
 	
@@ -538,6 +585,9 @@ int main(int argc, char *argv[]) {
 >>>>>>> 8ee691f8bc5012b01a09fa4ed4cd44586f4b7b9d
 
 	for (uint64_t i = 0; i < all_thd_cnt; i++) pthread_join(p_thds[i], NULL);
+#if TRACE_RECORD || TRACE_REPLAY
+	msg_trace.fini();
+#endif
 
 	endtime = get_sys_clock();
 
@@ -780,6 +780,7 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
         ((YCSBWorkload*)_wl)->the_table->get_new_row(data_);
         itemid_t * m_item = (itemid_t *) mem_allocator.alloc(sizeof(itemid_t));
 	    assert(m_item != NULL);
+	    m_item->init();
 	    m_item->type = DT_row;
 	    m_item->location = row_data_ptr+ptr_data-sizeof(data_->get_tuple_size());
 	    m_item->valid = true;
@@ -802,6 +803,7 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
 <<<<<<< HEAD
         itemid_t * m_item = (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
         assert(m_item != NULL);
+        m_item->init();
         m_item->type = DT_row;
         m_item->location = new_row;
         m_item->valid = true;
@@ -868,6 +870,7 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
                     #endif
                     itemid_t * m_item = (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
                     assert(m_item != NULL);
+                    m_item->init();
                     m_item->type = DT_row;
                     m_item->location = new_row;
                     m_item->valid = true;
@@ -897,6 +900,7 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
                     #endif
                     itemid_t * m_item = (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
                     assert(m_item != NULL);
+                    m_item->init();
                     m_item->type = DT_row;
                     m_item->location = new_row;
                     m_item->valid = true;
@@ -926,6 +930,7 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
                     #endif
                     itemid_t * m_item = (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
                     assert(m_item != NULL);
+                    m_item->init();
                     m_item->type = DT_row;
                     m_item->location = new_row;
                     m_item->valid = true;
@@ -955,6 +960,7 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
                     #endif
                     itemid_t * m_item = (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
                     assert(m_item != NULL);
+                    m_item->init();
                     m_item->type = DT_row;
                     m_item->location = new_row;
                     m_item->valid = true;
@@ -1048,7 +1054,8 @@ RC MigrateThread::process_recv_migration(MigrationMessage* msg){
         g_mig_endtime = get_sys_clock();
     }    
 
-    txn_man->commit();
+    // nothing handles a LOG_FLUSHED for a migration txn
+    txn_man->commit(false);
     return rc;
 }
 
@@ -1428,6 +1435,6 @@ RC MigrateThread::process_finish_migration(MigrationMessage* msg){
     std::cout<<"Time:"<<(get_server_clock()-g_starttime) / BILLION<<endl;
     txn_man->txn_stats.migration_time = migration_time;
 >>>>>>> 8ee691f8bc5012b01a09fa4ed4cd44586f4b7b9d
-    txn_man->commit();
+    txn_man->commit(false);
     return rc;
 }
\ No newline at end of file
@@ -40,6 +40,7 @@ public:
   void statqueue(uint64_t thd_id, msg_entry * entry);
   void enqueue(uint64_t thd_id, Message * msg, uint64_t dest);
   uint64_t dequeue(uint64_t thd_id, Message *& msg);
+  uint64_t get_cnt() {return msg_queue_size;}
 private:
  //LockfreeQueue m_queue;
 // This is close to max capacity for boost
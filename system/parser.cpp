@@ -16,6 +16,156 @@
 
 #include "global.h"
 #include "helper.h"
+#include <sstream>
+
+/*
+   CC_ALG picks the engine at compile time. A NO_WAIT or WAIT_DIE build with
+   CC_ALG_RUNTIME runs either of them: --cc_alg= sets g_cc_alg, which
+   Row_lock dispatches on. The other CC families, WORKLOAD and MIGRATION_ALG
+   are not runtime yet: --cc_alg=, --workload= and --migration_alg= only
+   accept what the build runs, so a sweep fails at once on a wrong binary.
+   Everything else is a g_ variable and can be set with --<name>=<value>,
+   see runtime_params.
+*/
+struct NamedValue {
+  const char * name;
+  uint32_t value;
+};
+
+static const NamedValue cc_algs[] = {
+    {"NO_WAIT", NO_WAIT},     {"WAIT_DIE", WAIT_DIE},   {"DL_DETECT", DL_DETECT},
+    {"TIMESTAMP", TIMESTAMP}, {"MVCC", MVCC},           {"HSTORE", HSTORE},
+    {"HSTORE_SPEC", HSTORE_SPEC}, {"OCC", OCC},         {"VLL", VLL},
+    {"CALVIN", CALVIN},       {"MAAT", MAAT},           {"WDL", WDL},
+    {"WOOKONG", WOOKONG},     {"TICTOC", TICTOC},       {"FOCC", FOCC},
+    {"BOCC", BOCC},           {"SSI", SSI},             {"WSI", WSI},
+    {"DLI_BASE", DLI_BASE},   {"DLI_OCC", DLI_OCC},     {"DLI_MVCC_OCC", DLI_MVCC_OCC},
+    {"DTA", DTA},             {"DLI_DTA", DLI_DTA},     {"DLI_MVCC", DLI_MVCC},
+    {"DLI_DTA2", DLI_DTA2},   {"DLI_DTA3", DLI_DTA3},   {"SILO", SILO},
+    {"CNULL", CNULL},         {NULL, 0}};
+static const NamedValue workloads[] = {
+    {"YCSB", YCSB}, {"TPCC", TPCC}, {"PPS", PPS}, {"TEST", TEST}, {"DA", DA}, {NULL, 0}};
+static const NamedValue migration_algs[] = {
+    {"DETEST", DETEST}, {"REMUS", REMUS}, {"LOCK", LOCK}, {"SQUALL", SQUALL},
+    {"DETEST_SPLIT", DETEST_SPLIT}, {NULL, 0}};
+
+static const char * value_name(const NamedValue * values, uint32_t value) {
+  for (; values->name; values++)
+    if (values->value == value) return values->name;
+  return "?";
+}
+
+// --cc_alg=NAME
+static void set_cc_alg(const char * name) {
+  const NamedValue * v = cc_algs;
+  while (v->name && strcmp(v->name, name) != 0) v++;
+  M_ASSERT_V(v->name, "unknown cc_alg %s\n", name);
+#if CC_ALG_RUNTIME
+  M_ASSERT_V(v->value == NO_WAIT || v->value == WAIT_DIE,
+             "the build runs NO_WAIT or WAIT_DIE, not %s\n", name);
+#else
+  M_ASSERT_V(v->value == CC_ALG, "the build runs %s only, not %s: set CC_ALG_RUNTIME\n",
+             value_name(cc_algs, CC_ALG), name);
+#endif
+  g_cc_alg = v->value;
+  g_params["cc_alg"] = v->name;
+}
+
+// --workload=NAME, --migration_alg=NAME: compile time, only checked
+static void check_compiled(const NamedValue * values, const char * what, uint32_t compiled,
+                           const char * name) {
+  const NamedValue * v = values;
+  while (v->name && strcmp(v->name, name) != 0) v++;
+  M_ASSERT_V(v->name, "unknown %s %s\n", what, name);
+  M_ASSERT_V(v->value == compiled, "the build runs %s %s only, not %s\n", what,
+             value_name(values, compiled), name);
+  g_params[what] = v->name;
+}
+
+template <typename T>
+static bool set_value(void * var, const char * value) {
+  std::istringstream in(value);
+  T v;
+  if (!(in >> v) || !in.eof()) return false;
+  *(T *)var = v;
+  return true;
+}
+
+template <>
+bool set_value<bool>(void * var, const char * value) {
+  if (strcmp(value, "1") == 0 || strcmp(value, "true") == 0)
+    *(bool *)var = true;
+  else if (strcmp(value, "0") == 0 || strcmp(value, "false") == 0)
+    *(bool *)var = false;
+  else
+    return false;
+  return true;
+}
+
+struct RuntimeParam {
+  const char * name;
+  void * var;
+  bool (*set)(void * var, const char * value);
+};
+
+#define RUNTIME_PARAM(name) {#name, (void *)&g_##name, set_value<decltype(g_##name)>}
+static const RuntimeParam runtime_params[] = {
+    // sizing
+    RUNTIME_PARAM(node_cnt), RUNTIME_PARAM(part_cnt), RUNTIME_PARAM(virtual_part_cnt),
+    RUNTIME_PARAM(client_node_cnt), RUNTIME_PARAM(thread_cnt), RUNTIME_PARAM(rem_thread_cnt),
+    RUNTIME_PARAM(send_thread_cnt), RUNTIME_PARAM(client_thread_cnt),
+    RUNTIME_PARAM(client_rem_thread_cnt), RUNTIME_PARAM(client_send_thread_cnt),
+    RUNTIME_PARAM(load_thread_cnt), RUNTIME_PARAM(init_parallelism),
+    RUNTIME_PARAM(load_index_batch), RUNTIME_PARAM(inflight_max),
+    RUNTIME_PARAM(max_txn_per_part), RUNTIME_PARAM(load_per_server),
+    RUNTIME_PARAM(max_read_req), RUNTIME_PARAM(max_pre_req), RUNTIME_PARAM(his_recycle_len),
+    // timers and batching
+    RUNTIME_PARAM(done_timer), RUNTIME_PARAM(warmup_timer), RUNTIME_PARAM(prog_timer),
+    RUNTIME_PARAM(batch_time_limit), RUNTIME_PARAM(seq_batch_time_limit),
+    RUNTIME_PARAM(msg_time_limit), RUNTIME_PARAM(msg_size), RUNTIME_PARAM(network_delay),
+    RUNTIME_PARAM(abort_penalty), RUNTIME_PARAM(abort_penalty_max),
+    RUNTIME_PARAM(log_buf_max), RUNTIME_PARAM(log_flush_timeout), RUNTIME_PARAM(log_buf_size),
+    RUNTIME_PARAM(ckpt_interval), RUNTIME_PARAM(ckpt_latency_bound),
+    RUNTIME_PARAM(ckpt_chunk_size), RUNTIME_PARAM(ts_interval),
+    // YCSB
+    RUNTIME_PARAM(synth_table_size), RUNTIME_PARAM(req_per_query), RUNTIME_PARAM(part_per_txn),
+    RUNTIME_PARAM(perc_multi_part), RUNTIME_PARAM(zipf_theta), RUNTIME_PARAM(field_per_tuple),
+    RUNTIME_PARAM(strict_ppt), RUNTIME_PARAM(data_perc), RUNTIME_PARAM(access_perc),
+    RUNTIME_PARAM(mpr), RUNTIME_PARAM(mpitem), RUNTIME_PARAM(shift_interval),
+    RUNTIME_PARAM(shift_drift_rate), RUNTIME_PARAM(shift_jump_keys),
+    // TPCC
+    RUNTIME_PARAM(num_wh), RUNTIME_PARAM(perc_payment), RUNTIME_PARAM(perc_order_status),
+    RUNTIME_PARAM(perc_delivery), RUNTIME_PARAM(perc_stock_level), RUNTIME_PARAM(wh_update),
+    RUNTIME_PARAM(max_items), RUNTIME_PARAM(dist_per_wh), RUNTIME_PARAM(cust_per_dist),
+    {NULL, NULL, NULL}};
+
+// --name=value
+static void set_runtime_param(const char * arg) {
+  std::string name = arg;
+  size_t eq = name.find('=');
+  M_ASSERT_V(eq != std::string::npos, "expected --name=value: --%s\n", arg);
+  const char * value = arg + eq + 1;
+  name.erase(eq);
+  if (name == "cc_alg") {
+    set_cc_alg(value);
+    return;
+  }
+  if (name == "workload") {
+    check_compiled(workloads, "workload", WORKLOAD, value);
+    return;
+  }
+  if (name == "migration_alg") {
+    check_compiled(migration_algs, "migration_alg", MIGRATION_ALG, value);
+    return;
+  }
+  for (const RuntimeParam * p = runtime_params; p->name; p++) {
+    if (name != p->name) continue;
+    M_ASSERT_V(p->set(p->var, value), "bad value for --%s: %s\n", p->name, value);
+    g_params[name] = value;
+    return;
+  }
+  M_ASSERT_V(false, "unknown parameter --%s\n", arg);
+}
 
 void print_usage() {
 	printf("[usage]:\n");
@@ -70,6 +220,12 @@ void print_usage() {
 	printf("\t-whINT       ; NUM_WH\n");
 	printf("\t-ppFLOAT    ; PERC_PAYMENT\n");
 	printf("\t-upINT      ; WH_UPDATE\n");
+	printf("  [Engine]:\n");
+	printf("\t--cc_alg=NAME   ; NO_WAIT or WAIT_DIE with CC_ALG_RUNTIME\n");
+	printf("\t--workload=NAME --migration_alg=NAME   ; must match the build\n");
+	printf("\t--NAME=VALUE   ; any of:");
+	for (const RuntimeParam * p = runtime_params; p->name; p++) printf(" %s", p->name);
+	printf("\n");
 
 }
 
@@ -80,7 +236,9 @@ void parser(int argc, char * argv[]) {
 
 	for (int i = 1; i < argc; i++) {
 		assert(argv[i][0] == '-');
-    if (argv[i][1] == 'n' && argv[i][2] == 'd' && argv[i][3] == 'l' && argv[i][4] == 'y')
+    if (argv[i][1] == '-')
+      set_runtime_param(&argv[i][2]);
+    else if (argv[i][1] == 'n' && argv[i][2] == 'd' && argv[i][3] == 'l' && argv[i][4] == 'y')
       g_network_delay = atoi( &argv[i][5] );
     else if (argv[i][1] == 'd' && argv[i][2] == 'o' && argv[i][3] == 'n' && argv[i][4] == 'e')
       g_done_timer = atoi( &argv[i][5] );
@@ -0,0 +1,282 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "placement.h"
+#include "helper.h"
+#include <fstream>
+#include <sstream>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+static const char * thd_class_name[THD_CLASS_CNT] = {
+    "worker", "input", "output", "abort", "log", "checkpoint",
+    "migrate", "stat", "calvin_lock", "calvin_seq", "worker_num"};
+static const char * pin_mode_name[] = {"cpu", "node", "none"};
+
+void Placement::init(const char * policy_file) {
+  shared_cnt = 0;
+  discover();
+  memset(class_cnt, 0, sizeof(class_cnt));
+  memset(placed, 0, sizeof(placed));
+  class_cnt[WORKER_THD] = g_thread_cnt;
+  class_cnt[INPUT_THD] = g_rem_thread_cnt;
+  class_cnt[OUTPUT_THD] = g_send_thread_cnt;
+#if CC_ALG == CALVIN
+  class_cnt[CALVIN_LOCK_THD] = g_calvin_lock_thread_cnt;
+  class_cnt[CALVIN_SEQ_THD] = 1;
+#endif
+  for (uint32_t i = 0; i < THD_CLASS_CNT; i++) {
+    policy[i].nodes.clear();
+    policy[i].spread = false;
+    switch (i) {
+      case WORKER_THD:
+      case INPUT_THD:
+      case OUTPUT_THD:
+      case CALVIN_LOCK_THD:
+      case CALVIN_SEQ_THD:
+        policy[i].mode = PIN_CPU;
+        policy[i].spread = true;
+        break;
+      default:
+        policy[i].mode = PIN_NODE;
+        policy[i].nodes.push_back(0);
+        break;
+    }
+  }
+  read_policy(policy_file);
+
+  // The spread classes take the first cpus of every node, in class order;
+  // cpus of the classes pinned by the file come after them.
+  for (uint32_t k = 0; k < spread_nodes.size(); k++) {
+    uint32_t n = spread_nodes[k];
+    uint64_t reserved = 0;
+    for (uint32_t c = 0; c < THD_CLASS_CNT; c++) {
+      if (policy[c].spread) reserved += first_on(k + 1, class_cnt[c]) - first_on(k, class_cnt[c]);
+    }
+    next_free[n] = std::min(reserved, (uint64_t)node_cpus[n].size());
+  }
+}
+
+// "0-3,8,10-11"
+bool Placement::parse_list(const std::string &list, std::vector<uint32_t> &out) {
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) continue;
+    char * end;
+    uint32_t lo = strtoul(range.c_str(), &end, 10);
+    if (end == range.c_str()) return false;
+    uint32_t hi = lo;
+    if (*end == '-') {
+      const char * start = end + 1;
+      hi = strtoul(start, &end, 10);
+      if (end == start) return false;
+    }
+    for (uint32_t i = lo; i <= hi; i++) out.push_back(i);
+  }
+  return true;
+}
+
+void Placement::discover() {
+  CPU_ZERO(&allowed);
+  sched_getaffinity(0, sizeof(cpu_set_t), &allowed);
+  node_cpus.clear();
+
+  std::vector<uint32_t> nodes;
+  std::string line;
+  std::ifstream online("/sys/devices/system/node/online");
+  if (online && std::getline(online, line)) parse_list(line, nodes);
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    std::vector<uint32_t> cpus;
+    char path[128];
+    sprintf(path, "/sys/devices/system/node/node%u/cpulist", nodes[i]);
+    std::ifstream cpulist(path);
+    if (cpulist && std::getline(cpulist, line)) parse_list(line, cpus);
+    if (node_cpus.size() <= nodes[i]) node_cpus.resize(nodes[i] + 1);
+    for (uint32_t j = 0; j < cpus.size(); j++) {
+      if (cpus[j] < CPU_SETSIZE && CPU_ISSET(cpus[j], &allowed)) node_cpus[nodes[i]].push_back(cpus[j]);
+    }
+  }
+  // no NUMA information: one node with every cpu we may use
+  if (node_cpus.empty()) {
+    node_cpus.resize(1);
+    for (uint32_t c = 0; c < CPU_SETSIZE; c++) {
+      if (CPU_ISSET(c, &allowed)) node_cpus[0].push_back(c);
+    }
+  }
+  next_free.assign(node_cpus.size(), 0);
+  spread_nodes.clear();
+  for (uint32_t n = 0; n < node_cpus.size(); n++) {
+    if (!node_cpus[n].empty()) spread_nodes.push_back(n);
+  }
+}
+
+void Placement::read_policy(const char * policy_file) {
+  std::ifstream in(policy_file);
+  if (!in) {
+    printf("No placement policy %s, using the defaults\n", policy_file);
+    return;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    std::istringstream ss(line);
+    std::string cls, mode, nodes;
+    if (!(ss >> cls)) continue;
+    ss >> mode >> nodes;
+    uint32_t c = 0;
+    while (c < THD_CLASS_CNT && cls != thd_class_name[c]) c++;
+    M_ASSERT_V(c < THD_CLASS_CNT, "%s: unknown thread class %s\n", policy_file, cls.c_str());
+    uint32_t m = 0;
+    while (m <= PIN_NONE && mode != pin_mode_name[m]) m++;
+    M_ASSERT_V(m <= PIN_NONE, "%s: unknown mode '%s' for %s\n", policy_file, mode.c_str(),
+               cls.c_str());
+    policy[c].mode = (PinMode)m;
+    policy[c].spread = false;
+    policy[c].nodes.clear();
+    bool ok = parse_list(nodes, policy[c].nodes);
+    M_ASSERT_V(ok, "%s: bad node list %s for %s\n", policy_file, nodes.c_str(), cls.c_str());
+    for (uint32_t i = 0; i < policy[c].nodes.size(); i++) {
+      M_ASSERT_V(policy[c].nodes[i] < node_cpus.size() && !node_cpus[policy[c].nodes[i]].empty(),
+                 "%s: no cpus on node %u for %s\n", policy_file, policy[c].nodes[i], cls.c_str());
+    }
+  }
+}
+
+int64_t Placement::next_cpu(const std::vector<uint32_t> &nodes, int64_t &node) {
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    uint32_t n = nodes[i];
+    if (next_free[n] < node_cpus[n].size()) {
+      node = n;
+      return node_cpus[n][next_free[n]++];
+    }
+    total += node_cpus[n].size();
+  }
+  if (total == 0) return -1;
+  // every cpu is taken: share them round robin
+  uint64_t idx = shared_cnt++ % total;
+  for (uint32_t i = 0; i < nodes.size(); i++) {
+    uint32_t n = nodes[i];
+    if (idx < node_cpus[n].size()) {
+      node = n;
+      return node_cpus[n][idx];
+    }
+    idx -= node_cpus[n].size();
+  }
+  assert(false);
+  return -1;
+}
+
+// The i-th thread of a class goes to node i * nodes / cnt, on the cpu after
+// those of the same node taken by earlier classes and earlier threads of its own.
+int64_t Placement::spread_cpu(ThdClass cls, int64_t &node) {
+  uint64_t idx = placed[cls];
+  uint64_t cnt = std::max(class_cnt[cls], idx + 1);
+  uint64_t k = std::min(idx * spread_nodes.size() / cnt, spread_nodes.size() - 1);
+  uint64_t offset = idx - first_on(k, cnt);
+  for (uint32_t c = 0; c < cls; c++) {
+    if (policy[c].spread) offset += first_on(k + 1, class_cnt[c]) - first_on(k, class_cnt[c]);
+  }
+  node = spread_nodes[k];
+  return node_cpus[node][offset % node_cpus[node].size()];
+}
+
+void Placement::place(pthread_attr_t * attr, ThdClass cls, uint64_t thd_id) {
+  if (!SET_AFFINITY) return;
+  Policy &p = policy[cls];
+  std::vector<uint32_t> nodes = p.nodes;
+  if (nodes.empty()) {
+    for (uint32_t n = 0; n < node_cpus.size(); n++) {
+      if (!node_cpus[n].empty()) nodes.push_back(n);
+    }
+  }
+  Slot slot = {cls, -1, -1};
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  switch (p.mode) {
+    case PIN_CPU:
+      if (p.spread)
+        slot.cpu = spread_cpu(cls, slot.node);
+      else
+        slot.cpu = next_cpu(nodes, slot.node);
+      if (slot.cpu >= 0) CPU_SET(slot.cpu, &cpus);
+      break;
+    case PIN_NODE:
+      for (uint32_t i = 0; i < nodes.size(); i++) {
+        for (uint32_t j = 0; j < node_cpus[nodes[i]].size(); j++) CPU_SET(node_cpus[nodes[i]][j], &cpus);
+      }
+      if (nodes.size() == 1) slot.node = nodes[0];
+      break;
+    case PIN_NONE:
+      break;
+  }
+  if (CPU_COUNT(&cpus) == 0) cpus = allowed;
+  pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), &cpus);
+  placed[cls]++;
+
+  if (slots.size() <= thd_id) {
+    Slot none = {THD_CLASS_CNT, -1, -1};
+    slots.resize(thd_id + 1, none);
+  }
+  slots[thd_id] = slot;
+}
+
+int64_t Placement::get_node(uint64_t thd_id) {
+  if (thd_id >= slots.size()) return -1;
+  return slots[thd_id].node;
+}
+
+void Placement::bind_memory(void * ptr, uint64_t size, uint64_t thd_id) {
+  int64_t node = get_node(thd_id);
+  if (node < 0 || node_cpus.size() < 2 || size == 0) return;
+  uint64_t page = sysconf(_SC_PAGESIZE);
+  // only the pages of this allocation: the partial ones at either end hold other data
+  uint64_t start = ((uint64_t)ptr + page - 1) & ~(page - 1);
+  uint64_t end = ((uint64_t)ptr + size) & ~(page - 1);
+  if (start >= end) return;
+  std::vector<unsigned long> mask((node_cpus.size() + 63) / 64, 0);
+  mask[node / 64] |= 1UL << (node % 64);
+  // best effort: pages shared with another process stay where they are
+  syscall(SYS_mbind, start, end - start, MPOL_PREFERRED, mask.data(), mask.size() * 64 + 1,
+          MPOL_MF_MOVE);
+}
+
+void Placement::print() {
+  if (!SET_AFFINITY) return;
+  printf("Placement:");
+  for (uint32_t n = 0; n < node_cpus.size(); n++) {
+    if (node_cpus[n].empty()) continue;
+    printf(" node%u=%u-cpus", n, (uint32_t)node_cpus[n].size());
+  }
+  printf("\n");
+  for (uint64_t i = 0; i < slots.size(); i++) {
+    if (slots[i].cls == THD_CLASS_CNT) continue;
+    printf("  thd %ld %s", i, thd_class_name[slots[i].cls]);
+    if (slots[i].cpu >= 0)
+      printf(" cpu %ld", slots[i].cpu);
+    else
+      printf(" cpu any");
+    if (slots[i].node >= 0)
+      printf(" node %ld\n", slots[i].node);
+    else
+      printf(" node any\n");
+  }
+  fflush(stdout);
+}
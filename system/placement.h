@@ -0,0 +1,102 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _PLACEMENT_H_
+#define _PLACEMENT_H_
+
+#include "global.h"
+
+enum ThdClass {
+  WORKER_THD = 0,
+  INPUT_THD,
+  OUTPUT_THD,
+  ABORT_THD,
+  LOG_THD,
+  CKPT_THD,
+  MIGRATE_THD,
+  STAT_THD,
+  CALVIN_LOCK_THD,
+  CALVIN_SEQ_THD,
+  WORKER_NUM_THD,
+  THD_CLASS_CNT
+};
+
+// a thread gets one cpu of its own, floats over the cpus of its nodes, or floats freely
+enum PinMode { PIN_CPU, PIN_NODE, PIN_NONE };
+
+/*
+   Thread placement. The NUMA topology comes from /sys/devices/system/node,
+   limited to the cpus this process may run on. Each thread class is placed
+   following the policy file, one line per class:
+
+     # class     mode  nodes
+     worker      cpu   0,1
+     input       cpu   0
+     stat        node  1
+     migrate     none
+
+   cpu hands out a cpu of its own to every thread, taking the listed nodes in
+   order and sharing cpus once they are all taken; node lets the thread float
+   over the cpus of the listed nodes; none leaves it to the OS. Without nodes
+   all of them are used. Classes left out of the file keep the defaults:
+   workers, I/O and Calvin threads get cpus of their own, each class split
+   evenly over the nodes, so every node runs input and output threads next to
+   the workers they feed; the others float on node 0.
+*/
+class Placement {
+public:
+  void init(const char * policy_file);
+  // set the affinity of attr for thread thd_id of class cls
+  void place(pthread_attr_t * attr, ThdClass cls, uint64_t thd_id);
+  // NUMA node of thread thd_id, -1 if it is not tied to one
+  int64_t get_node(uint64_t thd_id);
+  // prefer the node of thread thd_id for the whole pages in [ptr, ptr + size), moving those
+  // already touched; the pages it shares with neighbouring allocations are left alone
+  void bind_memory(void * ptr, uint64_t size, uint64_t thd_id);
+  void print();
+
+private:
+  struct Policy {
+    PinMode mode;
+    std::vector<uint32_t> nodes;
+    // default cpu classes: a share of the cpus of every node
+    bool spread;
+  };
+  struct Slot {
+    ThdClass cls;
+    int64_t cpu;
+    int64_t node;
+  };
+  void discover();
+  void read_policy(const char * policy_file);
+  static bool parse_list(const std::string &list, std::vector<uint32_t> &out);
+  int64_t next_cpu(const std::vector<uint32_t> &nodes, int64_t &node);
+  int64_t spread_cpu(ThdClass cls, int64_t &node);
+  // threads of a class with index below first_on(k) go to nodes before the k-th
+  uint64_t first_on(uint64_t k, uint64_t cnt) { return (k * cnt + spread_nodes.size() - 1) / spread_nodes.size(); }
+
+  std::vector<std::vector<uint32_t> > node_cpus;
+  std::vector<uint32_t> next_free; // per node, first cpu not handed out yet
+  uint64_t shared_cnt; // cpus handed out once all of them were taken
+  Policy policy[THD_CLASS_CNT];
+  uint64_t class_cnt[THD_CLASS_CNT];
+  uint64_t placed[THD_CLASS_CNT];
+  std::vector<uint32_t> spread_nodes; // nodes with cpus
+  std::vector<Slot> slots; // by thread id
+  cpu_set_t allowed;
+};
+
+#endif
@@ -74,10 +74,12 @@ BaseQuery *Query_thd::get_next_query() {
 }
 
 void BaseQuery::init() { 
+  client_qid = UINT64_MAX;
   DEBUG_M("BaseQuery::init array partitions\n");
   partitions.init(g_part_cnt);
   DEBUG_M("BaseQuery::init array partitions_touched\n");
   partitions_touched.init(g_part_cnt);
+  partitions_modified.init(g_part_cnt);
   DEBUG_M("BaseQuery::init array active_nodes\n");
   active_nodes.init(g_node_cnt);
   DEBUG_M("BaseQuery::init array participant_nodes\n");
@@ -87,6 +89,7 @@ void BaseQuery::init() {
 void BaseQuery::clear() { 
   partitions.clear();
   partitions_touched.clear();
+  partitions_modified.clear();
   active_nodes.clear();
   participant_nodes.clear();
 } 
@@ -94,6 +97,7 @@ void BaseQuery::clear() {
 void BaseQuery::release() { 
   partitions.release();
   partitions_touched.release();
+  partitions_modified.release();
   active_nodes.release();
   participant_nodes.release();
 } 
@@ -33,6 +33,8 @@ public:
     virtual void print() = 0;
     virtual void init();
     uint64_t waiting_time;
+    // ring slot of a streamed client query, echoed back in its CL_RSP
+    uint64_t client_qid;
     void clear();
     void release();
     virtual bool isReconQuery() {return false;}
@@ -40,6 +42,8 @@ public:
     // Prevent unnecessary remote messages
     Array<uint64_t> partitions;
     Array<uint64_t> partitions_touched;
+    // the remote partitions of partitions_touched that wrote (TWOPC_OPT_CC)
+    Array<uint64_t> partitions_modified;
     Array<uint64_t> active_nodes;
     Array<uint64_t> participant_nodes;
 
@@ -38,15 +38,32 @@ void Sequencer::init(Workload * wl) {
 	last_time_batch = 0;
 	wl_head = NULL;
 	wl_tail = NULL;
-	fill_queue = new boost::lockfree::queue<Message*, boost::lockfree::capacity<65526> > [g_node_cnt];
+	for (uint64_t i = 0; i < SEQ_EPOCH_DEPTH; i++) epoch_ring[i] = NULL;
+	inflight_epochs = 0;
+	fill_queue[0] = new std::vector<Message*> [g_node_cnt];
+	fill_queue[1] = new std::vector<Message*> [g_node_cnt];
+	dispatch_pending = false;
+	dispatch_epoch = 0;
+	dispatch_node = 0;
+	dispatch_pos = 0;
+	batch_timer = g_seq_batch_time_limit;
 }
 
-// Assumes 1 thread does sequencer work
-void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
-	qlite_ll * en = wl_head;
-	while(en != NULL && en->epoch != msg->get_batch_id()) {
+// A ring slot is reused once the sequencer is SEQ_EPOCH_DEPTH epochs ahead;
+// an epoch still running past that is found on the wait list.
+qlite_ll * Sequencer::get_wait_list(uint64_t epoch) {
+	qlite_ll * en = epoch_ring[epoch % SEQ_EPOCH_DEPTH];
+	if (en != NULL && en->epoch == epoch) return en;
+	en = wl_head;
+	while(en != NULL && en->epoch != epoch) {
 		en = en->next;
 	}
+	return en;
+}
+
+// Assumes 1 thread does sequencer work
+void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
+	qlite_ll * en = get_wait_list(msg->get_batch_id());
 	assert(en);
 	qlite * wait_list = en->list;
 	assert(wait_list != NULL);
@@ -161,6 +178,7 @@ void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
 			ClientResponseMessage *rsp_msg =
 					(ClientResponseMessage *)Message::create_message(msg->get_txn_id(), CL_RSP);
 					rsp_msg->client_startts = wait_list[id].client_startts;
+					rsp_msg->client_qid = wait_list[id].client_qid;
 					msg_queue.enqueue(thd_id,rsp_msg,wait_list[id].client_id);
 #if WORKLOAD == PPS
 			}
@@ -174,6 +192,8 @@ void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
 	if (en->txns_left == 0) {
 			DEBUG("FINISHED BATCH %ld\n",en->epoch);
 			LIST_REMOVE_HT(en,wl_head,wl_tail);
+			if (epoch_ring[en->epoch % SEQ_EPOCH_DEPTH] == en) epoch_ring[en->epoch % SEQ_EPOCH_DEPTH] = NULL;
+			inflight_epochs--;
 			mem_allocator.free(en->list,sizeof(qlite) * en->max_size);
 			mem_allocator.free(en,sizeof(qlite_ll));
 	}
@@ -186,10 +206,10 @@ void Sequencer::process_txn(Message *msg, uint64_t thd_id, uint64_t early_start,
 
 		uint64_t starttime = get_sys_clock();
 		DEBUG("SEQ Processing msg\n");
-		qlite_ll * en = wl_tail;
+		uint64_t epoch = simulation->get_seq_epoch()+1;
+		qlite_ll * en = epoch_ring[epoch % SEQ_EPOCH_DEPTH];
 
-		// LL is potentially a bottleneck here
-		if(!en || en->epoch != simulation->get_seq_epoch()+1) {
+		if(!en || en->epoch != epoch) {
 			DEBUG("SEQ new wait list for epoch %ld\n",simulation->get_seq_epoch()+1);
 			// First txn of new wait list
 			en = (qlite_ll *) mem_allocator.alloc(sizeof(qlite_ll));
@@ -199,6 +219,8 @@ void Sequencer::process_txn(Message *msg, uint64_t thd_id, uint64_t early_start,
 			en->txns_left = 0;
 			en->list = (qlite *) mem_allocator.alloc(sizeof(qlite) * en->max_size);
 			LIST_PUT_TAIL(wl_head,wl_tail,en)
+			epoch_ring[epoch % SEQ_EPOCH_DEPTH] = en;
+			inflight_epochs++;
 		}
 		if(en->size == en->max_size) {
 			en->max_size *= 2;
@@ -226,6 +248,7 @@ void Sequencer::process_txn(Message *msg, uint64_t thd_id, uint64_t early_start,
 		assert(ISCLIENTN(msg->get_return_id()));
 		en->list[id].client_id = msg->get_return_id();
 		en->list[id].client_startts = ((ClientQueryMessage*)msg)->client_startts;
+		en->list[id].client_qid = ((ClientQueryMessage*)msg)->client_qid;
 		//en->list[id].seq_startts = get_sys_clock();
 
 		en->list[id].total_batch_time = wait_time;
@@ -270,8 +293,7 @@ void Sequencer::process_txn(Message *msg, uint64_t thd_id, uint64_t early_start,
 		for(auto participant = participants.begin(); participant != participants.end(); participant++) {
 			DEBUG("SEQ adding (%ld,%ld) to fill queue (recon: %d)\n", msg->get_txn_id(),
 					msg->get_batch_id(), ((PPSClientQueryMessage *)msg)->recon);
-			while (!fill_queue[*participant].push(msg) && !simulation->is_done()) {
-			}
+			fill_queue[epoch % 2][*participant].push_back(msg);
 		}
 
 	INC_STATS(thd_id,seq_process_cnt,1);
@@ -280,38 +302,26 @@ void Sequencer::process_txn(Message *msg, uint64_t thd_id, uint64_t early_start,
 }
 
 // Assumes 1 thread does sequencer work
+// Seals the current epoch; its messages go out through dispatch() while the
+// next epoch is being filled.
 void Sequencer::send_next_batch(uint64_t thd_id) {
 	uint64_t prof_stat = get_sys_clock();
-	qlite_ll * en = wl_tail;
+	uint64_t epoch = simulation->get_seq_epoch();
+	qlite_ll * en = epoch_ring[epoch % SEQ_EPOCH_DEPTH];
 	bool empty = true;
-	if(en && en->epoch == simulation->get_seq_epoch()) {
-		DEBUG("SEND NEXT BATCH %ld [%ld,%ld] %ld\n", thd_id, simulation->get_seq_epoch(), en->epoch,
-					en->size);
+	if(en && en->epoch == epoch) {
+		DEBUG("SEND NEXT BATCH %ld [%ld,%ld] %ld\n", thd_id, epoch, en->epoch, en->size);
 		empty = false;
 
 		en->batch_send_time = prof_stat;
 	}
 
-	Message * msg;
-	for(uint64_t j = 0; j < g_node_cnt; j++) {
-		while(fill_queue[j].pop(msg)) {
-			if(j == g_node_id) {
-					work_queue.sched_enqueue(thd_id,msg);
-			} else {
-				msg_queue.enqueue(thd_id,msg,j);
-			}
-		}
-		if(!empty) {
-			DEBUG("Seq RDONE %ld\n",simulation->get_seq_epoch())
-		}
-		msg = Message::create_message(RDONE);
-		msg->batch_id = simulation->get_seq_epoch();
-		if(j == g_node_id) {
-			work_queue.sched_enqueue(thd_id,msg);
-		} else {
-			msg_queue.enqueue(thd_id,msg,j);
-		}
-	}
+	// the previous epoch shares its buffers with the one filled next
+	while (dispatch_pending) dispatch(thd_id);
+	dispatch_pending = true;
+	dispatch_epoch = epoch;
+	dispatch_node = 0;
+	dispatch_pos = 0;
 
 	if(last_time_batch > 0) {
 		INC_STATS(thd_id,seq_batch_time,get_sys_clock() - last_time_batch);
@@ -322,7 +332,56 @@ void Sequencer::send_next_batch(uint64_t thd_id) {
 	if(!empty) {
 		INC_STATS(thd_id,seq_full_batch_cnt,1);
 	}
+#if SEQ_BATCH_ADAPTIVE
+	adapt_batch_timer();
+#endif
 	INC_STATS(thd_id,seq_prep_time,get_sys_clock() - prof_stat);
 	next_txn_id = 0;
 }
 
+// Sends up to SEQ_DISPATCH_BATCH messages of the sealed epoch, each node's
+// txns followed by its RDONE.
+void Sequencer::dispatch(uint64_t thd_id) {
+	if (!dispatch_pending) return;
+	uint64_t prof_stat = get_sys_clock();
+	std::vector<Message*> * queues = fill_queue[dispatch_epoch % 2];
+	uint64_t sent = 0;
+	Message * msg;
+	while(dispatch_node < g_node_cnt && sent < SEQ_DISPATCH_BATCH) {
+		std::vector<Message*> &queue = queues[dispatch_node];
+		if (dispatch_pos < queue.size()) {
+			msg = queue[dispatch_pos++];
+			if(dispatch_node == g_node_id) {
+				work_queue.sched_enqueue(thd_id,msg);
+			} else {
+				msg_queue.enqueue(thd_id,msg,dispatch_node);
+			}
+			sent++;
+			continue;
+		}
+		DEBUG("Seq RDONE %ld\n",dispatch_epoch)
+		msg = Message::create_message(RDONE);
+		msg->batch_id = dispatch_epoch;
+		if(dispatch_node == g_node_id) {
+			work_queue.sched_enqueue(thd_id,msg);
+		} else {
+			msg_queue.enqueue(thd_id,msg,dispatch_node);
+		}
+		queue.clear();
+		dispatch_node++;
+		dispatch_pos = 0;
+	}
+	if (dispatch_node == g_node_cnt) dispatch_pending = false;
+	INC_STATS(thd_id,seq_prep_time,get_sys_clock() - prof_stat);
+}
+
+// With the workers keeping up, only the sealed epoch and the one before it
+// are in flight and a shorter timer just cuts batching latency; a backlog
+// means epochs are too short to amortize their per-epoch cost.
+void Sequencer::adapt_batch_timer() {
+	if (inflight_epochs > 2) {
+		batch_timer = std::min(batch_timer * 5 / 4, (uint64_t)g_seq_batch_time_limit);
+	} else if (inflight_epochs <= 1) {
+		batch_timer = std::max(batch_timer * 9 / 10, (uint64_t)g_seq_batch_time_min);
+	}
+}
@@ -29,6 +29,7 @@ typedef struct qlite_entry {
 	BaseQuery * qry;
 	uint32_t client_id;
 	uint64_t client_startts;
+	uint64_t client_qid;
 	uint64_t seq_startts;
 	uint64_t seq_first_startts;
 	uint64_t skew_startts;
@@ -56,11 +57,23 @@ class Sequencer {
 	void process_txn(Message* msg, uint64_t thd_id, uint64_t early_start, uint64_t last_start,
 									 uint64_t wait_time, uint32_t abort_cnt);
 	void send_next_batch(uint64_t thd_id);
+	void dispatch(uint64_t thd_id);
+	uint64_t get_batch_timer() { return batch_timer; }
 
  private:
 	void reset_participating_nodes(bool * part_nodes);
+	qlite_ll * get_wait_list(uint64_t epoch);
+	void adapt_batch_timer();
 
-	boost::lockfree::queue<Message*, boost::lockfree::capacity<65526> > * fill_queue;
+	// Per node txns of an epoch, double buffered by epoch % 2: the epoch being
+	// filled and the last sealed epoch, whose dispatch is spread over the
+	// following sequencer loop iterations.
+	std::vector<Message*> * fill_queue[2];
+	bool dispatch_pending;
+	uint64_t dispatch_epoch;
+	uint64_t dispatch_node;
+	uint64_t dispatch_pos;
+	uint64_t batch_timer;
 #if WORKLOAD == YCSB
 	YCSBQuery* node_queries;
 #elif WORKLOAD == TPCC
@@ -74,6 +87,8 @@ class Sequencer {
 	uint64_t last_time_batch;
 	qlite_ll * wl_head;		// list of txns in batch being executed
 	qlite_ll * wl_tail;		// list of txns in batch being executed
+	qlite_ll * epoch_ring[SEQ_EPOCH_DEPTH];	// wait lists by epoch % SEQ_EPOCH_DEPTH
+	uint64_t inflight_epochs;
 	volatile uint32_t next_txn_id;
 	Workload * _wl;
 };
@@ -126,9 +126,9 @@ void SimManager::decr_epoch_txn_cnt() { ATOM_SUB(epoch_txn_cnt, 1); }
 
 uint64_t SimManager::get_seq_epoch() { return seq_epoch; }
 
-void SimManager::advance_seq_epoch() {
+void SimManager::advance_seq_epoch(uint64_t batch_time) {
 	ATOM_ADD(seq_epoch,1);
-	last_seq_epoch_time += g_seq_batch_time_limit;
+	last_seq_epoch_time += batch_time;
 }
 
 uint64_t SimManager::get_worker_epoch() { return worker_epoch; }
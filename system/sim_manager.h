@@ -52,7 +52,7 @@ public:
   uint64_t get_worker_epoch();
   void next_worker_epoch();
   uint64_t get_seq_epoch();
-  void advance_seq_epoch();
+  void advance_seq_epoch(uint64_t batch_time);
   void inc_epoch_txn_cnt();
   void decr_epoch_txn_cnt();
   double seconds_from_start(uint64_t time);
@@ -1,4 +1,8 @@
 #include "stat_thread.h"
+#include "stats.h"
+#include "stats_hist.h"
+#include "work_queue.h"
+#include "msg_queue.h"
 
 
 void StatThread::setup() {
@@ -17,8 +21,14 @@ RC StatThread::run(){
 
   uint64_t cnt;
   cnt = (get_sys_clock() - g_starttime) / BILLION;
+#if TS_ENABLE
+  ts_init();
+#endif
 
   while(!simulation->is_done()) {
+#if TS_ENABLE
+    if (get_sys_clock() - ts_time >= g_ts_interval) ts_export();
+#endif
     while (((get_sys_clock() - g_starttime) / BILLION) >= cnt){
       now = times(&timeSample);
       if (now <= lastCPU || timeSample.tms_stime < lastSysCPU || timeSample.tms_utime < lastUserCPU) {
@@ -40,5 +50,91 @@ RC StatThread::run(){
       lastUserCPU = timeSample.tms_utime;
     }
   }
+#if TS_ENABLE
+  ts_export();
+  fclose(ts_file);
+  delete ts_snap;
+  delete ts_cur;
+  delete ts_prev;
+#endif
   return RCOK;
-}
\ No newline at end of file
+}
+
+void StatThread::ts_init() {
+  char name[64];
+  sprintf(name, "%s_%d.%s", TS_FILE, g_node_id, TS_FORMAT == TS_JSON ? "json" : "csv");
+  ts_file = fopen(name, "w");
+  assert(ts_file != NULL);
+#if TS_FORMAT == TS_CSV
+  fprintf(ts_file, "time,node,commit_cnt,abort_cnt,tput,abort_rate,txn_queue,msg_queue,"
+                   "msg_send_rate,msg_recv_rate,lat_cnt,lat_p50,lat_p99,lat_p999,lat_max\n");
+#endif
+  ts_time = get_sys_clock();
+  ts_commit_cnt = 0;
+  ts_abort_cnt = 0;
+  ts_send_cnt = 0;
+  ts_recv_cnt = 0;
+  ts_snap = new StatsHist;
+  ts_cur = new StatsHist;
+  ts_prev = new StatsHist;
+  ts_prev->init();
+}
+
+// Counters are read racily: each has a single writer and only grows, so a
+// sample is at worst one increment behind. Histograms are copied under
+// their seqlock.
+void StatThread::ts_export() {
+  uint64_t time = get_sys_clock();
+  uint64_t commit_cnt = 0;
+  uint64_t abort_cnt = 0;
+  uint64_t send_cnt = 0;
+  uint64_t recv_cnt = 0;
+  ts_cur->init();
+  for (uint64_t i = 0; i < g_total_thread_cnt; i++) {
+    Stats_thd * s = stats._stats[i];
+    commit_cnt += s->total_txn_commit_cnt;
+    abort_cnt += s->total_txn_abort_cnt;
+    send_cnt += s->msg_send_cnt;
+    recv_cnt += s->msg_recv_cnt;
+    s->start_abort_commit_latency.snapshot(*ts_snap);
+    ts_cur->merge(*ts_snap);
+  }
+  // stats may be cleared between two exports; start a new window then
+  uint64_t commit = commit_cnt >= ts_commit_cnt ? commit_cnt - ts_commit_cnt : commit_cnt;
+  uint64_t abort = abort_cnt >= ts_abort_cnt ? abort_cnt - ts_abort_cnt : abort_cnt;
+  uint64_t send = send_cnt >= ts_send_cnt ? send_cnt - ts_send_cnt : send_cnt;
+  uint64_t recv = recv_cnt >= ts_recv_cnt ? recv_cnt - ts_recv_cnt : recv_cnt;
+  StatsHist * window = ts_prev;
+  *ts_snap = *ts_cur;
+  if (ts_cur->cnt >= ts_prev->cnt) ts_snap->subtract(*ts_prev);
+  ts_prev = ts_cur;
+  ts_cur = window;
+
+  double sec = (double)(time - ts_time) / BILLION;
+  if (sec <= 0) sec = 1;
+  double elapsed = (double)(time - g_starttime) / BILLION;
+  double abort_rate = commit + abort > 0 ? (double)abort / (commit + abort) : 0;
+  uint64_t txn_queue = work_queue.get_txn_cnt();
+  uint64_t msg_cnt = msg_queue.get_cnt();
+#if TS_FORMAT == TS_JSON
+  fprintf(ts_file,
+          "{\"time\":%f,\"node\":%d,\"commit_cnt\":%ld,\"abort_cnt\":%ld,\"tput\":%f,"
+          "\"abort_rate\":%f,\"txn_queue\":%ld,\"msg_queue\":%ld,\"msg_send_rate\":%f,"
+          "\"msg_recv_rate\":%f,\"lat_cnt\":%ld,\"lat_p50\":%f,\"lat_p99\":%f,"
+          "\"lat_p999\":%f,\"lat_max\":%f}\n",
+#else
+  fprintf(ts_file, "%f,%d,%ld,%ld,%f,%f,%ld,%ld,%f,%f,%ld,%f,%f,%f,%f\n",
+#endif
+          elapsed, g_node_id, commit, abort, commit / sec, abort_rate, txn_queue, msg_cnt,
+          send / sec, recv / sec, ts_snap->cnt, (double)ts_snap->get_percentile(50) / BILLION,
+          (double)ts_snap->get_percentile(99) / BILLION,
+          (double)ts_snap->get_percentile(99.9) / BILLION,
+          (double)ts_snap->get_max() / BILLION);
+  fflush(ts_file);
+
+  ts_time = time;
+  ts_commit_cnt = commit_cnt;
+  ts_abort_cnt = abort_cnt;
+  ts_send_cnt = send_cnt;
+  ts_recv_cnt = recv_cnt;
+}
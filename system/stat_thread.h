@@ -1,6 +1,8 @@
 #include "thread.h"
 #include "global.h"
 
+class StatsHist;
+
 using namespace std;
 
 class StatThread : public Thread{
@@ -11,5 +13,19 @@ public:
   clock_t now, lastCPU, lastSysCPU, lastUserCPU;
   struct tms timeSample;
   double percent;
+
+private:
+  // time series export; reads the live Stats_thd without stopping the workers
+  void ts_init();
+  void ts_export();
+  FILE * ts_file;
+  uint64_t ts_time;
+  uint64_t ts_commit_cnt;
+  uint64_t ts_abort_cnt;
+  uint64_t ts_send_cnt;
+  uint64_t ts_recv_cnt;
+  StatsHist * ts_snap; // copy of one thread's histogram
+  StatsHist * ts_cur; // all threads at this export
+  StatsHist * ts_prev; // all threads at the last export
 };
 
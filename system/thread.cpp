@@ -21,6 +21,8 @@
 #include "manager.h"
 #include "math.h"
 #include "message.h"
+#include "placement.h"
+#include "stats.h"
 #include "msg_queue.h"
 #include "query.h"
 #include "txn.h"
@@ -65,6 +67,10 @@ void Thread::tsetup() {
   fflush(stdout);
 	pthread_barrier_wait( &warmup_bar );
 
+#if STATS_ENABLE
+  // allocated by main; move it next to the thread that updates it
+  placement.bind_memory(stats._stats[_thd_id], sizeof(Stats_thd), _thd_id);
+#endif
   setup();
 
 	printf("Running %ld:%ld\n",_node_id, _thd_id);
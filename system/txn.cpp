@@ -25,6 +25,7 @@
 #include "focc.h"
 #include "bocc.h"
 #include "row_occ.h"
+#include "row_lock.h"
 #include "table.h"
 #include "catalog.h"
 #include "dli.h"
@@ -264,6 +265,7 @@ void Transaction::init() {
 	batch_id = UINT64_MAX;
 	DEBUG_M("Transaction::init array insert_rows\n");
 	insert_rows.init(g_max_items_per_txn + 10);
+	delete_rows.init(g_max_items_per_txn + 10);
 	DEBUG_M("Transaction::reset array accesses\n");
 	accesses.init(MAX_ROW_PER_TXN);
 
@@ -275,6 +277,7 @@ void Transaction::reset(uint64_t thd_id) {
 	accesses.clear();
 	//release_inserts(thd_id);
 	insert_rows.clear();
+	delete_rows.clear();
 	write_cnt = 0;
 	row_cnt = 0;
 	twopc_state = START;
@@ -311,6 +314,7 @@ void Transaction::release(uint64_t thd_id) {
 	release_inserts(thd_id);
 	DEBUG_M("Transaction::release array insert_rows free\n")
 	insert_rows.release();
+	delete_rows.release();
 }
 
 void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
@@ -331,6 +335,10 @@ void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
 	//query->init();
 	//reset();
 	sem_init(&rsp_mutex, 0, 1);
+#if CLV_CC
+	sem_init(&clv_mutex, 0, 1);
+	clv_dependents.clear();
+#endif
 	return_id = UINT64_MAX;
 
 	this->h_wl = h_wl;
@@ -350,6 +358,10 @@ void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
 	phase = CALVIN_RW_ANALYSIS;
 	locking_done = false;
 	calvin_locked_rows.init(MAX_ROW_PER_TXN);
+	calvin_lock_types.init(MAX_ROW_PER_TXN);
+	calvin_collect = false;
+	calvin_seq = 0;
+	calvin_msg = NULL;
 #endif
 #if CC_ALG == DLI_MVCC || CC_ALG == DLI_MVCC_OCC
 	is_abort = nullptr;
@@ -371,6 +383,13 @@ void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
 	registed_ = false;
 	txn_ready = true;
 	twopl_wait_start = 0;
+	log_flushed = true;
+	repl_finished = true;
+	finished = false;
+	admitted = false;
+#if CLV_CC
+	clv_reset();
+#endif
 
 	txn_stats.init();
 }
@@ -385,9 +404,14 @@ void TxnManager::reset() {
 #endif
 	ready_part = 0;
 	rsp_cnt = 0;
+	co_point = 0;
+	readers_finished = false;
 	aborted = false;
 	return_id = UINT64_MAX;
 	twopl_wait_start = 0;
+#if CLV_CC
+	clv_reset();
+#endif
 
 	//ready = true;
 
@@ -405,6 +429,8 @@ void TxnManager::reset() {
 	phase = CALVIN_RW_ANALYSIS;
 	locking_done = false;
 	calvin_locked_rows.clear();
+	calvin_lock_types.clear();
+	calvin_collect = false;
 #endif
 
 	assert(txn);
@@ -433,6 +459,7 @@ void TxnManager::release() {
 
 #if CC_ALG == CALVIN
 	calvin_locked_rows.release();
+	calvin_lock_types.release();
 #endif
 #if CC_ALG == SILO
   num_locks = 0;
@@ -452,9 +479,17 @@ void TxnManager::reset_query() {
 #endif
 }
 
-RC TxnManager::commit() {
+RC TxnManager::commit(bool log_wait) {
 	DEBUG("Commit %ld\n",get_txn_id());
+#if LOGGING
+	// images must be captured before release_locks installs or frees them
+	log_wait = log_commit(log_wait);
+#endif
+	commit_indexes();
 	release_locks(RCOK);
+#if CLV_CC
+	clv_finish(RCOK);
+#endif
 #if CC_ALG == MAAT
 	time_table.release(get_thd_id(),get_txn_id());
 #endif
@@ -467,19 +502,99 @@ RC TxnManager::commit() {
 #if CC_ALG == SSI
 	inout_table.set_commit_ts(get_thd_id(), get_txn_id(), get_commit_timestamp());
 	inout_table.set_state(get_thd_id(), get_txn_id(), SSI_COMMITTED);
+#endif
+#if LOGGING
+	logger.endInstall(get_thd_id());
 #endif
 	commit_stats();
 #if LOGGING
-	LogRecord * record = logger.createRecord(get_txn_id(),L_NOTIFY,0,0);
-	if(g_repl_cnt > 0) {
+	// acknowledged by LOG_FLUSHED once the epoch holding the commit record is durable
+	if (log_wait) return WAIT;
+#endif
+	return Commit;
+}
+
+#if LOGGING
+// Append one redo/undo record per written tuple, one redo record per inserted
+// tuple, one undo record per deleted tuple, plus the commit record to this
+// worker's log buffer. All records of the transaction are contiguous in the log.
+// A transaction that wrote nothing logs nothing. Returns whether a LOG_FLUSHED
+// was asked for, which only happens with log_wait.
+bool TxnManager::log_commit(bool log_wait) {
+	uint64_t starttime = get_sys_clock();
+	uint64_t size = Logger::getRecordSize(0, 0);
+	uint64_t write_cnt = txn->insert_rows.size() + txn->delete_rows.size();
+	for (uint64_t rid = 0; rid < txn->row_cnt; rid++) {
+		Access * access = txn->accesses[rid];
+		if (access->type != WR) continue;
+		uint64_t tuple_size = access->orig_row->get_tuple_size();
+		size += Logger::getRecordSize(tuple_size, tuple_size);
+		write_cnt++;
+	}
+	if (write_cnt == 0) return false;
+	for (uint64_t i = 0; i < txn->insert_rows.size(); i++)
+		size += Logger::getRecordSize(0, txn->insert_rows[i]->get_tuple_size());
+	for (uint64_t i = 0; i < txn->delete_rows.size(); i++)
+		size += Logger::getRecordSize(txn->delete_rows[i]->get_tuple_size(), 0);
+
+	char * buf = logger.reserveBuffer(get_thd_id(), size);
+	// ended by commit once the writes are in the tables
+	logger.beginInstall(get_thd_id());
+	uint64_t ptr = 0;
+	for (uint64_t rid = 0; rid < txn->row_cnt; rid++) {
+		Access * access = txn->accesses[rid];
+		if (access->type != WR) continue;
+		row_t * row = access->orig_row;
+		uint64_t tuple_size = row->get_tuple_size();
+		char * after = access->data->get_data();
+#if ROLL_BACK && (CC_ALG == DL_DETECT || CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || \
+									CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC)
+		// updated in place; the before image is the rollback copy
+		char * before = access->orig_data->get_data();
+#elif CC_ALG == DL_DETECT || CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN || \
+		CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC
+		// updated in place without a rollback copy: redo only
+		char * before = NULL;
+#else
+		// writes are still private to the access; the shared row is the before image
+		char * before = row->get_data();
+#endif
+		logger.writeRecord(buf, ptr, get_txn_id(), L_UPDATE, row->get_part_id(),
+											 row->get_table()->get_table_id(), row->get_primary_key(), before,
+											 before ? tuple_size : 0, after, tuple_size);
+	}
+	for (uint64_t i = 0; i < txn->insert_rows.size(); i++) {
+		row_t * row = txn->insert_rows[i];
+		logger.writeRecord(buf, ptr, get_txn_id(), L_INSERT, row->get_part_id(),
+											 row->get_table()->get_table_id(), row->get_primary_key(), NULL, 0,
+											 row->get_data(), row->get_tuple_size());
+	}
+	for (uint64_t i = 0; i < txn->delete_rows.size(); i++) {
+		// the before image locates the row, as the redo image does for an update
+		row_t * row = txn->delete_rows[i];
+		logger.writeRecord(buf, ptr, get_txn_id(), L_DELETE, row->get_part_id(),
+											 row->get_table()->get_table_id(), row->get_primary_key(),
+											 row->get_data(), row->get_tuple_size(), NULL, 0);
+	}
+	logger.writeRecord(buf, ptr, get_txn_id(), L_NOTIFY, 0, 0, 0, NULL, 0, NULL, 0);
+	assert(ptr <= size);
+	if (log_wait) {
+		// set before the log thread can answer
+		log_flushed = false;
+		repl_finished = g_repl_cnt == 0;
+	}
+	logger.releaseBuffer(get_thd_id(), ptr, log_wait ? get_txn_id() : UINT64_MAX);
+
+	if(log_wait && g_repl_cnt > 0) {
+		LogRecord * record = logger.createRecord(get_txn_id(),L_NOTIFY,0,0);
 		msg_queue.enqueue(get_thd_id(), Message::create_message(record, LOG_MSG),
 											g_node_id + g_node_cnt + g_client_node_cnt);
+		mem_allocator.free(record,sizeof(LogRecord));
 	}
-	logger.enqueueRecord(record);
-	return WAIT;
-#endif
-	return Commit;
+	INC_STATS(get_thd_id(),log_process_time,get_sys_clock() - starttime);
+	return log_wait;
 }
+#endif
 
 RC TxnManager::abort() {
 	if (aborted) return Abort;
@@ -500,6 +615,9 @@ RC TxnManager::abort() {
 
 	aborted = true;
 	release_locks(Abort);
+#if CLV_CC
+	clv_finish(Abort);
+#endif
 #if CC_ALG == MAAT
 	//assert(time_table.get_state(get_txn_id()) == MAAT_ABORTED);
 	time_table.release(get_thd_id(),get_txn_id());
@@ -589,19 +707,47 @@ RC TxnManager::start_commit() {
   	// INC_STATS(get_thd_id(), trans_process_count, 1);
 	RC rc = RCOK;
 	DEBUG("%ld start_commit RO?%d\n",get_txn_id(),query->readonly());
-	if(is_multi_part()) {
+#if CLV_CC
+	rc = clv_commit_ready();
+	if(rc == WAIT) return WAIT;
+	if(rc == Abort) return start_abort();
+#endif
+	bool multi_part = is_multi_part();
+#if TWOPC_OPT_CC
+	// every lock is held: release the participants that only read and commit among the
+	// remote writers; without one this is a local commit
+	if(multi_part) {
+		send_readonly_finish_messages();
+		multi_part = query->partitions_modified.size() > 0;
+	}
+#endif
+	if(multi_part) {
 		
 		//std::cout<<"multi part ";
-		if(CC_ALG == TICTOC) {
+		if(TWOPC_OPT_CC && !CLV_CC && query->partitions_modified.size() == 1) {
+			// one phase: the single remote writer gets the decision, its RACK_FIN ends the txn;
+			// not under CLV_CC, where the writer may still abort with a txn it depends on.
+			// With LOGGING the local commit records must be durable too: whichever of
+			// process_rack_rfin and process_log_flushed comes last ends it.
+			txn_stats.finish_start_time = get_sys_clock();
+			txn_stats.trans_commit_network_start_time = get_sys_clock();
+			send_finish_messages();
+			rc = commit();
+			assert(rc == Commit || (LOGGING && rc == WAIT));
+			rc = WAIT_REM;
+		} else if(CC_ALG == TICTOC) {
 			rc = validate();
 			if (rc != Abort) {
 				txn_stats.trans_validate_network_start_time = get_sys_clock();
 				send_prepare_messages();
 				rc = WAIT_REM;
 			}
-		} else if (!query->readonly() || CC_ALG == OCC || CC_ALG == MAAT || CC_ALG == DLI_BASE ||
-				CC_ALG == DLI_OCC || CC_ALG == SILO || CC_ALG == BOCC || CC_ALG == SSI) {
+		} else if (!query->readonly() || CLV_CC || CC_ALG == OCC || CC_ALG == MAAT ||
+				CC_ALG == DLI_BASE || CC_ALG == DLI_OCC || CC_ALG == SILO || CC_ALG == BOCC || CC_ALG == SSI) {
 			// send prepare messages
+#if CLV_CC
+			clv_retire_locks();
+#endif
 			txn_stats.trans_validate_network_start_time = get_sys_clock();
 			send_prepare_messages();
 			rc = WAIT_REM;
@@ -909,28 +1055,52 @@ bool TxnManager::check_update(){
 }
 
 void TxnManager::send_prepare_messages() {
-	rsp_cnt = query->partitions_touched.size() - 1;
-	DEBUG("%ld Send PREPARE messages to %d\n",get_txn_id(),rsp_cnt);
+	rsp_cnt = 0;
 	for(uint64_t i = 0; i < query->partitions_touched.size(); i++) {
-	if(get_part_node_id(query->partitions_touched[i]) == g_node_id) {
-		continue;
-	}
+		if(!is_commit_participant(query->partitions_touched[i])) {
+			continue;
+		}
+		rsp_cnt++;
 		msg_queue.enqueue(get_thd_id(), Message::create_message(this, RPREPARE),
 											get_part_node_id(query->partitions_touched[i]));
 	}
+	DEBUG("%ld Send PREPARE messages to %d\n",get_txn_id(),rsp_cnt);
 }
 
 void TxnManager::send_finish_messages() {
-	rsp_cnt = query->partitions_touched.size() - 1;
+	rsp_cnt = 0;
 	assert(IS_LOCAL(get_txn_id()));
-	DEBUG("%ld Send FINISH messages to %d\n",get_txn_id(),rsp_cnt);
 	for(uint64_t i = 0; i < query->partitions_touched.size(); i++) {
-		if(get_part_node_id(query->partitions_touched[i]) == g_node_id) {
+		if(!is_commit_participant(query->partitions_touched[i])) {
 			continue;
-    }
+		}
+		rsp_cnt++;
 		msg_queue.enqueue(get_thd_id(), Message::create_message(this, RFIN),
 											get_part_node_id(query->partitions_touched[i]));
 	}
+	DEBUG("%ld Send FINISH messages to %d\n",get_txn_id(),rsp_cnt);
+}
+
+// A participant that only read holds nothing the outcome depends on once the txn has
+// all its locks. Its RFIN is final, is not answered and may wait for the next batch.
+void TxnManager::send_readonly_finish_messages() {
+	for(uint64_t i = 0; i < query->partitions_touched.size(); i++) {
+		uint64_t part_id = query->partitions_touched[i];
+		if(get_part_node_id(part_id) == g_node_id || query->partitions_modified.contains(part_id)) {
+			continue;
+		}
+		FinishMessage * msg = (FinishMessage*)Message::create_message(this, RFIN);
+		msg->readonly = true;
+		msg->piggyback = true;
+		msg_queue.enqueue(get_thd_id(), msg, get_part_node_id(part_id));
+	}
+	readers_finished = true;
+}
+
+bool TxnManager::is_commit_participant(uint64_t part_id) {
+	if(get_part_node_id(part_id) == g_node_id) return false;
+	if(readers_finished && !query->partitions_modified.contains(part_id)) return false;
+	return true;
 }
 
 /*fix 改成值负责发送消息
@@ -1020,6 +1190,27 @@ void TxnManager::commit_stats() {
 			INC_STATS(get_thd_id(),single_part_txn_cnt,1);
 			INC_STATS(get_thd_id(),single_part_txn_run_time,timespan_long);
 		}
+#if WORKLOAD == TPCC
+		switch (((TPCCQuery *)query)->txn_type) {
+			case TPCC_PAYMENT:
+				INC_STATS(get_thd_id(),tpcc_payment_cnt,1);
+				break;
+			case TPCC_NEW_ORDER:
+				INC_STATS(get_thd_id(),tpcc_new_order_cnt,1);
+				break;
+			case TPCC_ORDER_STATUS:
+				INC_STATS(get_thd_id(),tpcc_order_status_cnt,1);
+				break;
+			case TPCC_DELIVERY:
+				INC_STATS(get_thd_id(),tpcc_delivery_cnt,1);
+				break;
+			case TPCC_STOCK_LEVEL:
+				INC_STATS(get_thd_id(),tpcc_stock_level_cnt,1);
+				break;
+			default:
+				break;
+		}
+#endif
 	}
 	/*if(cflt) {
 		INC_STATS(get_thd_id(),cflt_cnt_txn,1);
@@ -1121,6 +1312,13 @@ void TxnManager::release_last_row_lock() {
 
 void TxnManager::cleanup_row(RC rc, uint64_t rid) {
 	access_t type = txn->accesses[rid]->type;
+#if CLV_CC
+	// read locks went in clv_retire_locks
+	if (clv_retired && type != WR) {
+		txn->accesses[rid]->data = NULL;
+		return;
+	}
+#endif
 	if (type == WR && rc == Abort && CC_ALG != MAAT) {
 		type = XP;
 	}
@@ -1242,6 +1440,7 @@ void TxnManager::cleanup(RC rc) {
 	if (rc == Abort) {
 		txn->release_inserts(get_thd_id());
 		txn->insert_rows.clear();
+		txn->delete_rows.clear();
 
 		INC_STATS(get_thd_id(), abort_time, get_sys_clock() - starttime);
 	}
@@ -1252,6 +1451,10 @@ RC TxnManager::get_lock(row_t * row, access_t type) {
 		return RCOK;
 	}
 	calvin_locked_rows.add(row);
+#if CC_ALG == CALVIN
+	calvin_lock_types.add(type);
+	if (calvin_collect) return RCOK;
+#endif
 	RC rc = row->get_lock(type, this);
 	if(rc == WAIT) {
 		INC_STATS(get_thd_id(), txn_wait_cnt, 1);
@@ -1360,19 +1563,6 @@ RC TxnManager::get_row(row_t * row, access_t type, row_t *& row_rtn) {
 	access->orig_data->init(row->get_table(), part_id, 0);
 	access->orig_data->copy(row);
 	assert(access->orig_data->get_schema() == row->get_schema());
-
-	// ARIES-style physiological logging
-#if LOGGING
-		// LogRecord * record =
-		// logger.createRecord(LRT_UPDATE,L_UPDATE,get_txn_id(),part_id,row->get_table()->get_table_id(),row->get_primary_key());
-		LogRecord *record = logger.createRecord(
-				get_txn_id(), L_UPDATE, row->get_table()->get_table_id(), row->get_primary_key());
-	if(g_repl_cnt > 0) {
-			msg_queue.enqueue(get_thd_id(), Message::create_message(record, LOG_MSG),
-												g_node_id + g_node_cnt + g_client_node_cnt);
-	}
-	logger.enqueueRecord(record);
-#endif
 	}
 #endif
 
@@ -1442,6 +1632,11 @@ void TxnManager::insert_row(row_t * row, table_t * table) {
 	txn->insert_rows.add(row);
 }
 
+void TxnManager::delete_row(row_t * row) {
+	if (CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC) return;
+	txn->delete_rows.add(row);
+}
+
 itemid_t *TxnManager::index_read(INDEX *index, idx_key_t key, int part_id) {
 	uint64_t starttime = get_sys_clock();
 
@@ -1468,6 +1663,16 @@ itemid_t *TxnManager::index_read(INDEX *index, idx_key_t key, int part_id, int c
 	return item;
 }
 
+itemid_t *TxnManager::index_probe(INDEX *index, idx_key_t key, int part_id) {
+	uint64_t starttime = get_sys_clock();
+
+	itemid_t * item;
+	index->index_probe(key, item, part_id);
+
+	INC_STATS(get_thd_id(), txn_index_time, get_sys_clock() - starttime);
+	return item;
+}
+
 RC TxnManager::validate() {
 #if MODE != NORMAL_MODE
 	return RCOK;
@@ -1586,3 +1791,80 @@ void TxnManager::release_locks(RC rc) {
 	uint64_t timespan = (get_sys_clock() - starttime);
 	INC_STATS(get_thd_id(), txn_cleanup_time,  timespan);
 }
+
+#if CLV_CC
+uint64_t TxnManager::clv_next_epoch = 0;
+
+// every attempt of a txn starts without dependencies, under a new epoch
+void TxnManager::clv_reset() {
+	sem_wait(&clv_mutex);
+	clv_epoch = ATOM_FETCH_ADD(clv_next_epoch, 1);
+	clv_retired = false;
+	clv_commit_wait = false;
+	clv_waiting = false;
+	clv_dep_abort = false;
+	clv_dep_cnt = 0;
+	sem_post(&clv_mutex);
+}
+
+// Prepared: no lock is acquired any more. Read locks are released for good, write locks
+// stay retired on their rows until commit or abort, which still restores the rows.
+void TxnManager::clv_retire_locks() {
+	for (uint64_t rid = 0; rid < txn->row_cnt; rid++) {
+		Access * access = txn->accesses[rid];
+		if (access->type == WR)
+			access->orig_row->manager->lock_retire(this);
+		else
+			access->orig_row->return_row(RCOK, access->type, this, NULL);
+	}
+	clv_retired = true;
+}
+
+// called under the latch of a row txn retired: txn cannot finish before this returns
+void TxnManager::clv_depend_on(TxnManager * txn) {
+	ATOM_ADD(clv_dep_cnt, 1);
+	sem_wait(&txn->clv_mutex);
+	txn->clv_dependents.push_back(std::make_pair(get_txn_id(), clv_epoch));
+	sem_post(&txn->clv_mutex);
+}
+
+// Gate of the vote and of the commit decision: RCOK once every txn this one depends on
+// committed, Abort if one of them aborted, WAIT until then. TxnTable::clv_resolve
+// reschedules the waiting txn; whoever clears clv_waiting first owns the continuation.
+RC TxnManager::clv_commit_ready() {
+	clv_commit_wait = false;
+	if (clv_dep_abort) return Abort;
+	if (clv_dep_cnt == 0) return RCOK;
+	ATOM_CAS(clv_waiting, false, true);
+	if ((clv_dep_cnt > 0 && !clv_dep_abort) || !ATOM_CAS(clv_waiting, true, false)) {
+		clv_commit_wait = true;
+		INC_STATS(get_thd_id(), clv_wait_cnt, 1);
+		return WAIT;
+	}
+	return clv_dep_abort ? Abort : RCOK;
+}
+
+// a txn this one depends on finished; true if this one has to be rescheduled
+bool TxnManager::clv_resolved(uint64_t epoch, bool aborted) {
+	bool wake = false;
+	sem_wait(&clv_mutex);
+	if (epoch == clv_epoch) {
+		if (aborted) clv_dep_abort = true;
+		if (ATOM_SUB_FETCH(clv_dep_cnt, 1) == 0 || aborted)
+			wake = ATOM_CAS(clv_waiting, true, false);
+	}
+	sem_post(&clv_mutex);
+	return wake;
+}
+
+// the locks are gone: let the dependents decide
+void TxnManager::clv_finish(RC rc) {
+	std::vector<std::pair<uint64_t, uint64_t> > dependents;
+	sem_wait(&clv_mutex);
+	dependents.swap(clv_dependents);
+	sem_post(&clv_mutex);
+	for (auto it = dependents.begin(); it != dependents.end(); it++)
+		txn_table.clv_resolve(get_thd_id(), it->first, it->second, rc == Abort);
+	if (rc == Abort) INC_STATS(get_thd_id(), clv_cascade_abort_cnt, dependents.size());
+}
+#endif
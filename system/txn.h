@@ -37,6 +37,24 @@ class TPCCQuery;
 
 enum TxnState {START,INIT,EXEC,PREP,FIN,DONE};
 
+/*
+	 Stackless resumable transaction bodies (TXN_COROUTINE). A body brackets its code
+	 with TXN_CO_BEGIN/TXN_CO_END and keeps everything that lives across a wait in the
+	 txn manager: locals do not survive a suspension and must not be declared with an
+	 initializer between the two. TXN_CO_AWAIT(rc) hands a WAIT, WAIT_REM or Abort
+	 back to the worker; the next run_txn() of the txn resumes right after it.
+	 */
+#define TXN_CO_BEGIN switch (co_point) { case 0:
+#define TXN_CO_AWAIT(rc) \
+	do { \
+		if ((rc) != RCOK) { \
+			co_point = __LINE__; \
+			return (rc); \
+			case __LINE__:; \
+		} \
+	} while (0)
+#define TXN_CO_END } co_point = 0;
+
 class Access {
 public:
 	access_t 	type;
@@ -75,6 +93,8 @@ public:
 	// Internal state
 	TxnState twopc_state;
 	Array<row_t*> insert_rows;
+	// rows the txn takes out of their indexes at commit; only logged here
+	Array<row_t*> delete_rows;
 	txnid_t         txn_id;
 	uint64_t batch_id;
 	RC rc;
@@ -161,6 +181,9 @@ public:
 	virtual RC      run_calvin_txn() = 0;
 	virtual RC      acquire_locks() = 0;
 	virtual RC 		send_remote_request() = 0;
+	// index maintenance of a committing txn (inserted rows, deleted keys); runs before its
+	// locks are released
+	virtual void    commit_indexes() {}
 	void            register_thread(Thread * h_thd);
 	uint64_t        get_thd_id();
 	Workload *      get_wl();
@@ -183,7 +206,9 @@ public:
 	uint64_t        incr_lr();
 	uint64_t        decr_lr();
 
-	RC commit();
+	// log_wait: under LOGGING, have LOG_FLUSHED acknowledge the commit (returns WAIT);
+	// false where nothing handles that message
+	RC commit(bool log_wait = true);
 	RC start_commit();
 	RC start_abort();
 	RC abort();
@@ -215,6 +240,8 @@ public:
     RC              finish(RC rc);
 #endif
 	bool send_RQRY_RSP;
+	// resume point of the transaction body, see TXN_CO_BEGIN
+	uint32_t co_point;
 	bool aborted;
 	uint64_t return_id;
 	RC        validate();
@@ -264,11 +291,21 @@ public:
 	// LOGGING
 	////////////////////////////////
 //	void 			gen_log_entry(int &length, void * log);
+#if LOGGING
+	bool log_commit(bool log_wait);
+#endif
+	// the commit records are not yet durable here / at the replica
 	bool log_flushed;
 	bool repl_finished;
+	bool log_pending() { return !log_flushed || !repl_finished; }
+	// WorkerThread::commit ran, which must happen once per txn
+	bool finished;
+	// ADMISSION_CC: holds the slot pop_new_txn took for it, given back on release
+	bool admitted;
 	Transaction * txn;
 	BaseQuery * query;
 	uint64_t client_startts;
+	uint64_t client_qid;
 	uint64_t client_id;
 	uint64_t get_abort_cnt() {return abort_cnt;}
 	uint64_t abort_cnt;
@@ -279,6 +316,32 @@ public:
 	//void send_rfin_messages(RC rc) {assert(false);}
 	void send_finish_messages();
 	void send_prepare_messages();
+	void send_readonly_finish_messages();
+	bool is_commit_participant(uint64_t part_id);
+	// TWOPC_OPT_CC: the read-only participants got their RFIN at the start of the commit
+	bool readers_finished;
+#if CLV_CC
+	// Controlled lock violation: a prepared txn releases its read locks and retires its write
+	// locks (Row_lock::lock_retire). A txn granted a retired lock depends on its holder: it
+	// neither votes nor commits before the holder finished, and aborts if the holder aborts.
+	void clv_retire_locks();
+	void clv_depend_on(TxnManager * txn);
+	bool clv_resolved(uint64_t epoch, bool aborted);
+	RC clv_commit_ready();
+	bool clv_retired;
+	// parked in start_commit/process_rprepare until its dependencies finish
+	bool clv_commit_wait;
+	volatile bool clv_waiting;
+	volatile bool clv_dep_abort;
+	volatile int64_t clv_dep_cnt;
+	// tells the attempts of a txn apart, dependents are notified by (txn_id, epoch)
+	uint64_t clv_epoch;
+	static uint64_t clv_next_epoch;
+	sem_t clv_mutex;
+	std::vector<std::pair<uint64_t, uint64_t> > clv_dependents;
+	void clv_finish(RC rc);
+	void clv_reset();
+#endif
 	void send_update_messages();
 
 	bool check_update();//true:synchronize the update, false:not
@@ -295,6 +358,12 @@ public:
 	bool locking_done;
 	CALVIN_PHASE phase;
 	Array<row_t*> calvin_locked_rows;
+	// Sharded lock threads: the scheduling thread collects the lock set
+	// (calvin_collect), then each lock shard acquires its own rows.
+	Array<access_t> calvin_lock_types;
+	bool calvin_collect;
+	uint64_t calvin_seq;
+	Message * calvin_msg;
 	bool calvin_exec_phase_done();
 	bool calvin_collect_phase_done();
 
@@ -311,9 +380,11 @@ public:  //从protected改的
 
 	int rsp_cnt;
 	void            insert_row(row_t * row, table_t * table);
+	void            delete_row(row_t * row);
 
 	itemid_t *      index_read(INDEX * index, idx_key_t key, int part_id);
 	itemid_t *      index_read(INDEX * index, idx_key_t key, int part_id, int count);
+	itemid_t *      index_probe(INDEX * index, idx_key_t key, int part_id);
 	RC get_lock(row_t * row, access_t type);
 	RC get_row(row_t * row, access_t type, row_t *& row_rtn);
 	RC get_row_post_wait(row_t *& row_rtn);
@@ -177,6 +177,35 @@ void TxnTable::restart_txn(uint64_t thd_id, uint64_t txn_id,uint64_t batch_id){
 
 }
 
+#if CLV_CC
+// A txn that txn_id (attempt epoch) depends on committed or aborted; the dependent is looked
+// up here since it may be gone already, and restarted if it waits for its commit.
+void TxnTable::clv_resolve(uint64_t thd_id, uint64_t txn_id, uint64_t epoch, bool aborted) {
+  uint64_t pool_id = txn_id % pool_size;
+  // set modify bit for this pool: txn_id % pool_size
+  while (!ATOM_CAS(pool[pool_id]->modify, false, true)) {
+  };
+
+  txn_node_t t_node = pool[pool_id]->head;
+
+  while (t_node != NULL) {
+    if(is_matching_txn_node(t_node,txn_id,0)) {
+      if(t_node->txn_man->clv_resolved(epoch, aborted)) {
+        if(IS_LOCAL(txn_id))
+          work_queue.enqueue(thd_id,Message::create_message(t_node->txn_man,RTXN_CONT),false);
+        else
+          work_queue.enqueue(thd_id,Message::create_message(t_node->txn_man,RQRY_CONT),false);
+      }
+      break;
+    }
+    t_node = t_node->next;
+  }
+
+  // unset modify bit for this pool: txn_id % pool_size
+  ATOM_CAS(pool[pool_id]->modify,true,false);
+}
+#endif
+
 void TxnTable::release_transaction_manager(uint64_t thd_id, uint64_t txn_id, uint64_t batch_id){
   uint64_t starttime = get_sys_clock();
 
@@ -59,6 +59,8 @@ public:
   TxnManager* get_transaction_manager(uint64_t thd_id, uint64_t txn_id,uint64_t batch_id);
   void dump();
   void restart_txn(uint64_t thd_id, uint64_t txn_id,uint64_t batch_id);
+  // CLV_CC, see TxnManager::clv_commit_ready
+  void clv_resolve(uint64_t thd_id, uint64_t txn_id, uint64_t epoch, bool aborted);
   void release_transaction_manager(uint64_t thd_id, uint64_t txn_id, uint64_t batch_id);
   void update_min_ts(uint64_t thd_id, uint64_t txn_id,uint64_t batch_id,uint64_t ts);
   uint64_t get_min_ts(uint64_t thd_id);
@@ -24,8 +24,12 @@
 #include "mem_alloc.h"
 #include "row.h"
 #include "table.h"
+#include "checkpoint.h"
 
-RC Workload::init() { return RCOK; }
+RC Workload::init() {
+	load_entry_cnt = 0;
+	return RCOK;
+}
 
 RC Workload::init_schema(const char * schema_file) {
     assert(sizeof(uint64_t) == 8);
@@ -149,8 +153,58 @@ RC Workload::init_schema(const char * schema_file) {
 		}
     }
 	fin.close();
+#if CHECKPOINT || CKPT_LOAD || SNAPSHOT
+	// checkpoints copy what the indexes reach, and the rows unindexed tables keep
+	for (auto t = tables.begin(); t != tables.end(); t++) {
+		bool indexed = false;
+		for (auto it = indexes.begin(); it != indexes.end(); it++)
+			indexed = indexed || it->second->table == t->second;
+		if (!indexed) t->second->keep_rows();
+	}
+#endif
 	return RCOK;
 }
+// By default a table's index is keyed by the row's primary key (YCSB, PPS).
+row_t * Workload::get_recovery_row(table_t * table, uint64_t key, uint64_t part_id,
+                                   const char * image) {
+  for (auto it = indexes.begin(); it != indexes.end(); it++) {
+    if (it->second->table != table) continue;
+    itemid_t * item = NULL;
+    RC rc = it->second->index_read(key, item, part_id, 0);
+    if (rc != RCOK || item == NULL) return NULL;
+    return (row_t *)item->location;
+  }
+  return NULL;
+}
+
+RC Workload::recovery_insert(table_t * table, uint64_t key, uint64_t part_id,
+                             const char * image) {
+  // the fuzzy checkpoint replayed over may already hold the row
+  row_t * row = get_recovery_row(table, key, part_id, image);
+  if (row != NULL) {
+    memcpy(row->get_data(), image, row->get_tuple_size());
+    return RCOK;
+  }
+  uint64_t row_id;
+  table->get_new_row(row, part_id, row_id);
+  memcpy(row->get_data(), image, row->get_tuple_size());
+  row->set_primary_key(key);
+  for (auto it = indexes.begin(); it != indexes.end(); it++) {
+    if (it->second->table == table) index_insert(it->second, key, row, part_id);
+  }
+  return RCOK;
+}
+
+RC Workload::recovery_delete(table_t * table, uint64_t key, uint64_t part_id,
+                             const char * image) {
+  row_t * row = get_recovery_row(table, key, part_id, image);
+  if (row == NULL) return ERROR;
+  for (auto it = indexes.begin(); it != indexes.end(); it++) {
+    if (it->second->table == table) it->second->index_remove(key, row, part_id);
+  }
+  return RCOK;
+}
+
 //add by ym origin function mark
 void Workload::index_delete_all() {
   #if WORKLOAD ==DA
@@ -184,6 +238,86 @@ void Workload::index_insert(INDEX * index, uint64_t key, row_t * row, int64_t pa
   assert( index->index_insert(key, m_item, pid) == RCOK );
 }
 
+// entries buffered by one loader thread for one index; items holds their itemids
+struct LoadBatch {
+	itemid_t * items;
+	std::vector<index_load_t> entries;
+};
+static thread_local std::map<INDEX *, LoadBatch> load_batches;
+
+void Workload::index_load(INDEX * index, uint64_t key, row_t * row, int64_t part_id,
+													bool nonunique) {
+	LoadBatch &batch = load_batches[index];
+	if (batch.entries.empty()) {
+		batch.items = (itemid_t *)mem_allocator.alloc(sizeof(itemid_t) * g_load_index_batch);
+		batch.entries.reserve(g_load_index_batch);
+	}
+	itemid_t * m_item = &batch.items[batch.entries.size()];
+	m_item->init();
+	m_item->type = DT_row;
+	m_item->location = row;
+	m_item->valid = true;
+	index_load_t entry;
+	entry.key = key;
+	entry.item = m_item;
+	entry.part_id = part_id == -1 ? get_part_id(row) : part_id;
+	entry.nonunique = nonunique;
+	batch.entries.push_back(entry);
+	if (batch.entries.size() == g_load_index_batch) {
+		index->index_insert_bulk(batch.entries.data(), batch.entries.size());
+		ATOM_ADD(load_entry_cnt, batch.entries.size());
+		batch.entries.clear();
+	}
+}
+
+void Workload::flush_index_load() {
+	for (auto it = load_batches.begin(); it != load_batches.end(); it++) {
+		if (it->second.entries.empty()) continue;
+		it->first->index_insert_bulk(it->second.entries.data(), it->second.entries.size());
+		ATOM_ADD(load_entry_cnt, it->second.entries.size());
+		it->second.entries.clear();
+	}
+}
+
+uint64_t Workload::get_load_thread_cnt() {
+	if (g_load_thread_cnt > 0) return g_load_thread_cnt;
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? cores : 1;
+}
+
+void Workload::print_load_stats(uint64_t starttime) {
+	double load_time = (double)(get_server_clock() - starttime) / BILLION;
+	printf("Load: threads=%ld, index_entries=%ld, load_time=%f, throughput=%f entries/s\n",
+				 get_load_thread_cnt(), load_entry_cnt, load_time,
+				 load_time > 0 ? load_entry_cnt / load_time : 0);
+	fflush(stdout);
+}
+
+// the parameters shaping the generated data of every workload; the workloads
+// append their own
+string Workload::snapshot_key() {
+	return "w" + to_string(WORKLOAD) + "_n" + to_string(g_node_id) + "of" +
+				 to_string(g_node_cnt) + "_p" + to_string(g_part_cnt) + "_i" + to_string(INDEX_STRUCT);
+}
+
+RC Workload::load_snapshot() {
+#if SNAPSHOT
+	Checkpointer snapshot;
+	snapshot.init_snapshot(this, string(SNAPSHOT_DIR) + "/snap_" + snapshot_key());
+	return snapshot.load(this);
+#else
+	return ERROR;
+#endif
+}
+
+void Workload::dump_snapshot() {
+#if SNAPSHOT
+	Checkpointer snapshot;
+	snapshot.init_snapshot(this, string(SNAPSHOT_DIR) + "/snap_" + snapshot_key());
+	if (snapshot.dump_snapshot() != RCOK) printf("failed to write snapshot, ");
+#endif
+}
+
 void Workload::index_insert_nonunique(INDEX * index, uint64_t key, row_t * row, int64_t part_id) {
 	uint64_t pid = part_id;
   if (part_id == -1) pid = get_part_id(row);
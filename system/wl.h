@@ -47,6 +47,16 @@ public:
 	virtual RC init_schema(const char * schema_file);
 	virtual RC init_table()=0;
 	virtual RC get_txn_man(TxnManager *& txn_manager)=0;
+	// recovery: find the row a log record refers to from its primary key and
+	// redo image. Returns NULL if the row does not exist.
+	virtual row_t * get_recovery_row(table_t * table, uint64_t key, uint64_t part_id,
+																	 const char * image);
+	// recovery of an insert: a new row from the redo image, added to the indexes
+	virtual RC recovery_insert(table_t * table, uint64_t key, uint64_t part_id,
+														 const char * image);
+	// recovery of a delete: the row found from the undo image leaves the indexes
+	virtual RC recovery_delete(table_t * table, uint64_t key, uint64_t part_id,
+														 const char * image);
 	// get the global timestamp.
 //	uint64_t get_ts(uint64_t thread_id);
 	//uint64_t cur_txn_id;
@@ -56,6 +66,20 @@ public:
 	void index_insert(string index_name, uint64_t key, row_t * row);
 	void index_insert(INDEX * index, uint64_t key, row_t * row, int64_t part_id = -1);
 	void index_insert_nonunique(INDEX * index, uint64_t key, row_t * row, int64_t part_id = -1);
+	// Bulk index build for the loaders: entries are buffered per index by the calling
+	// thread and inserted g_load_index_batch at a time. A loader thread calls
+	// flush_index_load before it exits.
+	void index_load(INDEX * index, uint64_t key, row_t * row, int64_t part_id = -1,
+									bool nonunique = false);
+	void flush_index_load();
+	uint64_t get_load_thread_cnt();
+	void print_load_stats(uint64_t starttime);
+	uint64_t volatile load_entry_cnt;
+	// SNAPSHOT: map the tables from SNAPSHOT_DIR/snap_<snapshot_key> written by an
+	// earlier run instead of generating them; dump_snapshot writes it after init_table.
+	RC load_snapshot();
+	void dump_snapshot();
+	virtual string snapshot_key();
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include "query.h"
 #include "message.h"
 #include "client_query.h"
+#include "admission.h"
 #include <boost/lockfree/queue.hpp>
 
 void QWorkQueue::init() {
@@ -38,6 +39,10 @@ void QWorkQueue::init() {
 	for ( uint64_t i = 0; i < g_node_cnt; i++) {
 		sched_queue[i] = new boost::lockfree::queue<work_queue_entry* > (0);
 	}
+	lock_shard_queue = new boost::lockfree::queue<TxnManager* > * [g_calvin_lock_thread_cnt];
+	for ( uint64_t i = 0; i < g_calvin_lock_thread_cnt; i++) {
+		lock_shard_queue[i] = new boost::lockfree::queue<TxnManager* > (0);
+	}
 #endif
 	txn_queue_size = 0;
 	work_queue_size = 0;
@@ -168,6 +173,20 @@ Message * QWorkQueue::sched_dequeue(uint64_t thd_id) {
 	return msg;
 }
 
+void QWorkQueue::lock_shard_enqueue(uint64_t thd_id, uint64_t shard_id, TxnManager * txn_man) {
+	assert(CC_ALG == CALVIN);
+	assert(shard_id < g_calvin_lock_thread_cnt);
+	while (!lock_shard_queue[shard_id]->push(txn_man) && !simulation->is_done()) {
+	}
+}
+
+TxnManager * QWorkQueue::lock_shard_dequeue(uint64_t thd_id, uint64_t shard_id) {
+	assert(CC_ALG == CALVIN);
+	TxnManager * txn_man = NULL;
+	if (!lock_shard_queue[shard_id]->pop(txn_man)) return NULL;
+	return txn_man;
+}
+
 
 #ifdef NEW_WORK_QUEUE
 void QWorkQueue::enqueue(uint64_t thd_id, Message * msg,bool busy) {
@@ -426,6 +445,18 @@ void QWorkQueue::enqueue(uint64_t thd_id, Message * msg,bool busy) {
 	INC_STATS(thd_id,trans_work_queue_item_total,txn_queue_size+work_queue_size);
 }
 
+// New txns only leave the queue once admission control lets them start.
+bool QWorkQueue::pop_new_txn(uint64_t thd_id, work_queue_entry *& entry) {
+#if ADMISSION_CC
+	if (new_txn_queue->empty() || !admission.admit(thd_id)) return false;
+	if (new_txn_queue->pop(entry)) return true;
+	admission.release();
+	return false;
+#else
+	return new_txn_queue->pop(entry);
+#endif
+}
+
 void QWorkQueue::statqueue(uint64_t thd_id, work_queue_entry * entry) {
 	Message *msg = entry->msg;
 	if (msg->rtype == RTXN_CONT ||
@@ -448,6 +479,9 @@ void QWorkQueue::statqueue(uint64_t thd_id, work_queue_entry * entry) {
 Message * QWorkQueue::dequeue(uint64_t thd_id) {
 	uint64_t starttime = get_sys_clock();
 	assert(ISSERVER || ISREPLICA);
+#if ADMISSION_CC
+	admission.tick(thd_id, starttime);
+#endif
 	Message * msg = NULL;
 	work_queue_entry * entry = NULL;
 	uint64_t mtx_wait_starttime = get_sys_clock();
@@ -457,13 +491,13 @@ Message * QWorkQueue::dequeue(uint64_t thd_id) {
 	if (thd_id < THREAD_CNT / 2)
 		valid = work_queue->pop(entry);
 	else
-		valid = new_txn_queue->pop(entry);
+		valid = pop_new_txn(thd_id, entry);
 #else
 	double x = (double)(rand() % 10000) / 10000;
 	if (x > TXN_QUEUE_PERCENT)
 		valid = work_queue->pop(entry);
 	else
-		valid = new_txn_queue->pop(entry);
+		valid = pop_new_txn(thd_id, entry);
 	if(!valid) {
 #if SERVER_GENERATE_QUERIES
 		if(ISSERVER) {
@@ -475,7 +509,7 @@ Message * QWorkQueue::dequeue(uint64_t thd_id) {
 		}
 #else
 		if (x > TXN_QUEUE_PERCENT)
-			valid = new_txn_queue->pop(entry);
+			valid = pop_new_txn(thd_id, entry);
 		else
 			valid = work_queue->pop(entry);
 		// if ((thd_id % THREAD_CNT) % 2 == 0)
@@ -507,6 +541,9 @@ Message * QWorkQueue::dequeue(uint64_t thd_id) {
 			txn_queue_size --;
 			txn_dequeue_size ++;
 			sem_post(&_semaphore);
+#if ADMISSION_CC
+			admission.record_delay(thd_id, queue_time);
+#endif
 			INC_STATS(thd_id,work_queue_old_wait_time,queue_time);
 			INC_STATS(thd_id,work_queue_old_cnt,1);
 		}
@@ -548,7 +585,7 @@ Message * QWorkQueue::queuetop(uint64_t thd_id)
 			}
 		}
 #else
-		valid = new_txn_queue->pop(entry);
+		valid = pop_new_txn(thd_id, entry);
 #endif
 	}
 	INC_STATS(thd_id,mtx[14],get_sys_clock() - mtx_wait_starttime);
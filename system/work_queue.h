@@ -28,6 +28,7 @@
 class BaseQuery;
 class Workload;
 class Message;
+class TxnManager;
 
 struct work_queue_entry {
   Message * msg;
@@ -72,6 +73,8 @@ public:
   Message * queuetop(uint64_t thd_id);
   void sched_enqueue(uint64_t thd_id, Message * msg);
   Message * sched_dequeue(uint64_t thd_id);
+  void lock_shard_enqueue(uint64_t thd_id, uint64_t shard_id, TxnManager * txn_man);
+  TxnManager * lock_shard_dequeue(uint64_t thd_id, uint64_t shard_id);
   void sequencer_enqueue(uint64_t thd_id, Message * msg);
   Message * sequencer_dequeue(uint64_t thd_id);
 
@@ -106,9 +109,12 @@ private:
 #else
   boost::lockfree::queue<work_queue_entry* > * work_queue;
   boost::lockfree::queue<work_queue_entry* > * new_txn_queue;
+  bool pop_new_txn(uint64_t thd_id, work_queue_entry *& entry);
 #endif
   boost::lockfree::queue<work_queue_entry* > * seq_queue;
   boost::lockfree::queue<work_queue_entry* > ** sched_queue;
+  // scheduled txns per Calvin lock shard, in schedule order
+  boost::lockfree::queue<TxnManager* > ** lock_shard_queue;
 
   uint64_t sched_ptr;
   BaseQuery * last_sched_dq;
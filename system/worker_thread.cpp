@@ -17,6 +17,8 @@
 #include "worker_thread.h"
 
 #include "abort_queue.h"
+#include "admission.h"
+#include "checkpoint.h"
 #include "dta.h"
 #include "global.h"
 #include "helper.h"
@@ -48,6 +50,9 @@ void WorkerThread::setup() {
 	if( get_thd_id() == 0) {
     send_init_done_to_all_nodes();
   }
+#if LOGGING
+  logger.bindBuffer(get_thd_id());
+#endif
   _thd_txn_id = 0;
 }
 
@@ -282,6 +287,12 @@ void WorkerThread::check_if_done(RC rc) {
 }
 
 void WorkerThread::release_txn_man() {
+#if ADMISSION_CC
+  if (txn_man->admitted) {
+    txn_man->admitted = false;
+    admission.release();
+  }
+#endif
   txn_table.release_transaction_manager(get_thd_id(), txn_man->get_txn_id(),
                                         txn_man->get_batch_id());
   txn_man = NULL;
@@ -305,6 +316,9 @@ void WorkerThread::calvin_wrapup() {
 void WorkerThread::commit() {
   assert(txn_man);
   assert(IS_LOCAL(txn_man->get_txn_id()));
+  // once per txn, and not before its commit records are durable
+  assert(!txn_man->finished && !txn_man->log_pending());
+  txn_man->finished = true;
 
   uint64_t timespan = get_sys_clock() - txn_man->txn_stats.starttime;
   DEBUG("COMMIT %ld %f -- %f\n", txn_man->get_txn_id(),
@@ -331,6 +345,12 @@ void WorkerThread::commit() {
   INC_STATS(get_thd_id(), trans_finish_count, 1);
   INC_STATS(get_thd_id(), trans_commit_count, 1);
   INC_STATS(get_thd_id(), trans_total_count, 1);
+#if CHECKPOINT
+  checkpointer.record_latency(get_thd_id(), timespan);
+#endif
+#if ADMISSION_CC
+  admission.record_commit(get_thd_id());
+#endif
 
   // Send result back to client
 #if !SERVER_GENERATE_QUERIES
@@ -380,6 +400,9 @@ void WorkerThread::abort() {
   INC_STATS(get_thd_id(), trans_finish_count, 1);
   INC_STATS(get_thd_id(), trans_abort_count, 1);
   INC_STATS(get_thd_id(), trans_total_count, 1);
+#if ADMISSION_CC
+  admission.record_abort(get_thd_id());
+#endif
   #if WORKLOAD != DA //actually DA do not need real abort. Just count it and do not send real abort msg.
   uint64_t penalty =
       abort_queue.enqueue(get_thd_id(), txn_man->get_txn_id(), txn_man->get_abort_cnt());
@@ -579,11 +602,13 @@ RC WorkerThread::process_rfin(Message * msg) {
                       GET_TXN_NODE_ID(msg->get_txn_id()));
     return Abort;
   }
-  txn_man->commit();
   //if(!txn_man->query->readonly() || CC_ALG == OCC)
-  if (!((FinishMessage*)msg)->readonly || CC_ALG == MAAT || CC_ALG == OCC || CC_ALG == TICTOC ||
-       CC_ALG == BOCC || CC_ALG == SSI || CC_ALG == DLI_BASE ||
-       CC_ALG == DLI_OCC || CC_ALG == SILO)
+  bool ack = !((FinishMessage*)msg)->readonly || CC_ALG == MAAT || CC_ALG == OCC ||
+             CC_ALG == TICTOC || CC_ALG == BOCC || CC_ALG == SSI || CC_ALG == DLI_BASE ||
+             CC_ALG == DLI_OCC || CC_ALG == SILO;
+  // with LOGGING the RACK_FIN is sent by process_log_flushed
+  if (txn_man->commit(ack) == WAIT) return RCOK;
+  if (ack)
     msg_queue.enqueue(get_thd_id(), Message::create_message(txn_man, RACK_FIN),
                       GET_TXN_NODE_ID(msg->get_txn_id()));
   release_txn_man();
@@ -713,11 +738,12 @@ RC WorkerThread::process_rack_rfin(Message * msg) {
     //uint64_t warmuptime1 = get_sys_clock() - g_starttime;
     //INC_STATS(get_thd_id(), throughput[warmuptime1/BILLION], 1);
     //std::cout<<"Throughout "<<warmuptime1/BILLION<<' '<<"is "<<stats._stats[get_thd_id()]->throughput[warmuptime1/BILLION]<<' ';
-    commit();
 
     //update throughput data (distributed transaction)
     uint64_t warmuptime1 = get_sys_clock() - g_start_time;
     INC_STATS(get_thd_id(), throughput[warmuptime1/BILLION], 1);     			
+    // with LOGGING the local commit records may not be durable yet: process_log_flushed ends it
+    if (!txn_man->log_pending()) commit();
 
   } else {
     INC_STATS(get_thd_id(), trans_abort_network, get_sys_clock() - txn_man->txn_stats.trans_abort_network_start_time);
@@ -737,6 +763,10 @@ RC WorkerThread::process_rqry_rsp(Message * msg) {
     txn_man->start_abort();
     return Abort;
   }
+#if TWOPC_OPT_CC
+  if(!((QueryResponseMessage*)msg)->readonly)
+    txn_man->query->partitions_modified.add_unique(GET_PART_ID(0,msg->return_node_id));
+#endif
 #if CC_ALG == TICTOC
   // Integrate bounds
   TxnManager * txn_man = txn_table.get_transaction_manager(get_thd_id(),msg->get_txn_id(),0);
@@ -827,6 +857,10 @@ RC WorkerThread::process_rqry_cont(Message * msg) {
   DEBUG("RQRY_CONT %ld\n",msg->get_txn_id());
   assert(!IS_LOCAL(msg->get_txn_id()));
   RC rc = RCOK;
+#if CLV_CC
+  // the vote waited for the txns this one depends on
+  if(txn_man->clv_commit_wait) return process_rprepare(msg);
+#endif
 
   txn_man->run_txn_post_wait();
   txn_man->send_RQRY_RSP = false;
@@ -846,6 +880,13 @@ RC WorkerThread::process_rtxn_cont(Message * msg) {
 
   txn_man->txn_stats.local_wait_time += get_sys_clock() - txn_man->txn_stats.wait_starttime;
 
+#if CLV_CC
+  // the commit waited for the txns this one depends on
+  if(txn_man->clv_commit_wait) {
+    check_if_done(txn_man->start_commit());
+    return RCOK;
+  }
+#endif
   txn_man->run_txn_post_wait();
   txn_man->send_RQRY_RSP = false;
   RC rc = txn_man->run_txn();
@@ -867,8 +908,17 @@ RC WorkerThread::process_rprepare(Message * msg) {
 #endif
     // Validate transaction
     rc  = txn_man->validate();
+#if CLV_CC
+    if(rc == RCOK) {
+      // votes from process_rqry_cont once the txns it depends on finished
+      rc = txn_man->clv_commit_ready();
+      if(rc == WAIT) return WAIT;
+    }
+    if(rc == RCOK) txn_man->clv_retire_locks();
+#endif
     txn_man->set_rc(rc);
-    msg_queue.enqueue(get_thd_id(),Message::create_message(txn_man,RACK_PREP),msg->return_node_id);
+    msg_queue.enqueue(get_thd_id(),Message::create_message(txn_man,RACK_PREP),
+                      GET_TXN_NODE_ID(msg->get_txn_id()));
     // Clean up as soon as abort is possible
     if(rc == Abort) {
       txn_man->abort();
@@ -906,7 +956,12 @@ RC WorkerThread::process_rtxn(Message * msg) {
     INC_STATS(get_thd_id(),worker_activate_txn_time,get_sys_clock() - ready_starttime);
     if (!ready) std::cout<<"Try again! Restart the process!"<<endl;
     assert(ready);
-    if (CC_ALG == WAIT_DIE) {
+#if ADMISSION_CC
+    // came out of new_txn_queue through pop_new_txn
+    txn_man->admitted = true;
+#endif
+    // a run that may be NO_WAIT stamps its txns too: the query messages of the build carry it
+    if (WAIT_DIE_CC) {
       #if WORKLOAD == DA //mvcc use timestamp
         if (da_stamp_tab.count(txn_man->get_txn_id())==0)
         {
@@ -1059,24 +1114,43 @@ RC WorkerThread::process_log_msg(Message * msg) {
 
 RC WorkerThread::process_log_msg_rsp(Message * msg) {
   DEBUG("REPLICA RSP %ld\n",msg->get_txn_id());
+  assert(!txn_man->repl_finished);
   txn_man->repl_finished = true;
-  if (txn_man->log_flushed) commit();
+  log_durable();
   return RCOK;
 }
 
 RC WorkerThread::process_log_flushed(Message * msg) {
   DEBUG("LOG FLUSHED %ld\n",msg->get_txn_id());
   if(ISREPLICA) {
+    // the txn may be a participant's, so answer the primary rather than its coordinator
     msg_queue.enqueue(get_thd_id(), Message::create_message(msg->txn_id, LOG_MSG_RSP),
-                      GET_TXN_NODE_ID(msg->txn_id));
+                      g_node_id - g_node_cnt - g_client_node_cnt);
     return RCOK;
   }
 
+  // only txns that still wait for it asked for this message
+  assert(!txn_man->log_flushed);
   txn_man->log_flushed = true;
-  if (g_repl_cnt == 0 || txn_man->repl_finished) commit();
+  log_durable();
   return RCOK;
 }
 
+// Send what waited for the commit records of txn_man to become durable: a participant's
+// RACK_FIN, or the coordinator's CL_RSP once its participants acknowledged as well.
+void WorkerThread::log_durable() {
+  if (txn_man->log_pending()) return;
+  if (!IS_LOCAL(txn_man->get_txn_id())) {
+    msg_queue.enqueue(get_thd_id(), Message::create_message(txn_man, RACK_FIN),
+                      GET_TXN_NODE_ID(txn_man->get_txn_id()));
+    release_txn_man();
+    return;
+  }
+  // process_rack_rfin ends the txn when the last RACK_FIN comes in
+  if (txn_man->waiting_for_response()) return;
+  commit();
+}
+
 RC WorkerThread::process_rfwd(Message * msg) {
   DEBUG("RFWD (%ld,%ld)\n",msg->get_txn_id(),msg->get_batch_id());
   txn_man->txn_stats.remote_wait_time += get_sys_clock() - txn_man->txn_stats.wait_starttime;
@@ -1155,7 +1229,8 @@ RC WorkerThread::process_ack_sync_migration(Message* msg){
   rc = txn_man->commit();
   uint64_t warmuptime1 = get_sys_clock() - g_starttime;
   INC_STATS(get_thd_id(), throughput[warmuptime1/BILLION], 1);
-  commit(); 
+  // with LOGGING process_log_flushed ends the txn
+  if (rc != WAIT) commit(); 
   //std::cout<<"ACK sync";
   return rc;
 }
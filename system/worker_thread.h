@@ -35,6 +35,7 @@ public:
     void check_if_done(RC rc);
     void release_txn_man();
     void commit();
+    void log_durable();
     void abort();
     TxnManager * get_transaction_manager(Message * msg);
     void calvin_wrapup();
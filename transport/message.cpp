@@ -256,6 +256,7 @@ Message * Message::create_message(RemReqType rtype) {
   msg->lat_process_time = 0;
   msg->lat_network_time = 0;
   msg->lat_other_time = 0;
+  msg->piggyback = false;
 
 
   return msg;
@@ -616,7 +617,7 @@ void Message::release_message(Message * msg) {
 
 uint64_t QueryMessage::get_size() {
   uint64_t size = Message::mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
   size += sizeof(ts);
 #endif
 #if CC_ALG == OCC || CC_ALG == FOCC || CC_ALG == BOCC || CC_ALG == SSI || CC_ALG == WSI || \
@@ -629,7 +630,7 @@ uint64_t QueryMessage::get_size() {
 
 void QueryMessage::copy_from_txn(TxnManager * txn) {
   Message::mcopy_from_txn(txn);
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
   ts = txn->get_timestamp();
   assert(ts != 0);
 #endif
@@ -642,7 +643,7 @@ void QueryMessage::copy_from_txn(TxnManager * txn) {
 
 void QueryMessage::copy_to_txn(TxnManager * txn) {
   Message::mcopy_to_txn(txn);
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
   assert(ts != 0);
   txn->set_timestamp(ts);
 #endif
@@ -657,7 +658,7 @@ void QueryMessage::copy_from_buf(char * buf) {
   Message::mcopy_from_buf(buf);
   uint64_t ptr __attribute__ ((unused));
   ptr = Message::mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
  COPY_VAL(ts,buf,ptr);
   assert(ts != 0);
 #endif
@@ -672,7 +673,7 @@ void QueryMessage::copy_to_buf(char * buf) {
   Message::mcopy_to_buf(buf);
   uint64_t ptr __attribute__ ((unused));
   ptr = Message::mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
  COPY_BUF(buf,ts,ptr);
   assert(ts != 0);
 #endif
@@ -793,7 +794,7 @@ void TPCCClientQueryMessage::release() {
 
 uint64_t TPCCClientQueryMessage::get_size() {
   uint64_t size = ClientQueryMessage::get_size();
-  size += sizeof(uint64_t) * 10;
+  size += sizeof(uint64_t) * 13;
   size += sizeof(char) * LASTNAME_LEN;
   size += sizeof(bool) * 3;
   size += sizeof(size_t);
@@ -825,6 +826,12 @@ void TPCCClientQueryMessage::copy_from_query(BaseQuery * query) {
   remote = tpcc_query->remote;
   ol_cnt = tpcc_query->ol_cnt;
   o_entry_d = tpcc_query->o_entry_d;
+
+  // delivery
+  o_carrier_id = tpcc_query->o_carrier_id;
+  ol_delivery_d = tpcc_query->ol_delivery_d;
+  // stock level
+  threshold = tpcc_query->threshold;
 }
 
 
@@ -845,6 +852,12 @@ void TPCCClientQueryMessage::copy_to_txn(TxnManager * txn) {
     ((TPCCTxnManager*)txn)->state = TPCC_PAYMENT0;
   else if (tpcc_query->txn_type == TPCC_NEW_ORDER)
     ((TPCCTxnManager*)txn)->state = TPCC_NEWORDER0;
+  else if (tpcc_query->txn_type == TPCC_ORDER_STATUS)
+    ((TPCCTxnManager*)txn)->state = TPCC_ORDERSTATUS0;
+  else if (tpcc_query->txn_type == TPCC_DELIVERY)
+    ((TPCCTxnManager*)txn)->state = TPCC_DELIVERY0;
+  else if (tpcc_query->txn_type == TPCC_STOCK_LEVEL)
+    ((TPCCTxnManager*)txn)->state = TPCC_STOCKLEVEL0;
 	// common txn input for both payment & new-order
   tpcc_query->w_id = w_id;
   tpcc_query->d_id = d_id;
@@ -865,6 +878,11 @@ void TPCCClientQueryMessage::copy_to_txn(TxnManager * txn) {
   tpcc_query->ol_cnt = ol_cnt;
   tpcc_query->o_entry_d = o_entry_d;
 
+  // delivery
+  tpcc_query->o_carrier_id = o_carrier_id;
+  tpcc_query->ol_delivery_d = ol_delivery_d;
+  // stock level
+  tpcc_query->threshold = threshold;
 }
 
 void TPCCClientQueryMessage::copy_from_buf(char * buf) {
@@ -901,6 +919,10 @@ void TPCCClientQueryMessage::copy_from_buf(char * buf) {
   COPY_VAL(ol_cnt,buf,ptr);
   COPY_VAL(o_entry_d,buf,ptr);
 
+  COPY_VAL(o_carrier_id,buf,ptr);
+  COPY_VAL(ol_delivery_d,buf,ptr);
+  COPY_VAL(threshold,buf,ptr);
+
  assert(ptr == get_size());
 }
 
@@ -933,6 +955,10 @@ void TPCCClientQueryMessage::copy_to_buf(char * buf) {
   COPY_BUF(buf,remote,ptr);
   COPY_BUF(buf,ol_cnt,ptr);
   COPY_BUF(buf,o_entry_d,ptr);
+
+  COPY_BUF(buf,o_carrier_id,ptr);
+  COPY_BUF(buf,ol_delivery_d,ptr);
+  COPY_BUF(buf,threshold,ptr);
  assert(ptr == get_size());
 }
 
@@ -1166,6 +1192,7 @@ void ClientQueryMessage::release() {
 uint64_t ClientQueryMessage::get_size() {
   uint64_t size = Message::mget_size();
   size += sizeof(client_startts);
+  size += sizeof(client_qid);
   /*
   uint64_t size = sizeof(ClientQueryMessage);
   */
@@ -1177,6 +1204,7 @@ uint64_t ClientQueryMessage::get_size() {
 void ClientQueryMessage::copy_from_query(BaseQuery * query) {
   partitions.clear();
   partitions.copy(query->partitions);
+  client_qid = query->client_qid;
 }
 
 void ClientQueryMessage::copy_from_txn(TxnManager * txn) {
@@ -1185,6 +1213,7 @@ void ClientQueryMessage::copy_from_txn(TxnManager * txn) {
   partitions.clear();
   partitions.copy(txn->query->partitions);
   client_startts = txn->client_startts;
+  client_qid = txn->client_qid;
 }
 
 void ClientQueryMessage::copy_to_txn(TxnManager * txn) {
@@ -1193,6 +1222,7 @@ void ClientQueryMessage::copy_to_txn(TxnManager * txn) {
   txn->query->partitions.clear();
   txn->query->partitions.append(partitions);
   txn->client_startts = client_startts;
+  txn->client_qid = client_qid;
   txn->client_id = return_node_id;
 }
 
@@ -1201,6 +1231,7 @@ void ClientQueryMessage::copy_from_buf(char * buf) {
   uint64_t ptr = Message::mget_size();
   //COPY_VAL(ts,buf,ptr);
   COPY_VAL(client_startts,buf,ptr);
+  COPY_VAL(client_qid,buf,ptr);
   size_t size;
   COPY_VAL(size,buf,ptr);
   partitions.init(size);
@@ -1217,6 +1248,7 @@ void ClientQueryMessage::copy_to_buf(char * buf) {
   uint64_t ptr = Message::mget_size();
   //COPY_BUF(buf,ts,ptr);
   COPY_BUF(buf,client_startts,ptr);
+  COPY_BUF(buf,client_qid,ptr);
   size_t size = partitions.size();
   COPY_BUF(buf,size,ptr);
   for(uint64_t i = 0; i < size; i++) {
@@ -1231,23 +1263,27 @@ void ClientQueryMessage::copy_to_buf(char * buf) {
 uint64_t ClientResponseMessage::get_size() {
   uint64_t size = Message::mget_size();
   size += sizeof(uint64_t);
+  size += sizeof(uint64_t);
   return size;
 }
 
 void ClientResponseMessage::copy_from_txn(TxnManager * txn) {
   Message::mcopy_from_txn(txn);
   client_startts = txn->client_startts;
+  client_qid = txn->client_qid;
 }
 
 void ClientResponseMessage::copy_to_txn(TxnManager * txn) {
   Message::mcopy_to_txn(txn);
   txn->client_startts = client_startts;
+  txn->client_qid = client_qid;
 }
 
 void ClientResponseMessage::copy_from_buf(char * buf) {
   Message::mcopy_from_buf(buf);
   uint64_t ptr = Message::mget_size();
   COPY_VAL(client_startts,buf,ptr);
+  COPY_VAL(client_qid,buf,ptr);
  assert(ptr == get_size());
 }
 
@@ -1255,6 +1291,7 @@ void ClientResponseMessage::copy_to_buf(char * buf) {
   Message::mcopy_to_buf(buf);
   uint64_t ptr = Message::mget_size();
   COPY_BUF(buf,client_startts,ptr);
+  COPY_BUF(buf,client_qid,ptr);
  assert(ptr == get_size());
 }
 
@@ -1475,6 +1512,9 @@ uint64_t QueryResponseMessage::get_size() {
   size += sizeof(RC);
 #if CC_ALG == TICTOC
   size += sizeof(uint64_t);
+#endif
+#if TWOPC_OPT_CC
+  size += sizeof(bool);
 #endif
   //size += sizeof(uint64_t);
   return size;
@@ -1486,6 +1526,13 @@ void QueryResponseMessage::copy_from_txn(TxnManager * txn) {
 #if CC_ALG == TICTOC
   _min_commit_ts = txn->_min_commit_ts;
 #endif
+#if TWOPC_OPT_CC
+  readonly = txn->get_write_set_size() == 0;
+#if CLV_CC
+  // a reader that took a retired lock has to go through the prepare round
+  readonly = readonly && txn->clv_dep_cnt == 0 && !txn->clv_dep_abort;
+#endif
+#endif
 }
 
 void QueryResponseMessage::copy_to_txn(TxnManager * txn) {
@@ -1500,6 +1547,9 @@ void QueryResponseMessage::copy_from_buf(char * buf) {
 #if CC_ALG == TICTOC
   COPY_VAL(_min_commit_ts,buf,ptr);
 #endif
+#if TWOPC_OPT_CC
+  COPY_VAL(readonly,buf,ptr);
+#endif
 
  assert(ptr == get_size());
 }
@@ -1510,6 +1560,9 @@ void QueryResponseMessage::copy_to_buf(char * buf) {
   COPY_BUF(buf,rc,ptr);
 #if CC_ALG == TICTOC
   COPY_BUF(buf,_min_commit_ts,ptr);
+#endif
+#if TWOPC_OPT_CC
+  COPY_BUF(buf,readonly,ptr);
 #endif
  assert(ptr == get_size());
 }
@@ -1590,6 +1643,7 @@ uint64_t LogMessage::get_size() {
   uint64_t size = Message::mget_size();
   //size += sizeof(size_t);
   //size += sizeof(LogRecord) * log_records.size();
+  size += sizeof(record);
   return size;
 }
 
@@ -75,6 +75,8 @@ public:
   double lat_process_time;
   double lat_network_time;
   double lat_other_time;
+  // may wait up to g_msg_fin_piggyback for the next batch to its node; not sent
+  bool piggyback;
 
   uint64_t mget_size();
   uint64_t get_txn_id() {return txn_id;}
@@ -184,6 +186,9 @@ public:
 #if CC_ALG == TICTOC
   uint64_t _min_commit_ts;
 #endif
+#if TWOPC_OPT_CC
+  bool readonly; // the participant has not written so far
+#endif
 };
 
 class AckMessage : public Message {
@@ -268,6 +273,7 @@ public:
 
   RC rc;
   uint64_t client_startts;
+  uint64_t client_qid;
 };
 
 class ClientQueryMessage : public Message {
@@ -288,6 +294,7 @@ public:
   uint64_t txn_id;
 #endif
   uint64_t client_startts;
+  uint64_t client_qid;
   uint64_t first_startts;
   Array<uint64_t> partitions;
 };
@@ -339,6 +346,11 @@ public:
   uint64_t ol_cnt;
   uint64_t o_entry_d;
 
+  // delivery
+  uint64_t o_carrier_id;
+  uint64_t ol_delivery_d;
+  // stock level
+  uint64_t threshold;
 };
 
 class PPSClientQueryMessage : public ClientQueryMessage {
@@ -398,7 +410,7 @@ public:
   void release() {}
 
   uint64_t pid;
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == DTA || CC_ALG == WOOKONG
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == DTA || CC_ALG == WOOKONG
   uint64_t ts;
 #endif
 #if CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA || CC_ALG == DLI_DTA || CC_ALG == DLI_DTA2 || CC_ALG == DLI_DTA3
@@ -117,7 +117,7 @@ static uint64_t mget_size() {
 
 uint64_t cget_size(QueryMessage * msg) {
   uint64_t size = mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+#if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
   size += sizeof(msg->ts);
 #endif
 #if CC_ALG == OCC || CC_ALG == FOCC || CC_ALG == BOCC || CC_ALG == SSI || CC_ALG == WSI || \
@@ -157,7 +157,7 @@ void fake_copy_to_buf(Message * msg, char* buf) {
     // !copy_to_buf
     ptr = mget_size();
     QueryMessage* cmsg = (QueryMessage*) msg;
-    #if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+    #if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
     COPY_BUF(buf,cmsg->ts,ptr);
       assert(ts != 0);
     #endif
@@ -184,6 +184,9 @@ void fake_copy_to_buf(Message * msg, char* buf) {
     #if CC_ALG == TICTOC
       COPY_BUF(buf,_min_commit_ts,ptr);
     #endif
+    #if TWOPC_OPT_CC
+      COPY_BUF(buf,qmsg->readonly,ptr);
+    #endif
     assert(ptr == qmsg->get_size());
   }
   
@@ -221,7 +224,7 @@ Message* fake_create_message(char * buf) {
     // !QueryMessage::copy_from_buf(txn);
     ptr = mget_size();
     QueryMessage* cmsg = (QueryMessage*) msg;
-    #if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
+    #if WAIT_DIE_CC || CC_ALG == TIMESTAMP || CC_ALG == MVCC || CC_ALG == WOOKONG || CC_ALG == DTA
     COPY_VAL(cmsg->ts,buf,ptr);
       assert(cmsg->ts != 0);
     #endif
@@ -251,6 +254,9 @@ Message* fake_create_message(char * buf) {
     #if CC_ALG == TICTOC
     COPY_VAL(qmsg->_min_commit_ts,buf,ptr);
     #endif
+    #if TWOPC_OPT_CC
+    COPY_VAL(qmsg->readonly,buf,ptr);
+    #endif
     assert(ptr == qmsg->get_size());
   }
   
@@ -314,6 +320,9 @@ void fake_copy_to_buf(Message * msg, char* buf) {
     QueryResponseMessage* qmsg = (QueryResponseMessage*)msg;
     *(RC*)(buf+ptr) = qmsg->rc;
     ptr += sizeof(RC);  
+#if TWOPC_OPT_CC
+    COPY_BUF(buf,qmsg->readonly,ptr);
+#endif
 
     assert(ptr == qmsg->get_size());
   }  
@@ -380,6 +389,9 @@ Message* fake_create_message(char * buf) {
     ptr = mget_size();
     qmsg->rc = *(RC*)(buf+ptr);
     ptr += sizeof(RC);  
+#if TWOPC_OPT_CC
+    COPY_VAL(qmsg->readonly,buf,ptr);
+#endif
 
     assert(ptr == qmsg->get_size());
   }
@@ -547,6 +559,7 @@ void MessageThread::run() {
   DEBUG("%ld Buffered Msg %d, (%ld,%ld) to %ld\n", _thd_id, msg->rtype, msg->txn_id, msg->batch_id,
         dest_node_id);
   sbuf->cnt += 1;
+  if (msg->piggyback) sbuf->piggyback_cnt += 1;
   sbuf->ptr += msg->get_size();
 <<<<<<< HEAD
   //f (msg->rtype == RECV_MIGRATION) std::cout<<"RECV_MIGRATION MSG IS SENDING by 542"<<endl;
@@ -26,6 +26,7 @@ struct mbuf {
   uint64_t starttime;
   uint64_t ptr;
   uint64_t cnt;
+  uint64_t piggyback_cnt;
   bool wait;
 
   void init(uint64_t dest_id) { buffer = (char *)nn_allocmsg(g_msg_size, 0); }
@@ -34,6 +35,7 @@ struct mbuf {
     //memset(buffer,0,g_msg_size);
     starttime = 0;
     cnt = 0;
+    piggyback_cnt = 0;
     wait = false;
 	  ((uint32_t*)buffer)[0] = dest_id;
 	  ((uint32_t*)buffer)[1] = g_node_id;
@@ -58,6 +60,8 @@ struct mbuf {
   bool fits(uint64_t s) { return (ptr + s) <= g_msg_size; }
   bool ready() {
     if (cnt == 0) return false;
+    // nothing but messages that can ride with the next batch
+    if (cnt == piggyback_cnt) return (get_sys_clock() - starttime) >= g_msg_fin_piggyback;
     if ((get_sys_clock() - starttime) >= g_msg_time_limit) return true;
     return false;
   }
@@ -0,0 +1,211 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "msg_trace.h"
+#include "helper.h"
+#include "mem_alloc.h"
+#include <errno.h>
+
+#if TRACE_RECORD && TRACE_REPLAY
+#error "TRACE_RECORD and TRACE_REPLAY are exclusive"
+#endif
+
+// record header of a batch in the trace of a thread
+struct TraceRecord {
+  uint64_t time;
+  uint32_t bytes;
+};
+
+// what a replay must share with the recorded run for the batches to mean the same
+static std::vector<std::pair<std::string, uint64_t> > trace_params() {
+  std::vector<std::pair<std::string, uint64_t> > params;
+  params.push_back(std::make_pair("cc_alg", (uint64_t)CC_ALG));
+  params.push_back(std::make_pair("workload", (uint64_t)WORKLOAD));
+  params.push_back(std::make_pair("node_id", (uint64_t)g_node_id));
+  params.push_back(std::make_pair("node_cnt", (uint64_t)g_node_cnt));
+  params.push_back(std::make_pair("client_node_cnt", (uint64_t)g_client_node_cnt));
+  params.push_back(std::make_pair("part_cnt", (uint64_t)g_part_cnt));
+  params.push_back(std::make_pair("thread_cnt", (uint64_t)g_thread_cnt));
+  params.push_back(std::make_pair("rem_thread_cnt", (uint64_t)g_rem_thread_cnt));
+  params.push_back(std::make_pair("send_thread_cnt", (uint64_t)g_send_thread_cnt));
+  params.push_back(std::make_pair("done_timer", (uint64_t)g_done_timer));
+  params.push_back(std::make_pair("warmup_timer", (uint64_t)g_warmup_timer));
+  return params;
+}
+
+void MsgTrace::init(uint64_t &seed) {
+  file_cnt = g_total_thread_cnt;
+  files = (TraceFile *)mem_allocator.align_alloc(sizeof(TraceFile) * file_cnt);
+  memset(files, 0, sizeof(TraceFile) * file_cnt);
+#if TRACE_REPLAY
+  seed = read_meta();
+  printf("Replaying the trace of node %d in %s\n", g_node_id, TRACE_DIR);
+#else
+  write_meta(seed);
+  printf("Recording the trace of node %d in %s\n", g_node_id, TRACE_DIR);
+#endif
+  start_time = get_sys_clock();
+}
+
+void MsgTrace::get_path(char * path, uint64_t thd_id) {
+  if (thd_id == file_cnt)
+    sprintf(path, "%s/trace_%d.meta", TRACE_DIR, g_node_id);
+  else
+    sprintf(path, "%s/trace_%d_%ld.bin", TRACE_DIR, g_node_id, thd_id);
+}
+
+void MsgTrace::write_meta(uint64_t seed) {
+  char path[256];
+  get_path(path, file_cnt);
+  FILE * meta = fopen(path, "w");
+  M_ASSERT_V(meta, "Cannot create %s\n", path);
+  std::vector<std::pair<std::string, uint64_t> > params = trace_params();
+  for (uint64_t i = 0; i < params.size(); i++)
+    fprintf(meta, "%s %ld\n", params[i].first.c_str(), params[i].second);
+  fprintf(meta, "seed %ld\n", seed);
+  M_ASSERT_V(!ferror(meta) && fclose(meta) == 0, "Cannot write %s: %s\n", path, strerror(errno));
+}
+
+uint64_t MsgTrace::read_meta() {
+  char path[256];
+  get_path(path, file_cnt);
+  FILE * meta = fopen(path, "r");
+  M_ASSERT_V(meta, "No trace of node %d: cannot open %s\n", g_node_id, path);
+  std::vector<std::pair<std::string, uint64_t> > params = trace_params();
+  uint64_t seed = 0;
+  bool has_seed = false;
+  char name[64];
+  uint64_t value;
+  while (fscanf(meta, "%63s %lu", name, &value) == 2) {
+    if (strcmp(name, "seed") == 0) {
+      seed = value;
+      has_seed = true;
+      continue;
+    }
+    for (uint64_t i = 0; i < params.size(); i++) {
+      if (params[i].first != name) continue;
+      M_ASSERT_V(params[i].second == value, "%s: recorded with %s %ld, replaying with %ld\n", path,
+                 name, value, params[i].second);
+    }
+  }
+  fclose(meta);
+  M_ASSERT_V(has_seed, "%s: no seed\n", path);
+  return seed;
+}
+
+// A failed write ends the trace of the thread: what was written stays a valid
+// prefix, since the replay takes a cut record as the end of the trace.
+void MsgTrace::record_failed(uint64_t thd_id) {
+  char path[256];
+  get_path(path, thd_id);
+  printf("Cannot write %s: %s, the trace of thread %ld ends here\n", path, strerror(errno), thd_id);
+  fflush(stdout);
+  TraceFile &f = files[thd_id];
+  fclose(f.file);
+  f.file = NULL;
+  f.done = true;
+}
+
+void MsgTrace::record(uint64_t thd_id, void * buf, int bytes) {
+  // only server nodes keep a trace
+  if (!files) return;
+  uint64_t starttime = get_sys_clock();
+  assert(thd_id < file_cnt);
+  TraceFile &f = files[thd_id];
+  if (f.done) return;
+  if (!f.file) {
+    char path[256];
+    get_path(path, thd_id);
+    f.file = fopen(path, "wb");
+    M_ASSERT_V(f.file, "Cannot create %s\n", path);
+  }
+  TraceRecord rec = {starttime - start_time, (uint32_t)bytes};
+  if (fwrite(&rec, sizeof(rec), 1, f.file) != 1 ||
+      fwrite(buf, 1, bytes, f.file) != (size_t)bytes) {
+    record_failed(thd_id);
+    return;
+  }
+  INC_STATS(thd_id, trace_batch_cnt, 1);
+  INC_STATS(thd_id, trace_bytes, bytes);
+  INC_STATS(thd_id, trace_time, get_sys_clock() - starttime);
+}
+
+bool MsgTrace::read_next(TraceFile &f) {
+  TraceRecord rec;
+  if (fread(&rec, sizeof(rec), 1, f.file) != 1) return false;
+  f.next_buf = (char *)malloc(rec.bytes);
+  if (fread(f.next_buf, 1, rec.bytes, f.file) != rec.bytes) {
+    // cut short by the end of the recorded run
+    free(f.next_buf);
+    f.next_buf = NULL;
+    return false;
+  }
+  f.next_bytes = rec.bytes;
+  f.next_time = rec.time;
+  return true;
+}
+
+char * MsgTrace::replay(uint64_t thd_id, int &bytes) {
+  if (!files) return NULL;
+  assert(thd_id < file_cnt);
+  TraceFile &f = files[thd_id];
+  if (f.done) return NULL;
+  if (!f.file) {
+    char path[256];
+    get_path(path, thd_id);
+    f.file = fopen(path, "rb");
+    if (!f.file) {
+      // this thread received nothing in the recorded run
+      f.done = true;
+      return NULL;
+    }
+  }
+  if (!f.next_buf && !read_next(f)) {
+    printf("Trace of thread %ld replayed\n", thd_id);
+    fflush(stdout);
+    f.done = true;
+    return NULL;
+  }
+  uint64_t now = get_sys_clock() - start_time;
+#if TRACE_PACED
+  if (now < f.next_time) return NULL;
+#endif
+  // how far the replay lags behind the recorded arrivals
+  if (now > f.next_time) {
+    INC_STATS(thd_id, trace_time, now - f.next_time);
+  }
+  INC_STATS(thd_id, trace_batch_cnt, 1);
+  INC_STATS(thd_id, trace_bytes, f.next_bytes);
+  char * buf = f.next_buf;
+  bytes = f.next_bytes;
+  f.next_buf = NULL;
+  return buf;
+}
+
+void MsgTrace::fini() {
+  if (!files) return;
+  for (uint64_t i = 0; i < file_cnt; i++) {
+    // a record still buffered can fail here as well
+    if (files[i].file && fclose(files[i].file) != 0 && TRACE_RECORD) {
+      char path[256];
+      get_path(path, i);
+      printf("Cannot write %s: %s, its last records are lost\n", path, strerror(errno));
+    }
+    if (files[i].next_buf) free(files[i].next_buf);
+    files[i].file = NULL;
+    files[i].next_buf = NULL;
+  }
+}
@@ -0,0 +1,69 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _MSG_TRACE_H_
+#define _MSG_TRACE_H_
+
+#include "global.h"
+
+// trace of one receiving thread
+struct TraceFile {
+  FILE * file;
+  bool done;
+  // replay: the batch read ahead, handed out once it is due
+  char * next_buf;
+  uint32_t next_bytes;
+  uint64_t next_time;
+  char _pad[CL_SIZE - sizeof(FILE *) - sizeof(bool) - sizeof(char *) - sizeof(uint32_t) -
+            sizeof(uint64_t)];
+};
+
+/*
+   Record and replay of the message batches a server node receives.
+   TRACE_RECORD: Transport::recv_msg appends every batch, as received from the
+   socket, to TRACE_DIR/trace_<node>_<thd>.bin together with its arrival time
+   (ns since init), one file per receiving thread. The run parameters and the
+   random seed go to TRACE_DIR/trace_<node>.meta.
+   TRACE_REPLAY: no sockets are opened. Each receiving thread gets the batches
+   of its own file in the recorded order, no earlier than their recorded
+   arrival time when TRACE_PACED, and the node runs with the recorded seed.
+   Outbound batches are dropped: the replies of the other nodes are in the
+   trace already.
+   The replay has to run the same binary with the same flags as the recorded
+   node; init checks the parameters against the meta file.
+*/
+class MsgTrace {
+public:
+  // replay: seed is replaced by the recorded one
+  void init(uint64_t &seed);
+  void record(uint64_t thd_id, void * buf, int bytes);
+  // the next batch of thd_id if it is due, NULL otherwise; free it with free()
+  char * replay(uint64_t thd_id, int &bytes);
+  void fini();
+
+private:
+  void get_path(char * path, uint64_t thd_id);
+  void write_meta(uint64_t seed);
+  uint64_t read_meta();
+  bool read_next(TraceFile &f);
+  void record_failed(uint64_t thd_id);
+
+  TraceFile * files;
+  uint64_t file_cnt;
+  uint64_t start_time;
+};
+
+#endif
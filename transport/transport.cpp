@@ -22,6 +22,7 @@
 #include "global.h"
 #include "manager.h"
 #include "message.h"
+#include "msg_trace.h"
 #include "nn.hpp"
 #include "query.h"
 #include "tpcc_query.h"
@@ -189,6 +190,11 @@ void Transport::init() {
   _sock_cnt = get_socket_count();
 
   rr = 0;
+#if TRACE_REPLAY
+  // the other nodes are in the trace
+  printf("Tport Init %d: replay, no sockets\n",g_node_id);
+  return;
+#endif
 	printf("Tport Init %d: %ld\n",g_node_id,_sock_cnt);
 
   string path = get_path();
@@ -254,6 +260,12 @@ void Transport::init() {
 // rename sid to send thread id
 void Transport::send_msg(uint64_t send_thread_id, uint64_t dest_node_id, void * sbuf,int size) {
   uint64_t starttime = get_sys_clock();
+#if TRACE_REPLAY
+  // what the other nodes did with it is in the trace
+  DEBUG("%ld Dropping batch of %d bytes to node %ld\n", send_thread_id, size, dest_node_id);
+  INC_STATS(send_thread_id,msg_send_cnt,1);
+  return;
+#endif
 
   Socket * socket = send_sockets.find(std::make_pair(dest_node_id,send_thread_id))->second;
 
@@ -292,6 +304,19 @@ std::vector<Message*> * Transport::recv_msg(uint64_t thd_id) {
 	void * buf;
   uint64_t starttime = get_sys_clock();
   std::vector<Message*> * msgs = NULL;
+#if TRACE_REPLAY
+  buf = msg_trace.replay(thd_id, bytes);
+  if (buf == NULL) {
+    INC_STATS(thd_id,msg_recv_idle_time, get_sys_clock() - starttime);
+    return msgs;
+  }
+  INC_STATS(thd_id,msg_recv_cnt,1);
+  starttime = get_sys_clock();
+  msgs = Message::create_messages((char*)buf);
+  free(buf);
+  INC_STATS(thd_id,msg_unpack_time,get_sys_clock()-starttime);
+  return msgs;
+#endif
   //uint64_t ctr = starttime % recv_sockets.size();
   uint64_t rand = (starttime % recv_sockets.size()) / g_this_rem_thread_cnt;
   // uint64_t ctr = ((thd_id % g_this_rem_thread_cnt) % recv_sockets.size()) + rand *
@@ -335,6 +360,9 @@ std::vector<Message*> * Transport::recv_msg(uint64_t thd_id) {
 
 	starttime = get_sys_clock();
 
+#if TRACE_RECORD
+  msg_trace.record(thd_id, buf, bytes);
+#endif
   msgs = Message::create_messages((char*)buf);
   DEBUG("Batch of %d bytes recv from node %ld; Time: %f\n", bytes, msgs->front()->return_node_id,
         simulation->seconds_from_start(get_sys_clock()));